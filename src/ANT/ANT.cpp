@@ -126,10 +126,9 @@ ANT::ANT(QObject *parent, DeviceConfiguration *devConf, QString athlete) : QThre
     if (!elapsedTimer.isMonotonic())
         qDebug() << "Caution: ANT timer is not monotonic";
 
-    // state machine
-    state = ST_WAIT_FOR_SYNC;
-    length = bytes = 0;
-    checksum = ANT_SYNC_BYTE;
+    // receive buffer
+    rxHead = rxCount = 0;
+    rxPending = -1;
 
     // ant ids - may not be configured of course
     if (devConf && devConf->deviceProfile.length())
@@ -246,9 +245,12 @@ void ANT::run()
 
     for (int i=0; i<ANT_MAX_CHANNELS; i++) antChannel[i]->init();
 
-    state = ST_WAIT_FOR_SYNC;
-    length = bytes = 0;
-    checksum = ANT_SYNC_BYTE;
+    rxHead = rxCount = 0;
+    rxPending = -1;
+    pvars.lock();
+    rxStats = ANTReceiveStats();
+    pvars.unlock();
+    qint64 started = elapsedTimer.nsecsElapsed() / 1000;
 
     if (openPort() == 0) {
 
@@ -268,14 +270,26 @@ void ANT::run()
 
     while(1)
     {
-        // read more bytes from the device
-        uint8_t byte;
+        // read whatever is available straight into the free space at the end
+        // of the ring buffer, waiting a little while if there is nothing yet
+        int tail = (rxHead + rxCount) & (ANT_RX_BUFFER_SIZE-1);
+        int space = qMin(ANT_RX_BUFFER_SIZE - rxCount, ANT_RX_BUFFER_SIZE - tail);
+
+        int rc = rawRead(rxBuffer + tail, space, ANT_RX_TIMEOUT);
+
+        if (rc > 0) {
+            rxCount += rc;
+
+            qint64 arrived = elapsedTimer.nsecsElapsed() / 1000;
+            pvars.lock();
+            rxStats.reads++;
+            rxStats.bytes += rc;
+            rxStats.elapsed = arrived - started;
+            pvars.unlock();
 
-        int rc = rawRead(&byte, 1);
+            receiveFrames(arrived);
 
-        if (rc > 0)
-            receiveByte((unsigned char)byte);
-        else {
+        } else if (rc < 0) {
 
             // Recognise USB device removal. Linux transitions through -5 (I/O error)
             // to -6 (No such device or address). Windows seems to stick on -5
@@ -286,7 +300,8 @@ void ANT::run()
                 Status = 0;
             }
 
-            msleep(5);
+            // don't spin on errors
+            msleep(ANT_RX_TIMEOUT);
         }
 
         //----------------------------------------------------------------------
@@ -949,52 +964,82 @@ ANT::sendMessage(ANTMessage m) {
     rawWrite((uint8_t*)padding, 5);
 }
 
+//
+// Parse and dispatch all the complete messages in the receive buffer,
+// anything left over is the start of a message still to arrive
+//
 void
-ANT::receiveByte(unsigned char byte) {
-
-    switch (state) {
-        case ST_WAIT_FOR_SYNC:
-            if (byte == ANT_SYNC_BYTE) {
-                state = ST_GET_LENGTH;
-                checksum = ANT_SYNC_BYTE;
-                rxMessage[0] = byte;
-            }
-            break;
+ANT::receiveFrames(qint64 arrived)
+{
+    const int mask = ANT_RX_BUFFER_SIZE-1;
+    quint64 messages=0, errors=0;
+    qint64 latency=0, maxLatency=0;
+
+    // bytes left from the last read arrived earlier
+    qint64 since = rxPending >= 0 ? rxPending : arrived;
+
+    while (rxCount >= 2) {
+
+        // look for sync and a valid length
+        int length = rxBuffer[(rxHead+ANT_OFFSET_LENGTH) & mask];
+        if (rxBuffer[rxHead] != ANT_SYNC_BYTE || length == 0 || length > ANT_MAX_LENGTH) {
+            if (rxBuffer[rxHead] == ANT_SYNC_BYTE) errors++;
+            rxHead = (rxHead+1) & mask;
+            rxCount--;
+            continue;
+        }
 
-        case ST_GET_LENGTH:
-            if ((byte == 0) || (byte > ANT_MAX_LENGTH)) {
-                state = ST_WAIT_FOR_SYNC;
-            }
-            else {
-              rxMessage[ANT_OFFSET_LENGTH] = byte;
-                checksum ^= byte;
-                length = byte;
-                bytes = 0;
-                state = ST_GET_MESSAGE_ID;
-            }
-            break;
+        // sync, length, id, data and checksum
+        int size = length + 4;
+        if (rxCount < size) break;
 
-        case ST_GET_MESSAGE_ID:
-            rxMessage[ANT_OFFSET_ID] = byte;
-            checksum ^= byte;
-            state = ST_GET_DATA;
-            break;
+        int checksum = 0;
+        for (int i=0; i<size-1; i++) {
+            rxMessage[i] = rxBuffer[(rxHead+i) & mask];
+            checksum ^= rxMessage[i];
+        }
 
-        case ST_GET_DATA:
-            rxMessage[ANT_OFFSET_DATA + bytes] = byte;
-            checksum ^= byte;
-            if (++bytes >= length){
-                state = ST_VALIDATE_PACKET;
-            }
-            break;
+        // bad checksum; resync from the next byte
+        if (checksum != rxBuffer[(rxHead+size-1) & mask]) {
+            errors++;
+            rxHead = (rxHead+1) & mask;
+            rxCount--;
+            continue;
+        }
 
-        case ST_VALIDATE_PACKET:
-            if (checksum == byte){
-                processMessage();
-            }
-            state = ST_WAIT_FOR_SYNC;
-            break;
+        rxHead = (rxHead+size) & mask;
+        rxCount -= size;
+
+        processMessage();
+
+        qint64 taken = (elapsedTimer.nsecsElapsed() / 1000) - since;
+        latency += taken;
+        if (taken > maxLatency) maxLatency = taken;
+        messages++;
+
+        // the rest came with this read
+        since = arrived;
     }
+
+    // partial message waiting for more
+    if (rxCount == 0) rxHead = 0;
+    rxPending = rxCount ? since : -1;
+
+    pvars.lock();
+    rxStats.messages += messages;
+    rxStats.errors += errors;
+    rxStats.latency += latency;
+    if (maxLatency > rxStats.maxLatency) rxStats.maxLatency = maxLatency;
+    pvars.unlock();
+}
+
+ANTReceiveStats
+ANT::receiveStats()
+{
+    pvars.lock();
+    ANTReceiveStats returning = rxStats;
+    pvars.unlock();
+    return returning;
 }
 
 
@@ -1253,44 +1298,64 @@ int ANT::rawWrite(uint8_t *bytes, int size) // unix!!
 
 }
 
-int ANT::rawRead(uint8_t bytes[], int size)
+int ANT::rawRead(uint8_t bytes[], int size, int timeout)
 {
 #ifdef WIN32
 #ifdef GC_HAVE_LIBUSB
     switch (usbMode) {
 #ifdef GC_HAVE_USBXPRESS
     case USB1:
-        return USBXpress::read(&devicePort, bytes, size);
+        {
+            // no way to wait, so sleep if nothing is there
+            int rc = USBXpress::read(&devicePort, bytes, size);
+            if (rc == 0) msleep(timeout);
+            return rc;
+        }
         break;
 #endif
     case USB2:
-        return usb2->read((char *)bytes, size);
+        {
+            // the bulk read waits for us
+            int rc = usb2->read((char *)bytes, size, timeout);
+            return rc == -ETIMEDOUT ? 0 : rc;
+        }
         break;
     default:
         break;
     }
 
 #else
+    Q_UNUSED(bytes);
+    Q_UNUSED(size);
+    Q_UNUSED(timeout);
     return -1;
 #endif
 #else
 
 #ifdef GC_HAVE_LIBUSB
     if (usbMode == USB2) {
-        return usb2->read((char *)bytes, size);
+        // the bulk read waits for us
+        int rc = usb2->read((char *)bytes, size, timeout);
+        return rc == -ETIMEDOUT ? 0 : rc;
     }
 #endif
-    int i=0;
-    uint8_t byte;
-
-    // read one byte at a time sleeping when no data ready
-    // until we timeout waiting then return error
-    for (i=0; i<size; i++) {
-        int rc = read(devicePort, &byte, 1);
-        if (rc == -1 || rc == 0) return -1; // error!
-        else bytes[i] = byte;
-    }
-    return i;
+
+    // wait for something to arrive then take all of it
+    struct pollfd fds;
+    fds.fd = devicePort;
+    fds.events = POLLIN;
+    fds.revents = 0;
+
+    int rc = poll(&fds, 1, timeout);
+    if (rc == 0) return 0; // nothing yet
+    if (rc < 0) return errno == EINTR ? 0 : -errno;
+
+    // device went away
+    if (fds.revents & (POLLERR | POLLHUP | POLLNVAL)) return -ENXIO;
+
+    rc = read(devicePort, bytes, size);
+    if (rc < 0) return (errno == EAGAIN || errno == EINTR) ? 0 : -errno;
+    return rc;
 
 #endif
     return -1; // keep compiler happy.
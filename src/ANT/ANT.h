@@ -71,6 +71,7 @@
 #include <termios.h> // unix!!
 #include <unistd.h> // unix!!
 #include <sys/ioctl.h>
+#include <poll.h> // unix!!
 #ifndef N_TTY // for OpenBSD
 #define N_TTY 0
 #endif
@@ -212,6 +213,10 @@ struct setChannelAtom {
 #define ANT_MAX_MESSAGE_SIZE 12
 #define ANT_MAX_CHANNELS     8
 
+// receive buffer, must be a power of 2
+#define ANT_RX_BUFFER_SIZE   1024
+#define ANT_RX_TIMEOUT       5 // ms to wait for data before checking for commands
+
 // Channel messages
 #define RESPONSE_NO_ERROR               0
 #define EVENT_RX_SEARCH_TIMEOUT         1
@@ -396,6 +401,21 @@ struct setChannelAtom {
 #define ANT_CONTROL_GENERIC_CMD_USER_2              0x8001
 #define ANT_CONTROL_GENERIC_CMD_USER_3              0x8002
 
+// counters for the receive loop, latency is from the arrival
+// of the first byte of a message to it being dispatched
+struct ANTReceiveStats {
+
+    ANTReceiveStats() : reads(0), bytes(0), messages(0), errors(0),
+                        latency(0), maxLatency(0), elapsed(0) {}
+
+    quint64 reads, bytes, messages, errors; // errors are bad lengths or checksums
+    qint64 latency, maxLatency;             // total and worst, in usecs
+    qint64 elapsed;                         // usecs since the loop started
+
+    double meanLatency() const { return messages ? double(latency) / double(messages) : 0; }
+    double throughput() const { return elapsed ? double(messages) * 1000000.0 / double(elapsed) : 0; } // per second
+};
+
 //======================================================================
 // Worker thread
 //======================================================================
@@ -497,7 +517,7 @@ public:
 
     // transmission
     void sendMessage(ANTMessage);
-    void receiveByte(unsigned char byte);
+    void receiveFrames(qint64 arrived);
     void handleChannelEvent(void);
     void processMessage(void);
 
@@ -587,7 +607,7 @@ public:
     void setBaud(int baud);
     int openPort();
     int closePort();
-    int rawRead(uint8_t bytes[], int size);
+    int rawRead(uint8_t bytes[], int size, int timeout); // whatever is available, 0 on timeout
     int rawWrite(uint8_t *bytes, int size);
 
     bool modeERGO(void) const;
@@ -672,6 +692,9 @@ public:
 
     qint64 getElapsedTime();
 
+    // receive loop latency and throughput
+    ANTReceiveStats receiveStats();
+
 private:
     QSemaphore portInitDone;
     void run();
@@ -710,12 +733,11 @@ private:
     bool ANT_Reset_Acknowledge;
     unsigned char rxMessage[ANT_MAX_MESSAGE_SIZE];
 
-    // state machine whilst receiving bytes
-    enum States {ST_WAIT_FOR_SYNC, ST_GET_LENGTH, ST_GET_MESSAGE_ID, ST_GET_DATA, ST_VALIDATE_PACKET} state;
-    //enum States state;
-    int length;
-    int bytes;
-    int checksum;
+    // ring buffer of bytes received but not yet parsed
+    uint8_t rxBuffer[ANT_RX_BUFFER_SIZE];
+    int rxHead, rxCount;
+    qint64 rxPending;   // when the oldest unparsed byte arrived, -1 if none
+    ANTReceiveStats rxStats;
     int powerchannels; // how many power channels do we have?
     QDateTime lastCadenceMessage;
 
@@ -23,10 +23,12 @@
 #include "IntervalItem.h"
 #include "RideFile.h"
 #include "RideItem.h"
+#include "RideFileCommand.h"
 #include "Settings.h"
 #include "Units.h"
 #include "Colors.h"
 #include "TimeUtils.h"
+#include "VirtualElevation.h"
 #include "Units.h"
 
 #include <cmath>
@@ -202,7 +204,7 @@ Aerolab::Aerolab(
   QwtPlot(parent),
   context(context),
   parent(parent),
-  rideItem(NULL),
+  rideItem(NULL), veRide(NULL), veStale(true), veConstantAlt(false), veMetric(true),
   smooth(1), bydist(true), autoEoffset(true) {
 
   crr       = 0.005;
@@ -280,130 +282,111 @@ Aerolab::configChanged(qint32)
 void
 Aerolab::setData(RideItem *_rideItem, bool new_zoom) {
 
-  // HARD-CODED DATA: p1->kph
-  double vfactor = 3.600;
-  double m       =  totalMass;
-  double small_number = 0.00001;
-
   rideItem = _rideItem;
   if (rideItem == NULL || rideItem->ride() == NULL) return;
 
   RideFile *ride = rideItem->ride();
+  const RideFileDataPresent *dataPresent = ride->areDataPresent();
+  bool metric = context->athlete->useMetricUnits;
 
-  veArray.clear();
-  altArray.clear();
-  distanceArray.clear();
-  timeArray.clear();
+  if( dataPresent->watts ) {
 
-  if( ride ) {
+    // a different ride, or shown differently, needs unpacking again but when
+    // it's just the parameters that changed (dragging the sliders) the virtual
+    // elevation is a sum of the terms the engine already has
+    if (new_zoom || ride != veRide || veStale || ve.count() != ride->dataPoints().count() ||
+        constantAlt != veConstantAlt || metric != veMetric) {
+        unpack(ride);
+    }
 
-    const RideFileDataPresent *dataPresent = ride->areDataPresent();
-    //setTitle(ride->startTime().toString(GC_DATETIME_FORMAT));
-
-    if( dataPresent->watts ) {
-
-      // If watts are present, then we can fill the veArray data:
-      const RideFileDataPresent *dataPresent = ride->areDataPresent();
-      int npoints = ride->dataPoints().size();
-      double dt = ride->recIntSecs();
-      veArray.resize(dataPresent->watts ? npoints : 0);
-      altArray.resize(dataPresent->alt || constantAlt ? npoints : 0);
-      timeArray.resize(dataPresent->watts ? npoints : 0);
-      distanceArray.resize(dataPresent->watts ? npoints : 0);
-
-      // quickly erase old data
-      veCurve->setVisible(false);
-      altCurve->setVisible(false);
-
-      // detach and re-attach the ve curve:
-      veCurve->detach();
-      if (!veArray.empty()) {
-        veCurve->attach(this);
-        veCurve->setVisible(dataPresent->watts);
-      }
+    veArray.resize(ve.count());
+    ve.elevation(veArray.data(), eoffset, crr, cda, totalMass, rho, eta, metric ? 1 : FEET_PER_METER);
 
-      // detach and re-attach the ve curve:
-      bool have_recorded_alt_curve = false;
-      altCurve->detach();
-      if (!altArray.empty()) {
-        have_recorded_alt_curve = true;
-        altCurve->attach(this);
-        altCurve->setVisible(dataPresent->alt || constantAlt );
-      }
+  } else {
 
-      // Fill the virtual elevation profile with data from the ride data:
-      double t = 0.0;
-      double vlast = 0.0;
-      double e     = 0.0;
-      arrayLength = 0;
-      foreach(const RideFilePoint *p1, ride->dataPoints()) {
-      if ( arrayLength == 0 )
-        e = eoffset;
-
-      timeArray[arrayLength]  = p1->secs / 60.0;
-      if ( have_recorded_alt_curve ) {
-          if ( constantAlt && arrayLength > 0) {
-              altArray[arrayLength] = altArray[arrayLength-1];
-          }
-          else  {
-              if ( constantAlt && !dataPresent->alt)
-                  altArray[arrayLength] = 0;
-              else
-                altArray[arrayLength] = (context->athlete->useMetricUnits
-                   ? p1->alt
-                   : p1->alt * FEET_PER_METER);
-          }
-      }
+    veArray.clear();
+    altArray.clear();
+    distanceArray.clear();
+    timeArray.clear();
+    veStale = true;
 
-      // Unpack:
-      double power = max(0, p1->watts);
-      double v     = p1->kph/vfactor;
-      double headwind = v;
-      if( dataPresent->headwind ) {
-        headwind   = p1->headwind/vfactor;
-      }
-      double f     = 0.0;
-      double a     = 0.0;
+    veCurve->setVisible(false);
+    altCurve->setVisible(false);
+  }
+  recalc(new_zoom);
+  adjustEoffset();
+}
 
-      // Use km data instead of formula for file with a stop (gap).
-      //d += v * dt;
-      //distanceArray[arrayLength] = d/1000;
+void
+Aerolab::unpack(RideFile *ride) {
+
+  const RideFileDataPresent *dataPresent = ride->areDataPresent();
+  bool metric = context->athlete->useMetricUnits;
+  int npoints = ride->dataPoints().size();
+
+  altArray.resize(dataPresent->alt || constantAlt ? npoints : 0);
+  timeArray.resize(npoints);
+  distanceArray.resize(npoints);
 
-      distanceArray[arrayLength] = p1->km;
+  // quickly erase old data
+  veCurve->setVisible(false);
+  altCurve->setVisible(false);
 
+  // detach and re-attach the ve curve:
+  veCurve->detach();
+  if (npoints) {
+    veCurve->attach(this);
+    veCurve->setVisible(true);
+  }
+
+  // detach and re-attach the ve curve:
+  bool have_recorded_alt_curve = false;
+  altCurve->detach();
+  if (!altArray.empty()) {
+    have_recorded_alt_curve = true;
+    altCurve->attach(this);
+    altCurve->setVisible(true);
+  }
 
+  // the time, distance and recorded elevation don't change with the parameters
+  arrayLength = 0;
+  foreach(const RideFilePoint *p1, ride->dataPoints()) {
 
-      if( v > small_number ) {
-        f  = power/v;
-        a  = ( v*v - vlast*vlast ) / ( 2.0 * dt * v );
+    timeArray[arrayLength]  = p1->secs / 60.0;
+    if ( have_recorded_alt_curve ) {
+      if ( constantAlt && arrayLength > 0) {
+        altArray[arrayLength] = altArray[arrayLength-1];
       } else {
-        a = ( v - vlast ) / dt;
+        if ( constantAlt && !dataPresent->alt)
+          altArray[arrayLength] = 0;
+        else
+          altArray[arrayLength] = (metric ? p1->alt : p1->alt * FEET_PER_METER);
       }
+    }
 
-      f *= eta; // adjust for drivetrain efficiency if using a crank-based meter
-      double s   = slope( f, a, m, crr, cda, rho, headwind );
-      double de  = s * v * dt * (context->athlete->useMetricUnits ? 1 : FEET_PER_METER);
-
-      e += de;
-      t += dt;
+    // Use km data instead of formula for file with a stop (gap).
+    distanceArray[arrayLength] = p1->km;
 
-      veArray[arrayLength] = e;
+    ++arrayLength;
+  }
 
-      vlast = v;
+  // and the terms of the virtual elevation
+  ve.setRide(ride);
 
-      ++arrayLength;
+  // edits, undo and redo all end a command
+  if (ride != veRide) {
+    if (veRide) {
+      disconnect(veRide, SIGNAL(reverted()), this, SLOT(rideEdited()));
+      disconnect(veRide->command, SIGNAL(endCommand(bool,RideCommand*)), this, SLOT(rideEdited()));
     }
-
-  } else {
-      veCurve->setVisible(false);
-      altCurve->setVisible(false);
+    connect(ride, SIGNAL(reverted()), this, SLOT(rideEdited()));
+    connect(ride->command, SIGNAL(endCommand(bool,RideCommand*)), this, SLOT(rideEdited()));
   }
-    recalc(new_zoom);
-    adjustEoffset();
-  } else {
-    //setTitle("no data");
 
-  }
+  veRide = ride;
+  veStale = false;
+  veConstantAlt = constantAlt;
+  veMetric = metric;
 }
 
 void
@@ -602,25 +585,6 @@ Aerolab::setByDistance(int value) {
 }
 
 
-double
-Aerolab::slope(
-           double f,
-           double a,
-           double m,
-           double crr,
-           double cda,
-           double rho,
-           double v
-        )  {
-
-  double g = KG_FORCE_PER_METER;
-
-  // Small angle version of slope calculation:
-  double s = f/(m*g) - crr - cda*rho*v*v/(2.0*m*g) - a/g;
-
-  return s;
-}
-
 // At slider 1000, we want to get max Crr=0.1000
 // At slider 1    , we want to get min Crr=0.0001
 void
@@ -765,138 +729,83 @@ void Aerolab::refreshIntervalMarkers()
  * non-zero altitude.
  * Returns an explanatory error message ff it fails to do the estimation,
  * otherwise it updates cda and crr and returns an empty error message.
+ * When intervals are selected each is fitted separately, in parallel, and
+ * the estimate is from all of them together; the individual estimates (or
+ * the range of a single interval) are added to details when passed.
  * Author: Alejandro Martinez
  * Date: 23-aug-2012
  */
-QString Aerolab::estimateCdACrr(RideItem *rideItem)
+QString Aerolab::estimateCdACrr(RideItem *rideItem, QStringList *details)
 {
-    // HARD-CODED DATA: p1->kph
-    const double vfactor = 3.600;
-    const double g = KG_FORCE_PER_METER;
-
     if (rideItem == NULL || rideItem->ride() == NULL) return (tr("No ride selected"));
     RideFile *ride = rideItem->ride();
-    QString errMsg;
-
-    if(ride) {
-        const RideFileDataPresent *dataPresent = ride->areDataPresent();
-        if(( dataPresent->alt || constantAlt )  && dataPresent->watts) {
-            double dt = ride->recIntSecs();
-            int npoints = ride->dataPoints().size() + 1;
-#ifdef Q_CC_MSVC
-            double* X1 = new double[npoints];
-            double* X2 = new double[npoints];
-            double* Egain = new double[npoints];
-#else
-            double X1[npoints], X2[npoints], Egain[npoints];
-#endif
-            int nSeg = -1;
-            double altInit = 0, vInit = 0;
-            /* For each segment, defined between points with alt != 0,
-             * this loop computes X1, X2 and Egain to verify:
-             * Aero-Loss + RR-Loss = Egain
-             * where
-             *      Aero-Loss = X1[nSgeg] * CdA
-             *      RR-Loss = X2[nSgeg] * Crr
-             * are the aero and rr components of the energy loss with
-             *      X1[nSeg] = sum(0.5 * rho * headwind*headwind * distance)
-             *      X2[nSeg] = sum(totalMass * g * distance)
-             * and the energy gain sums power in the segment with
-             * potential and kinetic variations:
-             *      Egain = sum(eta * power * dt) +
-             *              totalMass * (g * (altInit - alt) +
-             *              0.5 * (vInit*vInit - v*v))
-             */
-            foreach(const RideFilePoint *p1, ride->dataPoints()) {
-                // Unpack:
-                double power = max(0, p1->watts);
-                double v     = p1->kph/vfactor;
-                double distance = v * dt;
-                double headwind = v;
-                if( dataPresent->headwind ) {
-                    headwind   = p1->headwind/vfactor;
-                }
-                double alt = p1->alt;
-                // start initial segment
-                if (nSeg < 0 && alt != 0) {
-                    nSeg = 0;
-                    X1[nSeg] = X2[nSeg] = Egain[nSeg] = 0.0;
-                    altInit = alt;
-                    vInit = v;
-                }
-                // accumulate segment data
-                if (nSeg >= 0) {
-                    // X1[nSgeg] * CdA == Aero-Loss
-                    X1[nSeg] += 0.5 * rho * headwind*headwind * distance;
-                    // X2[nSgeg] * Crr == RR-Loss
-                    X2[nSeg] += totalMass * g * distance;
-                    // Energy supplied
-                    Egain[nSeg] += eta * power * dt;
-                }
-                // close current segment and start a new one
-                if (nSeg >= 0 && alt != 0) {
-                    // Add change in potential and kinetic energy
-                    Egain[nSeg] += totalMass * (g * (altInit - alt) + 0.5 * (vInit*vInit - v*v));
-                    // Start a new segment
-                    nSeg++;
-                    X1[nSeg] = X2[nSeg] = Egain[nSeg] = 0.0;
-                    altInit = alt;
-                    vInit = v;
-                }
-            }
-            /* At least two segmentes needed to approximate:
-             *     X1 * CdA + X2 * Crr = Egain
-             * which, in matrix form, is:
-             *    X * [ CdA ; Crr ] = Egain
-             * and pre-multiplying by X transpose (X'):
-             *    X'* X [ CdA ; Crr ] = X' * Egain
-             * which is a system with two equations and two unknowns
-             *    A * [ CdA ; Crr ] = B
-             */
-            if (nSeg >= 2) {
-                // compute the normal equation: A * [ CdA ; Crr ] = B
-                // A = X'*X
-                // B = X'*Egain
-                double A11 = 0, A12 = 0, A21 = 0, A22 = 0, B1 = 0, B2 = 0;
-                for (int i = 0; i < nSeg; i++) {
-                    A11 += X1[i] * X1[i];
-                    A12 += X1[i] * X2[i];
-                    A21 += X2[i] * X1[i];
-                    A22 += X2[i] * X2[i];
-                    B1  += X1[i] * Egain[i];
-                    B2  += X2[i] * Egain[i];
-                }
-                // Solve the normal equation
-                // A11 * CdA + A12 * Crr = B1
-                // A21 * CdA + A22 * Crr = B2
-                double det = A11 * A22 - A12 * A21;
-                if (fabs(det) > 0.00) {
-                    // round and update if the values are in Aerolab's range
-                    double cda = floor(10000 * (A22 * B1 - A12 * B2) / det + 0.5) / 10000;
-                    double crr = floor(1000000 * (A11 * B2 - A21 * B1) / det + 0.5) / 1000000;
-                    if (cda >= 0.001 && cda <= 1.0 && crr >= 0.0001 && crr <= 0.1) {
-                        this->cda = cda;
-                        this->crr = crr;
-                        errMsg = ""; // No error
-                    } else {
-                        errMsg = tr("Estimates out-of-range");
-                    }
-                } else {
-                    errMsg = tr("At least two segments must be independent");
-                }
-            } else {
-                errMsg = tr("At least two segments must be defined");
-            }
-#ifdef Q_CC_MSVC
-            delete[] X1;
-            delete[] X2;
-            delete[] Egain;
-#endif
-        } else {
-            errMsg = tr("Altitude and Power data must be present");
+
+    const RideFileDataPresent *dataPresent = ride->areDataPresent();
+    if (!(( dataPresent->alt || constantAlt )  && dataPresent->watts))
+        return tr("Altitude and Power data must be present");
+
+    // the terms are already unpacked if it's the ride being shown
+    VirtualElevation unpacked;
+    const VirtualElevation *engine = &ve;
+    if (ride != veRide || veStale || ve.count() != ride->dataPoints().count()) {
+        unpacked.setRide(ride);
+        engine = &unpacked;
+    }
+
+    // the whole ride, or each of the selected intervals
+    QVector<VirtualElevation::Job> jobs;
+    QList<IntervalItem*> intervals = rideItem->intervalsSelected();
+    foreach(IntervalItem *interval, intervals) {
+        VirtualElevation::Job add = { engine, ride->timeIndex(interval->start), ride->timeIndex(interval->stop) + 1,
+                                      totalMass, rho, eta, VirtualElevationFit() };
+        jobs << add;
+    }
+    if (jobs.isEmpty()) {
+        VirtualElevation::Job add = { engine, 0, engine->count(), totalMass, rho, eta, VirtualElevationFit() };
+        jobs << add;
+        intervals.clear();
+    }
+    VirtualElevation::fit(jobs);
+
+    // each on its own, for comparing runs on a field test day
+    VirtualElevationFit all;
+    for (int i=0; i<jobs.count(); i++) {
+        all.add(jobs[i].fit);
+
+        if (details && intervals.count() == 1) {
+            *details << QString(tr("%1 only, %2 to %3")).arg(intervals[i]->name)
+                                                          .arg(time_to_string(intervals[i]->start))
+                                                          .arg(time_to_string(intervals[i]->stop));
+        } else if (details && intervals.count() > 1) {
+            double cda, crr;
+            if (jobs[i].fit.solve(cda, crr) == VirtualElevationFit::Ok)
+                *details << QString("%1: CdA %2 Crr %3").arg(intervals[i]->name)
+                                                      .arg(floor(10000 * cda + 0.5) / 10000)
+                                                      .arg(floor(1000000 * crr + 0.5) / 1000000);
+            else
+                *details << QString("%1: %2").arg(intervals[i]->name).arg(tr("no estimate"));
         }
-    } else {
-        errMsg = tr("No activity selected");
     }
-    return errMsg;
+
+    // Solve the normal equation
+    double cda, crr;
+    switch (all.solve(cda, crr)) {
+    case VirtualElevationFit::Ok:
+        // round and update if the values are in Aerolab's range
+        cda = floor(10000 * cda + 0.5) / 10000;
+        crr = floor(1000000 * crr + 0.5) / 1000000;
+        if (cda >= 0.001 && cda <= 1.0 && crr >= 0.0001 && crr <= 0.1) {
+            this->cda = cda;
+            this->crr = crr;
+            return ""; // No error
+        }
+        return tr("Estimates out-of-range");
+
+    case VirtualElevationFit::Dependent:
+        return tr("At least two segments must be independent");
+
+    default:
+    case VirtualElevationFit::TooFewSegments:
+        return tr("At least two segments must be defined");
+    }
 }
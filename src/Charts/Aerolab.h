@@ -30,11 +30,14 @@
 #include <QTableWidget>
 #include <QTextEdit>
 #include <QStackedWidget>
+#include <QPointer>
 
 #include "LTMWindow.h" // for tooltip/canvaspicker
+#include "VirtualElevation.h"
 
 // forward references
 class RideItem;
+class RideFile;
 struct RideFilePoint;
 class QwtPlotCurve;
 class QwtPlotGrid;
@@ -79,6 +82,9 @@ class Aerolab : public QwtPlot {
 
   void pointHover( QwtPlotCurve *, int );
 
+  private slots:
+  void rideEdited() { veStale = true; }
+
   signals:
 
   protected:
@@ -97,6 +103,13 @@ class Aerolab : public QwtPlot {
 
   RideItem *rideItem;
 
+  // virtual elevation terms for the ride, and how it was unpacked,
+  // stale once the ride is edited and cleared if it is deleted
+  VirtualElevation ve;
+  QPointer<RideFile> veRide;
+  bool veStale, veConstantAlt, veMetric;
+  void unpack(RideFile *ride);
+
   QVector<double> hrArray;
   QVector<double> wattsArray;
   QVector<double> speedArray;
@@ -123,7 +136,6 @@ class Aerolab : public QwtPlot {
   double eoffset;
 
 
-  double   slope(double, double, double, double, double, double, double);
   void     recalc(bool);
   void     setYMax(bool);
   void     setXTitle();
@@ -145,7 +157,7 @@ class Aerolab : public QwtPlot {
   int      intRho() const { return (int)( rho * 10000); }
   int      intEta() const { return (int)( eta * 10000); }
   int      intEoffset() const { return (int)( eoffset * 100); }
-  QString  estimateCdACrr(RideItem* rideItem);
+  QString  estimateCdACrr(RideItem* rideItem, QStringList *details=NULL);
 
 };
 
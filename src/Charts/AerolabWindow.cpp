@@ -622,8 +622,9 @@ void
 AerolabWindow::doEstCdACrr()
 {
     RideItem *ride = context->rideItem();
-    /* Estimate Crr&Cda */
-    const QString errMsg = aerolab->estimateCdACrr(ride);
+    /* Estimate Crr&Cda, over the selected intervals if there are any */
+    QStringList details;
+    const QString errMsg = aerolab->estimateCdACrr(ride, &details);
     if (errMsg.isEmpty()) {
         /* Update Crr/Cda values values in UI */
         crrLineEdit->setText(QString("%1").arg(aerolab->getCrr()) );
@@ -632,6 +633,13 @@ AerolabWindow::doEstCdACrr()
         cdaSlider->setValue(aerolab->intCda());
         /* Refresh */
         refresh(ride, false);
+
+        /* and how each interval compares with the combined estimate, or which was fitted */
+        if (details.count())
+            QMessageBox::information(this, tr("Estimate CdA and Crr"),
+                                     details.join("\n") + "\n\n" +
+                                     QString(details.count() > 1 ? tr("All: CdA %1 Crr %2") : tr("CdA %1 Crr %2"))
+                                     .arg(aerolab->getCda()).arg(aerolab->getCrr()));
     } else {
         /* report error: insufficient data to estimate Cda&Crr */
         QMessageBox::warning(this, tr("Estimate CdA and Crr"), errMsg);
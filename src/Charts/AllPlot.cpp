@@ -50,6 +50,7 @@
 #include <qwt_scale_engine.h>
 
 #include "qwt_plot_gapped_curve.h"
+#include "Trace.h"
 
 #include <QMultiMap>
 
@@ -284,6 +285,8 @@ max(double a, double b) { if (a > b) return a; else return b; }
 AllPlotObject::AllPlotObject(AllPlot *plot, QList<UserData*> user) : plot(plot)
 {
     maxKM = maxSECS = 0;
+    smoothed = -1;
+    smoothedByDist = false;
 
     // user data
     setUserData(user);
@@ -531,6 +534,7 @@ AllPlotObject::setUserData(QList<UserData*>user)
         U[k].curve->detach(); delete U[k].curve;
     }
     U.clear();
+    smoothed = -1;
 
     // setup the U array
     int k=0;
@@ -1634,29 +1638,69 @@ AllPlot::setHighlightIntervals(bool state)
     }
 }
 
-struct DataPoint {
+// how raw values are treated when they are totalled for smoothing,
+// carry repeats the last reading in place of missing (NA) samples
+enum { SmoothRaw, SmoothPositive, SmoothBalance, SmoothCarry };
 
-    double time, hr, watts, atiss, antiss, np, rv, rcad, rgct,
-           smo2, thb, o2hb, hhb, ap, xp, speed, cad, 
-           alt, temp, wind, torque, lrbalance, lte, rte, lps, rps,
-           lpco, rpco, lppb, rppb, lppe, rppe, lpppb, rpppb, lpppe, rpppe,
-           kphd, wattsd, cadd, nmd, hrd, slope, tcore;
+// running totals of the first n samples, totals[i] is the sum of the
+// values before sample i, missing samples count as zero
+static QVector<double>
+runningTotals(const QVector<double> &array, int n, int clamp)
+{
+    QVector<double> totals(n + 1);
+    double total = 0, last = 0;
+    totals[0] = 0;
+    for (int i=0; i<n; i++) {
+        double value = i < array.count() ? array[i] : 0;
+        switch (clamp) {
+        case SmoothPositive: if (value < 0) value = 0; break;
+        case SmoothBalance: if (value <= 0) value = 50; break;
+        case SmoothCarry: if (value == RideFile::NA) value = last; break;
+        }
+        last = value;
+        total += value;
+        totals[i+1] = total;
+    }
+    return totals;
+}
 
-    // user values
-    QList<double>user;
+// running totals are cached against the raw array they came from,
+// they only change when the ride data is set again
+static QVector<double>
+smoothTotals(AllPlotObject *objects, const QVector<double> &array, int clamp)
+{
+    int n = objects->timeArray.count();
+    QHash<const QVector<double>*, QVector<double> >::iterator it = objects->totals.find(&array);
+    if (it == objects->totals.end() || it.value().count() != n + 1)
+        it = objects->totals.insert(&array, runningTotals(array, n, clamp));
+    return it.value();
+}
 
-    DataPoint(double t, double h, double w, double at, double an, double n, double rv, double rcad, double rgct,
-              double smo2, double thb, double o2hb, double hhb, double l, double x, double s, double c,
-              double a, double te, double wi, double tq, double lrb, double lte, double rte, double lps, double rps,
-              double lpco, double rpco, double lppb, double rppb, double lppe, double rppe, double lpppb, double rpppb, double lpppe, double rpppe,
-              double kphd, double wattsd, double cadd, double nmd, double hrd, double sl, double tcore, QList<double>user) :
+// average over the samples in each second's window, hold will repeat
+// the last value when there are no samples (or use empty at the start)
+static void
+smoothWindow(const QVector<double> &totals, const QVector<int> &from, const QVector<int> &to,
+             QVector<double> &smoothed, bool hold=false, double empty=0)
+{
+    smoothed.resize(from.count());
+    for (int secs=0; secs<from.count(); secs++) {
+        int count = to[secs] - from[secs];
+        if (count) smoothed[secs] = (totals[to[secs]] - totals[from[secs]]) / count;
+        else smoothed[secs] = (hold && secs > 0) ? smoothed[secs-1] : empty;
+    }
+}
 
-              time(t), hr(h), watts(w), atiss(at), antiss(an), np(n), rv(rv), rcad(rcad), rgct(rgct),
-              smo2(smo2), thb(thb), o2hb(o2hb), hhb(hhb), ap(l), xp(x), speed(s), cad(c),
-              alt(a), temp(te), wind(wi), torque(tq), lrbalance(lrb), lte(lte), rte(rte), lps(lps), rps(rps),
-              lpco(lpco), rpco(rpco), lppb(lppb), rppb(rppb), lppe(lppe), rppe(rppe), lpppb(lpppb), rpppb(rpppb), lpppe(lpppe), rpppe(rpppe),
-              kphd(kphd), wattsd(wattsd), cadd(cadd), nmd(nmd), hrd(hrd), slope(sl), tcore(tcore), user(user) {}
-};
+// we only calculate series that have data, the rest are zero
+static void
+smoothSeries(AllPlotObject *objects, const QVector<double> &array, const QVector<int> &from, const QVector<int> &to,
+             QVector<double> &smoothed, int clamp=SmoothRaw, bool hold=false)
+{
+    if (array.empty()) {
+        smoothed.fill(0, from.count());
+        return;
+    }
+    smoothWindow(smoothTotals(objects, array, clamp), from, to, smoothed, hold, hold ? array[0] : 0);
+}
 
 bool AllPlot::shadeZones() const
 {
@@ -1835,325 +1879,122 @@ AllPlot::recalc(AllPlotObject *objects)
     
     // we should only smooth the curves if objects->smoothed rate is greater than sample rate
 
-    // user data totals
-    QVector<double> utotals;
-    utotals.resize(objects->U.count());
-    utotals.fill(0);
-
     // Offset for timeOfDay
     if (context->isCompareIntervals || !bytimeofday)
         timeoffset = 0;
     else
         timeoffset = QTime(0, 0).secsTo(rideItem->ride()->startTime().time()) / 60.0;
 
-    if (applysmooth > 0) {
-
-        double totalWatts = 0.0;
-        double totalNP = 0.0;
-        double totalRCad = 0.0;
-        double totalRV = 0.0;
-        double totalRGCT = 0.0;
-        double totalSmO2 = 0.0;
-        double totaltHb = 0.0;
-        double totalO2Hb = 0.0;
-        double totalHHb = 0.0;
-        double totalATISS = 0.0;
-        double totalANTISS = 0.0;
-        double totalXP = 0.0;
-        double totalAP = 0.0;
-        double totalHr = 0.0;
-        double totalTcore = 0.0;
-        double totalSpeed = 0.0;
-        double totalAccel = 0.0;
-        double totalWattsD = 0.0;
-        double totalCadD = 0.0;
-        double totalNmD = 0.0;
-        double totalHrD = 0.0;
-        double totalCad = 0.0;
-        double totalDist = 0.0;
-        double totalAlt = 0.0;
-        double totalSlope = 0.0;
-        double totalTemp = 0.0;
-        double totalWind = 0.0;
-        double totalTorque = 0.0;
-        double totalBalance = 0.0;
-        double totalLTE = 0.0;
-        double totalRTE = 0.0;
-        double totalLPS = 0.0;
-        double totalRPS = 0.0;
-        double totalLPCO = 0.0;
-        double totalRPCO = 0.0;
-        double totalLPPB = 0.0;
-        double totalRPPB = 0.0;
-        double totalLPPE = 0.0;
-        double totalRPPE = 0.0;
-        double totalLPPPB = 0.0;
-        double totalRPPPB = 0.0;
-        double totalLPPPE = 0.0;
-        double totalRPPPE = 0.0;
-        double currentGearRatio = 0.0;
-
-
-        QList<DataPoint> list;
-
-        objects->smoothWatts.resize(rideTimeSecs + 1);
-        objects->smoothNP.resize(rideTimeSecs + 1);
+    if (applysmooth > 0 && objects->smoothed == applysmooth && objects->smoothedByDist == bydist) {
+
+        // nothing changed since we last smoothed, so the
+        // smoothed arrays are still good, just set the curves
+
+    } else if (applysmooth > 0) {
+
+        // do the smoothing by calculating the average of the "applysmooth" values left
+        // of the current data point - for points in time smaller than "applysmooth"
+        // only the available datapoints left are used to build the average
+        //
+        // the samples in the window for each second are found once and shared by
+        // all the series, and the running totals mean the average for a window
+        // is a single subtraction, so changing the smoothing is O(n) per series
+        const QVector<double> &time = objects->timeArray;
+        QVector<int> from(rideTimeSecs + 1), to(rideTimeSecs + 1);
+        int i = 0, j = 0;
+        for (int secs = 0; secs <= rideTimeSecs; ++secs) {
+            while (i < time.count() && time[i] <= secs) ++i;
+            while (j < i && time[j] < secs - applysmooth) ++j; // remove data from before smoothing duration
+            from[secs] = j;
+            to[secs] = i;
+        }
+
+        smoothSeries(objects, objects->wattsArray, from, to, objects->smoothWatts);
+        smoothSeries(objects, objects->npArray, from, to, objects->smoothNP);
+        smoothSeries(objects, objects->rvArray, from, to, objects->smoothRV);
+        smoothSeries(objects, objects->rcadArray, from, to, objects->smoothRCad);
+        smoothSeries(objects, objects->rgctArray, from, to, objects->smoothRGCT);
+        smoothSeries(objects, objects->smo2Array, from, to, objects->smoothSmO2);
+        smoothSeries(objects, objects->thbArray, from, to, objects->smoothtHb);
+        smoothSeries(objects, objects->o2hbArray, from, to, objects->smoothO2Hb);
+        smoothSeries(objects, objects->hhbArray, from, to, objects->smoothHHb);
+        smoothSeries(objects, objects->atissArray, from, to, objects->smoothAT);
+        smoothSeries(objects, objects->antissArray, from, to, objects->smoothANT);
+        smoothSeries(objects, objects->xpArray, from, to, objects->smoothXP);
+        smoothSeries(objects, objects->apArray, from, to, objects->smoothAP);
+        smoothSeries(objects, objects->hrArray, from, to, objects->smoothHr);
+        smoothSeries(objects, objects->tcoreArray, from, to, objects->smoothTcore);
+        smoothSeries(objects, objects->speedArray, from, to, objects->smoothSpeed);
+        smoothSeries(objects, objects->accelArray, from, to, objects->smoothAccel);
+        smoothSeries(objects, objects->wattsDArray, from, to, objects->smoothWattsD);
+        smoothSeries(objects, objects->cadDArray, from, to, objects->smoothCadD);
+        smoothSeries(objects, objects->nmDArray, from, to, objects->smoothNmD);
+        smoothSeries(objects, objects->hrDArray, from, to, objects->smoothHrD);
+        smoothSeries(objects, objects->cadArray, from, to, objects->smoothCad);
+        smoothSeries(objects, objects->slopeArray, from, to, objects->smoothSlope);
+        smoothSeries(objects, objects->tempArray, from, to, objects->smoothTemp, SmoothCarry);
+        smoothSeries(objects, objects->windArray, from, to, objects->smoothWind);
+        smoothSeries(objects, objects->torqueArray, from, to, objects->smoothTorque);
+        smoothSeries(objects, objects->lteArray, from, to, objects->smoothLTE, SmoothPositive);
+        smoothSeries(objects, objects->rteArray, from, to, objects->smoothRTE, SmoothPositive);
+        smoothSeries(objects, objects->lpsArray, from, to, objects->smoothLPS, SmoothPositive);
+        smoothSeries(objects, objects->rpsArray, from, to, objects->smoothRPS, SmoothPositive);
+        smoothSeries(objects, objects->lpcoArray, from, to, objects->smoothLPCO);
+        smoothSeries(objects, objects->rpcoArray, from, to, objects->smoothRPCO);
+
+        // altitude holds the last value when there is a gap
+        smoothSeries(objects, objects->altArray, from, to, objects->smoothAltitude, SmoothRaw, true);
+
+        // user data
+        for(int k=0; k<objects->U.count(); k++) {
+            UserObject &user = objects->U[k];
+            if (user.totals.count() != time.count() + 1) user.totals = runningTotals(user.array, time.count(), SmoothRaw);
+            smoothWindow(user.totals, from, to, user.smooth);
+        }
+
+        // left/right balance, no data is 50/50
+        QVector<double> balance = smoothTotals(objects, objects->balanceArray, SmoothBalance);
+
+        // pedal power phase come in begin/end pairs
+        QVector<double> lppb = smoothTotals(objects, objects->lppbArray, SmoothPositive);
+        QVector<double> lppe = smoothTotals(objects, objects->lppeArray, SmoothPositive);
+        QVector<double> rppb = smoothTotals(objects, objects->rppbArray, SmoothPositive);
+        QVector<double> rppe = smoothTotals(objects, objects->rppeArray, SmoothPositive);
+        QVector<double> lpppb = smoothTotals(objects, objects->lpppbArray, SmoothPositive);
+        QVector<double> lpppe = smoothTotals(objects, objects->lpppeArray, SmoothPositive);
+        QVector<double> rpppb = smoothTotals(objects, objects->rpppbArray, SmoothPositive);
+        QVector<double> rpppe = smoothTotals(objects, objects->rpppeArray, SmoothPositive);
+
         objects->smoothGear.resize(rideTimeSecs + 1);
-        objects->smoothRV.resize(rideTimeSecs + 1);
-        objects->smoothRCad.resize(rideTimeSecs + 1);
-        objects->smoothRGCT.resize(rideTimeSecs + 1);
-        objects->smoothSmO2.resize(rideTimeSecs + 1);
-        objects->smoothtHb.resize(rideTimeSecs + 1);
-        objects->smoothO2Hb.resize(rideTimeSecs + 1);
-        objects->smoothHHb.resize(rideTimeSecs + 1);
-        objects->smoothAT.resize(rideTimeSecs + 1);
-        objects->smoothANT.resize(rideTimeSecs + 1);
-        objects->smoothXP.resize(rideTimeSecs + 1);
-        objects->smoothAP.resize(rideTimeSecs + 1);
-        objects->smoothHr.resize(rideTimeSecs + 1);
-        objects->smoothTcore.resize(rideTimeSecs + 1);
-        objects->smoothSpeed.resize(rideTimeSecs + 1);
-        objects->smoothAccel.resize(rideTimeSecs + 1);
-        objects->smoothWattsD.resize(rideTimeSecs + 1);
-        objects->smoothCadD.resize(rideTimeSecs + 1);
-        objects->smoothNmD.resize(rideTimeSecs + 1);
-        objects->smoothHrD.resize(rideTimeSecs + 1);
-        objects->smoothCad.resize(rideTimeSecs + 1);
         objects->smoothTime.resize(rideTimeSecs + 1);
         objects->smoothDistance.resize(rideTimeSecs + 1);
-        objects->smoothAltitude.resize(rideTimeSecs + 1);
-        objects->smoothSlope.resize(rideTimeSecs + 1);
-        objects->smoothTemp.resize(rideTimeSecs + 1);
-        objects->smoothWind.resize(rideTimeSecs + 1);
         objects->smoothRelSpeed.resize(rideTimeSecs + 1);
-        objects->smoothTorque.resize(rideTimeSecs + 1);
         objects->smoothBalanceL.resize(rideTimeSecs + 1);
         objects->smoothBalanceR.resize(rideTimeSecs + 1);
-        objects->smoothLTE.resize(rideTimeSecs + 1);
-        objects->smoothRTE.resize(rideTimeSecs + 1);
-        objects->smoothLPS.resize(rideTimeSecs + 1);
-        objects->smoothRPS.resize(rideTimeSecs + 1);
-        objects->smoothLPCO.resize(rideTimeSecs + 1);
-        objects->smoothRPCO.resize(rideTimeSecs + 1);
         objects->smoothLPP.resize(rideTimeSecs + 1);
         objects->smoothRPP.resize(rideTimeSecs + 1);
         objects->smoothLPPP.resize(rideTimeSecs + 1);
         objects->smoothRPPP.resize(rideTimeSecs + 1);
-        for(int k=0; k<objects->U.count(); k++) {
-            objects->U[k].smooth.resize(rideTimeSecs + 1);
-        }
 
-        // do the smoothing by calculating the average of the "applysmooth" values left
-        // of the current data point - for points in time smaller than "applysmooth"
-        // only the available datapoints left are used to build the average
-        int i = 0;
         for (int secs = 0; secs <= rideTimeSecs; ++secs) {
-            while ((i < objects->timeArray.count()) && (objects->timeArray[i] <= secs)) {
-
-                // collect user data if its there
-                QList<double> udata;
-                for (int k=0; k<objects->U.count(); k++) udata << (objects->U[k].array.size() > i ? objects->U[k].array[i] : 0);
-
-                // add to list
-                DataPoint dp(objects->timeArray[i],
-                             (!objects->hrArray.empty() ? objects->hrArray[i] : 0),
-                             (!objects->wattsArray.empty() ? objects->wattsArray[i] : 0),
-                             (!objects->atissArray.empty() ? objects->atissArray[i] : 0),
-                             (!objects->antissArray.empty() ? objects->antissArray[i] : 0),
-                             (!objects->npArray.empty() ? objects->npArray[i] : 0),
-                             (!objects->rvArray.empty() ? objects->rvArray[i] : 0),
-                             (!objects->rcadArray.empty() ? objects->rcadArray[i] : 0),
-                             (!objects->rgctArray.empty() ? objects->rgctArray[i] : 0),
-                             (!objects->smo2Array.empty() ? objects->smo2Array[i] : 0),
-                             (!objects->thbArray.empty() ? objects->thbArray[i] : 0),
-                             (!objects->o2hbArray.empty() ? objects->o2hbArray[i] : 0),
-                             (!objects->hhbArray.empty() ? objects->hhbArray[i] : 0),
-                             (!objects->apArray.empty() ? objects->apArray[i] : 0),
-                             (!objects->xpArray.empty() ? objects->xpArray[i] : 0),
-                             (!objects->speedArray.empty() ? objects->speedArray[i] : 0),
-                             (!objects->cadArray.empty() ? objects->cadArray[i] : 0),
-                             (!objects->altArray.empty() ? objects->altArray[i] : 0),
-                             (!objects->tempArray.empty() ? objects->tempArray[i] : 0),
-                             (!objects->windArray.empty() ? objects->windArray[i] : 0),
-                             (!objects->torqueArray.empty() ? objects->torqueArray[i] : 0),
-                             (!objects->balanceArray.empty() ? objects->balanceArray[i] : 0),
-                             (!objects->lteArray.empty() ? objects->lteArray[i] : 0),
-                             (!objects->rteArray.empty() ? objects->rteArray[i] : 0),
-                             (!objects->lpsArray.empty() ? objects->lpsArray[i] : 0),
-                             (!objects->rpsArray.empty() ? objects->rpsArray[i] : 0),
-                             (!objects->lpcoArray.empty() ? objects->lpcoArray[i] : 0),
-                             (!objects->rpcoArray.empty() ? objects->rpcoArray[i] : 0),
-                             (!objects->lppbArray.empty() ? objects->lppbArray[i] : 0),
-                             (!objects->rppbArray.empty() ? objects->rppbArray[i] : 0),
-                             (!objects->lppeArray.empty() ? objects->lppeArray[i] : 0),
-                             (!objects->rppeArray.empty() ? objects->rppeArray[i] : 0),
-                             (!objects->lpppbArray.empty() ? objects->lpppbArray[i] : 0),
-                             (!objects->rpppbArray.empty() ? objects->rpppbArray[i] : 0),
-                             (!objects->lpppeArray.empty() ? objects->lpppeArray[i] : 0),
-                             (!objects->rpppeArray.empty() ? objects->rpppeArray[i] : 0),
-                             (!objects->accelArray.empty() ? objects->accelArray[i] : 0),
-                             (!objects->wattsDArray.empty() ? objects->wattsDArray[i] : 0),
-                             (!objects->cadDArray.empty() ? objects->cadDArray[i] : 0),
-                             (!objects->nmDArray.empty() ? objects->nmDArray[i] : 0),
-                             (!objects->hrDArray.empty() ? objects->hrDArray[i] : 0),
-                             (!objects->slopeArray.empty() ? objects->slopeArray[i] : 0),
-                             (!objects->tcoreArray.empty() ? objects->tcoreArray[i] : 0),
-                            udata);
-
-                // apend to list
-                list.append(dp);
-
-                // maintain totals
-                if (!objects->wattsArray.empty()) totalWatts += objects->wattsArray[i];
-                if (!objects->npArray.empty()) totalNP += objects->npArray[i];
-                if (!objects->rvArray.empty()) totalRV += objects->rvArray[i];
-                if (!objects->rcadArray.empty()) totalRCad += objects->rcadArray[i];
-                if (!objects->rgctArray.empty()) totalRGCT += objects->rgctArray[i];
-                if (!objects->smo2Array.empty()) totalSmO2 += objects->smo2Array[i];
-                if (!objects->thbArray.empty()) totaltHb += objects->thbArray[i];
-                if (!objects->o2hbArray.empty()) totalO2Hb += objects->o2hbArray[i];
-                if (!objects->hhbArray.empty()) totalHHb += objects->hhbArray[i];
-                if (!objects->atissArray.empty()) totalATISS += objects->atissArray[i];
-                if (!objects->antissArray.empty()) totalANTISS += objects->antissArray[i];
-                if (!objects->xpArray.empty()) totalXP += objects->xpArray[i];
-                if (!objects->apArray.empty()) totalAP += objects->apArray[i];
-                if (!objects->tcoreArray.empty()) totalTcore    += objects->tcoreArray[i];
-                if (!objects->hrArray.empty()) totalHr    += objects->hrArray[i];
-                if (!objects->accelArray.empty()) totalAccel += objects->accelArray[i];
-                if (!objects->wattsDArray.empty()) totalWattsD += objects->wattsDArray[i];
-                if (!objects->cadDArray.empty()) totalCadD += objects->cadDArray[i];
-                if (!objects->nmDArray.empty()) totalNmD += objects->nmDArray[i];
-                if (!objects->hrDArray.empty()) totalHrD += objects->hrDArray[i];
-                if (!objects->speedArray.empty()) totalSpeed += objects->speedArray[i];
-                if (!objects->cadArray.empty()) totalCad   += objects->cadArray[i];
-                if (!objects->altArray.empty()) totalAlt   += objects->altArray[i];
-                if (!objects->slopeArray.empty()) totalSlope   += objects->slopeArray[i];
-                if (!objects->windArray.empty()) totalWind   += objects->windArray[i];
-                if (!objects->torqueArray.empty()) totalTorque   += objects->torqueArray[i];
-                if (!objects->tempArray.empty() ) {
-                    if (objects->tempArray[i] == RideFile::NA) {
-                        dp.temp = (i>0 && !list.empty()?list.back().temp:0.0);
-                        totalTemp   += dp.temp;
-                    }
-                    else {
-                        totalTemp   += objects->tempArray[i];
-                    }
-                }
-                if (!objects->balanceArray.empty()) totalBalance   += (objects->balanceArray[i]>0?objects->balanceArray[i]:50);
-                if (!objects->lteArray.empty()) totalLTE   += (objects->lteArray[i]>0?objects->lteArray[i]:0);
-                if (!objects->rteArray.empty()) totalRTE   += (objects->rteArray[i]>0?objects->rteArray[i]:0);
-                if (!objects->lpsArray.empty()) totalLPS   += (objects->lpsArray[i]>0?objects->lpsArray[i]:0);
-                if (!objects->rpsArray.empty()) totalRPS   += (objects->rpsArray[i]>0?objects->rpsArray[i]:0);
-                if (!objects->lpcoArray.empty()) totalLPCO   += objects->lpcoArray[i];
-                if (!objects->rpcoArray.empty()) totalRPCO   += objects->rpcoArray[i];
-                if (!objects->lppbArray.empty()) totalLPPB   += (objects->lppbArray[i]>0?objects->lppbArray[i]:0);
-                if (!objects->rppbArray.empty()) totalRPPB   += (objects->rppbArray[i]>0?objects->rppbArray[i]:0);
-                if (!objects->lppeArray.empty()) totalLPPE   += (objects->lppeArray[i]>0?objects->lppeArray[i]:0);
-                if (!objects->rppeArray.empty()) totalRPPE   += (objects->rppeArray[i]>0?objects->rppeArray[i]:0);
-                if (!objects->lpppbArray.empty()) totalLPPPB   += (objects->lpppbArray[i]>0?objects->lpppbArray[i]:0);
-                if (!objects->rpppbArray.empty()) totalRPPPB   += (objects->rpppbArray[i]>0?objects->rpppbArray[i]:0);
-                if (!objects->lpppeArray.empty()) totalLPPPE   += (objects->lpppeArray[i]>0?objects->lpppeArray[i]:0);
-                if (!objects->rpppeArray.empty()) totalRPPPE   += (objects->rpppeArray[i]>0?objects->rpppeArray[i]:0);
-
-                // set values which must not be smoothed
-                if (!objects->gearArray.empty()) currentGearRatio = (objects->gearArray[i]>0?objects->gearArray[i]:0);
-                totalDist   = objects->distanceArray[i];
-
-                // totalise user data
-                for(int k=0; k<utotals.count(); k++) utotals[k] += udata[k];
-
-                ++i;
-            }
 
-            // remove data from before smoothing duration (er, really?)
-            while (!list.empty() && (list.front().time < secs - applysmooth)) {
-                DataPoint &dp = list.front();
-                totalWatts -= dp.watts;
-                totalNP -= dp.np;
-                totalRV -= dp.rv;
-                totalRCad -= dp.rcad;
-                totalRGCT -= dp.rgct;
-                totalSmO2 -= dp.smo2;
-                totaltHb -= dp.thb;
-                totalO2Hb -= dp.o2hb;
-                totalHHb -= dp.hhb;
-                totalATISS -= dp.atiss;
-                totalANTISS -= dp.antiss;
-                totalAP -= dp.ap;
-                totalXP -= dp.xp;
-                totalHr    -= dp.hr;
-                totalTcore    -= dp.tcore;
-                totalSpeed -= dp.speed;
-                totalAccel -= dp.kphd;
-                totalWattsD -= dp.wattsd;
-                totalCadD -= dp.cadd;
-                totalNmD -= dp.nmd;
-                totalHrD -= dp.hrd;
-                totalCad   -= dp.cad;
-                totalAlt   -= dp.alt;
-                totalSlope -= dp.slope;
-                totalTemp   -= dp.temp;
-                totalWind   -= dp.wind;
-                totalTorque   -= dp.torque;
-                totalLTE   -= dp.lte;
-                totalRTE   -= dp.rte;
-                totalLPS   -= dp.lps;
-                totalRPS   -= dp.rps;
-                totalLPCO  -= dp.lpco;
-                totalRPCO  -= dp.rpco;
-                totalLPPB   -= dp.lppb;
-                totalRPPB   -= dp.rppb;
-                totalLPPE   -= dp.lppe;
-                totalRPPE   -= dp.rppe;
-                totalLPPPB  -= dp.lpppb;
-                totalRPPPB  -= dp.rpppb;
-                totalLPPPE  -= dp.lpppe;
-                totalRPPPE  -= dp.rpppe;
-                totalBalance   -= (dp.lrbalance>0?dp.lrbalance:50);
-                for(int k=0; k<utotals.count(); k++) utotals[k] -= dp.user[k];
-
-                list.removeFirst();
-            }
+            int first = from[secs];
+            int last = to[secs];
+            int count = last - first;
+
+            // set values which must not be smoothed, they are
+            // just the last value we've seen
+            double totalDist = last ? objects->distanceArray[last-1] : 0.0;
+            double gear = (last && !objects->gearArray.empty()) ? objects->gearArray[last-1] : 0.0;
+            objects->smoothGear[secs] = gear > 0 ? gear : 0;
+            objects->smoothDistance[secs] = totalDist;
+            objects->smoothTime[secs]  =  secs / 60.0;
 
             // TODO: this is wrong.  We should do a weighted average over the
             // seconds represented by each point...
-            if (list.empty()) {
-
-                for (int k=0; k<objects->U.count(); k++) objects->U[k].smooth[secs] = 0.0;
-                objects->smoothWatts[secs] = 0.0;
-                objects->smoothNP[secs] = 0.0;
-                objects->smoothRV[secs] = 0.0;
-                objects->smoothRCad[secs] = 0.0;
-                objects->smoothRGCT[secs] = 0.0;
-                objects->smoothSmO2[secs] = 0.0;
-                objects->smoothtHb[secs] = 0.0;
-                objects->smoothO2Hb[secs] = 0.0;
-                objects->smoothHHb[secs] = 0.0;
-                objects->smoothAT[secs] = 0.0;
-                objects->smoothANT[secs] = 0.0;
-                objects->smoothXP[secs] = 0.0;
-                objects->smoothAP[secs] = 0.0;
-                objects->smoothHr[secs]    = 0.0;
-                objects->smoothTcore[secs]    = 0.0;
-                objects->smoothSpeed[secs] = 0.0;
-                objects->smoothAccel[secs] = 0.0;
-                objects->smoothWattsD[secs] = 0.0;
-                objects->smoothCadD[secs] = 0.0;
-                objects->smoothNmD[secs] = 0.0;
-                objects->smoothHrD[secs] = 0.0;
-                objects->smoothCad[secs]   = 0.0;
-                objects->smoothAltitude[secs]   = ((secs > 0) ? objects->smoothAltitude[secs - 1] : objects->altArray[secs] ) ;
-                objects->smoothSlope[secs]   =  0.0;
-                objects->smoothTemp[secs]   = 0.0;
-                objects->smoothWind[secs] = 0.0;
+            if (count == 0) {
+
                 objects->smoothRelSpeed[secs] =  QwtIntervalSample();
-                objects->smoothTorque[secs] = 0.0;
-                objects->smoothLTE[secs] = 0.0;
-                objects->smoothRTE[secs] = 0.0;
-                objects->smoothLPS[secs] = 0.0;
-                objects->smoothRPS[secs] = 0.0;
-                objects->smoothLPCO[secs] = 0.0;
-                objects->smoothRPCO[secs] = 0.0;
                 objects->smoothLPP[secs] = QwtIntervalSample();
                 objects->smoothRPP[secs] = QwtIntervalSample();
                 objects->smoothLPPP[secs] = QwtIntervalSample();
@@ -2163,72 +2004,39 @@ AllPlot::recalc(AllPlotObject *objects)
 
             } else {
 
-                for(int k=0; k<utotals.count(); k++) objects->U[k].smooth[secs] = utotals[k] / list.size();
-                objects->smoothWatts[secs]    = totalWatts / list.size();
-                objects->smoothNP[secs]    = totalNP / list.size();
-                objects->smoothRV[secs]    = totalRV / list.size();
-                objects->smoothRCad[secs]    = totalRCad / list.size();
-                objects->smoothRGCT[secs]    = totalRGCT / list.size();
-                objects->smoothSmO2[secs]    = totalSmO2 / list.size();
-                objects->smoothtHb[secs]    = totaltHb / list.size();
-                objects->smoothO2Hb[secs]    = totalO2Hb / list.size();
-                objects->smoothHHb[secs]    = totalHHb / list.size();
-                objects->smoothAT[secs]    = totalATISS / list.size();
-                objects->smoothANT[secs]    = totalANTISS / list.size();
-                objects->smoothXP[secs]    = totalXP / list.size();
-                objects->smoothAP[secs]    = totalAP / list.size();
-                objects->smoothHr[secs]       = totalHr / list.size();
-                objects->smoothTcore[secs]       = totalTcore / list.size();
-                objects->smoothSpeed[secs]    = totalSpeed / list.size();
-                objects->smoothAccel[secs]    = totalAccel / double(list.size());
-                objects->smoothWattsD[secs]    = totalWattsD / double(list.size());
-                objects->smoothCadD[secs]    = totalCadD / double(list.size());
-                objects->smoothNmD[secs]    = totalNmD / double(list.size());
-                objects->smoothHrD[secs]    = totalHrD / double(list.size());
-                objects->smoothCad[secs]      = totalCad / list.size();
-                objects->smoothAltitude[secs]      = totalAlt / list.size();
-                objects->smoothSlope[secs]      = totalSlope / double(list.size());
-                objects->smoothTemp[secs]      = totalTemp / list.size();
-                objects->smoothWind[secs]    = totalWind / list.size();
-                objects->smoothTorque[secs]    = totalTorque / list.size();
-                objects->smoothRelSpeed[secs] =  QwtIntervalSample(bydist ? totalDist : secs / 60.0, 
-                                                                   QwtInterval(qMin(totalWind / list.size(),
-                                                                   totalSpeed / list.size()), 
-                                                                   qMax(totalWind / list.size(), 
-                                                                   totalSpeed / list.size())));
+                double x = bydist ? totalDist : secs / 60.0;
+                double wind = objects->smoothWind[secs];
+                double speed = objects->smoothSpeed[secs];
+                objects->smoothRelSpeed[secs] =  QwtIntervalSample(x, QwtInterval(qMin(wind, speed), qMax(wind, speed)));
 
                 // left /right pedal data
-                double balance = totalBalance / list.size();
-                if (balance == 0) {
+                double mean = (balance[last] - balance[first]) / count;
+                if (mean == 0) {
                     objects->smoothBalanceL[secs]    = 50;
                     objects->smoothBalanceR[secs]    = 50;
-                } else if (balance >= 50) {
-                    objects->smoothBalanceL[secs]    = balance;
+                } else if (mean >= 50) {
+                    objects->smoothBalanceL[secs]    = mean;
                     objects->smoothBalanceR[secs]    = 50;
                 }
                 else {
                     objects->smoothBalanceL[secs]    = 50;
-                    objects->smoothBalanceR[secs]    = balance;
+                    objects->smoothBalanceR[secs]    = mean;
                 }
-                objects->smoothLTE[secs]    = totalLTE / list.size();
-                objects->smoothRTE[secs]    = totalRTE / list.size();
-                objects->smoothLPS[secs]    = totalLPS / list.size();
-                objects->smoothRPS[secs]    = totalRPS / list.size();
-                objects->smoothLPCO[secs]   = totalLPCO / list.size();
-                objects->smoothRPCO[secs]   = totalRPCO / list.size();
-                objects->smoothLPP[secs]    = QwtIntervalSample( bydist ? totalDist : secs / 60.0, QwtInterval(totalLPPB / list.size(), totalLPPE / list.size() ) );
-                objects->smoothRPP[secs]    = QwtIntervalSample( bydist ? totalDist : secs / 60.0, QwtInterval(totalRPPB / list.size(), totalRPPE / list.size() ) );
-                objects->smoothLPPP[secs]   = QwtIntervalSample( bydist ? totalDist : secs / 60.0, QwtInterval(totalLPPPB / list.size(), totalLPPPE / list.size() ) );
-                objects->smoothRPPP[secs]   = QwtIntervalSample( bydist ? totalDist : secs / 60.0, QwtInterval(totalRPPPB / list.size(), totalRPPPE / list.size() ) );
+                objects->smoothLPP[secs]    = QwtIntervalSample(x, QwtInterval((lppb[last] - lppb[first]) / count, (lppe[last] - lppe[first]) / count));
+                objects->smoothRPP[secs]    = QwtIntervalSample(x, QwtInterval((rppb[last] - rppb[first]) / count, (rppe[last] - rppe[first]) / count));
+                objects->smoothLPPP[secs]   = QwtIntervalSample(x, QwtInterval((lpppb[last] - lpppb[first]) / count, (lpppe[last] - lpppe[first]) / count));
+                objects->smoothRPPP[secs]   = QwtIntervalSample(x, QwtInterval((rpppb[last] - rpppb[first]) / count, (rpppe[last] - rpppe[first]) / count));
             }
-            objects->smoothGear[secs] = currentGearRatio;
-            objects->smoothDistance[secs] = totalDist;
-            objects->smoothTime[secs]  =  secs / 60.0;
         }
 
+        // remember so we can skip it next time
+        objects->smoothed = applysmooth;
+        objects->smoothedByDist = bydist;
+
     } else {
 
         // no standard->smoothing .. just raw data
+        objects->smoothed = -1;
         for (int k=0; k<objects->U.count(); k++) objects->U[k].smooth.resize(0);
         objects->smoothWatts.resize(0);
         objects->smoothNP.resize(0);
@@ -5446,6 +5254,8 @@ AllPlot::setDataFromRide(RideItem *_rideItem, QList<UserData*>user)
 void
 AllPlot::setDataFromRideFile(RideFile *ride, AllPlotObject *here, QList<UserData*>user)
 {
+    GC_TRACE_SPAN("AllPlot::setDataFromRideFile");
+
     if (ride && ride->dataPoints().size()) {
         const RideFileDataPresent *dataPresent = ride->areDataPresent();
         int npoints = ride->dataPoints().size();
@@ -5505,6 +5315,11 @@ AllPlot::setDataFromRideFile(RideFile *ride, AllPlotObject *here, QList<UserData
         here->distanceArray.resize(npoints);
         for(int k=0; k<here->U.count(); k++) here->U[k].array.resize(npoints);
 
+        // new data, so anything smoothed is out of date
+        here->totals.clear();
+        for(int k=0; k<here->U.count(); k++) here->U[k].totals.clear();
+        here->smoothed = -1;
+
         // attach appropriate curves
         here->wCurve->detach();
         here->mCurve->detach();
@@ -347,6 +347,7 @@ struct UserObject {
     QString name, units;
     QVector<double> array;
     QVector<double> smooth;
+    QVector<double> totals; // running totals for smoothing
     QwtPlotGappedCurve    *curve;
     QVector<QwtZone> zones;
     QColor          color;
@@ -532,6 +533,12 @@ class AllPlotObject : public QObject
     QVector<QwtIntervalSample> smoothRPPP;
     QVector<QwtIntervalSample> smoothRelSpeed;
 
+    // running totals of the raw arrays so a smoothing window is a
+    // subtraction, and what the smoothed arrays were last built for
+    QHash<const QVector<double>*, QVector<double> > totals;
+    int smoothed; // applied smoothing, -1 if out of date
+    bool smoothedByDist;
+
     // setup as copy from user data
     void setUserData(QList<UserData*>); // reset below to reflect current
     QList<UserObject> U;
@@ -25,6 +25,7 @@
 #include "CPPlot.h"
 #include "PowerProfile.h"
 #include "RideCache.h"
+#include "RideCentiles.h"
 #include "Banister.h"
 
 #include <QDebug>
@@ -53,6 +54,7 @@
 #include "LTMCanvasPicker.h"
 #include "TimeUtils.h"
 #include "Units.h"
+#include "Trace.h"
 
 #include "LTMTrend.h"
 
@@ -1974,6 +1976,8 @@ CPPlot::setRide(RideItem *rideItem)
     // null ride ?
     if (!rideItem) return;
 
+    GC_TRACE_SPAN("CPPlot::setRide");
+
     // Season Compare Mode -- so nothing for us to do
     if (rangemode && context->isCompareDateRanges) return calculateForDateRanges(context->compareDateRanges);
 
@@ -2049,8 +2053,8 @@ CPPlot::setRide(RideItem *rideItem)
         case 1 :
             {
                 // CENTILE
-                // calculates all the data from the raw ride data, so doesn't need
-                // a cache and doesn't make sense to plot reference lines
+                // computed from the raw ride data and cached on refresh,
+                // it doesn't make sense to plot reference lines
                 plotCentile(rideItem);
             }
             break;
@@ -2455,220 +2459,23 @@ CPPlot::setPlotType(int index)
     clearCurves();
 }
 
-// calculate and plot a centile plot
+// plot the centiles, they are computed when the ride is refreshed
 void
 CPPlot::plotCentile(RideItem *rideItem)
 {
-    qDebug() << "calculateCentile";
-    QTime elapsed;
-    elapsed.start();
-
-    qDebug() << "prepare datas ";
-    cpintdata data;
-    data.rec_int_ms = (int) round(rideItem->ride()->recIntSecs() * 1000.0);
-    double lastsecs = 0;
-    bool first = true;
-    double offset = 0;
-
-    foreach (const RideFilePoint *p, rideItem->ride()->dataPoints()) {
-
-        // get offset to apply on all samples if first sample
-        if (first == true) {
-            offset = p->secs;
-            first = false;
-        }
-
-        // drag back to start at 0s
-        double psecs = p->secs - offset;
-
-        // fill in any gaps in recording - use same dodgy rounding as before
-        int count = (psecs - lastsecs - rideItem->ride()->recIntSecs()) / rideItem->ride()->recIntSecs();
-
-        // gap more than an hour, damn that ride file is a mess
-        if (count > 3600) count = 1;
+    RideCentiles centiles(context, rideItem);
+    if (centiles.isEmpty()) return;
 
-        for(int i=0; i<count; i++) {
-            data.points.append(cpintpoint(round(lastsecs+((i+1)*rideItem->ride()->recIntSecs() *1000.0)/1000), 0));
-        }
-
-        lastsecs = psecs;
-
-        double secs = round(psecs * 1000.0) / 1000;
-        if (secs > 0)  {
-            if (round(p->value(RideFile::watts))>1400)
-                qDebug() << "append point " <<  round(p->value(RideFile::watts)) ;
-            data.points.append(cpintpoint(secs, (int) round(p->value(RideFile::watts))));
-        }
-    }
-
-    int total_secs = (int) ceil(rideItem->ride()->dataPoints().back()->secs);
-
-    QVector < QVector<double> > ride_centiles(10);
-    // Initialisation
+    // every second up to the longest duration, the durations are
+    // sparse after 6 minutes so hold the last value across the gaps
+    const QVector<int> &durations = centiles.durations();
+    QVector < QVector<double> > ride_centiles(RideCentiles::centileCount);
     for (int i = 0; i < ride_centiles.size(); ++i) {
-        ride_centiles[i] = QVector <double>(total_secs);
-    }
-
-    qDebug() << "end prepare datas " << elapsed.elapsed();
-    qDebug() << "calcul for first 6min ";
-
-    // loop through the decritized data from top
-    // FIRST 6 MINUTES DO BESTS FOR EVERY SECOND
-    // WE DO NOT DO THIS FOR IsoPower or xPower SINCE
-    // IT IS WELL KNOWN THAT THEY ARE NOT VALID
-    // FOR SUCH SHORT DURATIONS AND IT IS VERY
-    // CPU INTENSIVE, SO WE DON'T BOTHER
-
-    double samplerate = rideItem->ride()->recIntSecs();
-
-    for (int slice = 1; slice < 360;) {
-        int windowsize = slice / samplerate;
-        QVector<double> sums(data.points.size()-windowsize+1);
-
-        int index=0;
-        double sum=0;
-
-        for (int i=0; i<data.points.size(); i++) {
-            sum += data.points[i].value;
+        ride_centiles[i] = QVector <double>(durations.last() + 1);
 
-            if (i>windowsize-1)
-                sum -= data.points[i-windowsize].value;
+        const QVector<float> &values = centiles.centile(i);
+        for (int j=0; j<durations.size(); j++) ride_centiles[i][durations[j]] = values[j];
 
-            if (i>=windowsize-1) {
-                sums[index++] = sum/windowsize;
-            }
-
-        }
-        //qSort(sums.begin(), sums.end());
-        qSort(sums);
-
-        qDebug() << "sums (" << slice << ") : " << sums.size() << " max " << sums[sums.size()-1];
-
-        ride_centiles[9][slice] = sums[sums.size()-1];
-
-        for (int i = ride_centiles.size()-1; i > 0; --i) {
-            sum = 0;
-            int count = 0;
-
-            for (int n = (0.1*i)*sums.size(); n < sums.size()-1 && n < (0.1*(i+1))*sums.size(); ++n) {
-                sum += sums[n];
-                count++;
-            }
-            if (sum > 0) {
-                double avg = sum / count;
-                ride_centiles[i-1][slice]=avg;
-            } else {
-                ride_centiles[i-1][slice]=ride_centiles[i][slice];
-            }
-        }
-
-        slice ++;
-    }
-
-    qDebug() << "end calcul for first 6min " << elapsed.elapsed();
-    qDebug() << "downsampling to 5s after 6min ";
-
-    QVector<double> downsampled(0);
-
-    // moving to 5s samples would INCREASE the work...
-    if (rideItem->ride()->recIntSecs() >= 5) {
-        samplerate = rideItem->ride()->recIntSecs();
-        for (int i=0; i<data.points.size(); i++)
-            downsampled.append(data.points[i].value);
-    } else {
-        // moving to 5s samples is DECREASING the work...
-        samplerate = 5;
-        // we are downsampling to 5s
-        long five=5; // start at 1st 5s sample
-        double fivesum=0;
-
-        int fivecount=0;
-
-        for (int i=0; i<data.points.size(); i++) {
-            if (data.points[i].secs <= five) {
-                fivesum += data.points[i].value;
-                fivecount++;
-            } else {
-                downsampled.append(fivesum / fivecount);
-                fivecount = 1;
-                fivesum = data.points[i].value;
-
-                five += 5;
-            }
-        }
-    }
-
-    qDebug() << "end downsampling to 5s after 6min " << elapsed.elapsed();
-    qDebug() << "calcul for rest of ride ";
-
-    for (int slice = 360; slice < ride_centiles[9].size();) {
-        int windowsize = slice / samplerate;
-        QVector<double> sums(downsampled.size()-windowsize+2);
-
-
-        int index=0;
-        double sum=0;
-
-        for (int i=0; i<downsampled.size(); i++) {
-            sum += downsampled[i];
-
-            if (i>windowsize-1)
-                sum -= downsampled[i-windowsize];
-            if (i>=windowsize-1)
-                sums[index++] = sum / windowsize;
-
-        }
-        //qSort(sums.begin(), sums.end());
-        qSort(sums);
-
-        qDebug() << "sums (" << slice << ") : " << sums.size() << " max " << sums[sums.size()-1];
-
-
-
-        ride_centiles[9][slice] = sums[sums.size()-1];
-
-        for (int i = ride_centiles.size()-1; i > 0; --i) {
-            sum = 0;
-            int count = 0;
-
-            for (int n = (0.1*i)*sums.size(); n < sums.size() && n < (0.1*(i+1))*sums.size(); ++n) {
-                if (sums[n]>0)  {
-                    sum += sums[n];
-                    count++;
-                }
-            }
-            if (sum > 0) {
-                double avg = sum / count;
-                ride_centiles[i-1][slice]=avg;
-            } else {
-                ride_centiles[i-1][slice]=ride_centiles[i][slice];
-            }
-        }
-
-
-
-        // increment interval duration we are going to search
-        // for next, gaps increase as duration increases to
-        // reduce overall work, since we require far less
-        // precision as the ride duration increases
-        if (slice < 3600) slice +=20; // 20s up to one hour
-        else if (slice < 7200) slice +=60; // 1m up to two hours
-        else if (slice < 10800) slice += 300; // 5mins up to three hours
-        else slice += 600; // 10mins after that
-    }
-
-    qDebug() << "end calcul for rest of ride " << elapsed.elapsed();
-    qDebug() << "fill gaps ";
-
-    /*for (int i = 0; i<ride_centiles.size(); i++) {
-        double last=0.0;
-        for (int j=ride_centiles[i].size()-1; j; j--) {
-            if (ride_centiles[i][j] == 0) ride_centiles[i][j]=last;
-            else last = ride_centiles[i][j];
-        }
-    }*/
-
-    for (int i = ride_centiles.size()-1; i>=0; i--) {
         double last=0.0;
         for (int j=0; j<ride_centiles[i].size(); j++) {
             if (ride_centiles[i][j] == 0) ride_centiles[i][j]=last;
@@ -2676,10 +2483,6 @@ CPPlot::plotCentile(RideItem *rideItem)
         }
     }
 
-    qDebug() << "end fill gaps " << elapsed.elapsed();
-    qDebug() << "plotting ";
-
-
     for (int i = 0; i<ride_centiles.size(); i++) {
         int maxNonZero = 0;
         QVector<double> timeArray(ride_centiles[i].size());
@@ -2708,8 +2511,6 @@ CPPlot::plotCentile(RideItem *rideItem)
         }
     }
 
-
-    qDebug() << "end plotting " << elapsed.elapsed();
     zoomer->setZoomBase(false);
 }
 
@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "GenericDecimator.h"
+
+#include <QSet>
+#include <algorithm>
+#include <cmath>
+
+// for lower_bound on x
+struct CompareDecimatorX { bool operator()(const QPointF &p1, const QPointF &p2) { return p1.x() < p2.x(); } };
+
+// reduce a run of points to its min and max, in the order they occur
+static void minmax(const QPointF *p, int n, QVector<QPointF> &out)
+{
+    if (n <= 0) return;
+    if (n == 1) { out << p[0]; return; }
+
+    int lo=0, hi=0;
+    for(int i=1; i<n; i++) {
+        if (p[i].y() < p[lo].y()) lo = i;
+        if (p[i].y() > p[hi].y()) hi = i;
+    }
+    if (lo == hi) out << p[lo];
+    else if (lo < hi) out << p[lo] << p[hi];
+    else out << p[hi] << p[lo];
+}
+
+bool
+GenericDecimator::wanted(const QVector<double> &xseries, const QVector<double> &yseries, bool scatter)
+{
+    int n = qMin(xseries.count(), yseries.count());
+    if (n < threshold) return false;
+    if (scatter) return true;
+
+    // line decimation works on x ranges
+    for(int i=1; i<n; i++) if (xseries[i] < xseries[i-1]) return false;
+    return true;
+}
+
+GenericDecimator::GenericDecimator(const QVector<double> &xseries, const QVector<double> &yseries, bool scatter) : scatter(scatter)
+{
+    int n = qMin(xseries.count(), yseries.count());
+
+    QVector<QPointF> full(n);
+    for(int i=0; i<n; i++) full[i] = QPointF(xseries[i], yseries[i]);
+    levels << full;
+
+    if (scatter) return;
+
+    // each level takes the min and max of every 4 points in the level
+    // below, so it halves in size but keeps the extremes
+    while (levels.last().count() > threshold) {
+        const QVector<QPointF> &below = levels.last();
+        QVector<QPointF> level;
+        level.reserve(below.count()/2 + 2);
+        for(int i=0; i<below.count(); i += 4) minmax(below.constData()+i, qMin(4, below.count()-i), level);
+        levels << level;
+    }
+}
+
+QVector<QPointF>
+GenericDecimator::points(double minx, double maxx, int budget) const
+{
+    if (budget < 1) budget = 1;
+
+    // coarsest level that still has at least 2 points per bucket in
+    // the visible range, so the min/max we take are still accurate
+    const QVector<QPointF> *use = &levels[0];
+    int from=0, to=use->count();
+    for(int l=levels.count()-1; l>=0; l--) {
+        const QVector<QPointF> &level = levels[l];
+        int f = std::lower_bound(level.begin(), level.end(), QPointF(minx,0), CompareDecimatorX()) - level.begin();
+        int t = std::lower_bound(level.begin(), level.end(), QPointF(maxx,0), CompareDecimatorX()) - level.begin();
+
+        // include the points either side so the line runs off the edges
+        if (f > 0) f--;
+        if (t < level.count()) t++;
+
+        if (t-f >= budget*4 || l == 0) {
+            use = &level;
+            from = f;
+            to = t;
+            break;
+        }
+    }
+
+    // nothing to decimate
+    int n = to-from;
+    if (n <= budget*2) return use->mid(from, n);
+
+    // min/max per bucket
+    QVector<QPointF> returning;
+    returning.reserve(budget*2 + 2);
+    double step = double(n) / double(budget);
+    for(int b=0; b<budget; b++) {
+        int start = from + int(b*step);
+        int stop = (b == budget-1) ? to : from + int((b+1)*step);
+        minmax(use->constData()+start, stop-start, returning);
+    }
+    return returning;
+}
+
+QVector<QPointF>
+GenericDecimator::points(QRectF visible, int width, int height) const
+{
+    const QVector<QPointF> &all = levels[0];
+    if (width < 1 || height < 1 || visible.width() <= 0 || visible.height() <= 0) return all;
+
+    // one point per pixel cell, first come first served
+    QVector<QPointF> returning;
+    QSet<qint64> occupied;
+    double sx = double(width) / visible.width();
+    double sy = double(height) / visible.height();
+    for(int i=0; i<all.count(); i++) {
+        const QPointF &p = all[i];
+        if (!visible.contains(p)) continue;
+
+        qint64 cx = qint64(std::floor((p.x() - visible.left()) * sx));
+        qint64 cy = qint64(std::floor((p.y() - visible.top()) * sy));
+        qint64 cell = (cy << 32) | (cx & 0xffffffff);
+        if (occupied.contains(cell)) continue;
+
+        occupied.insert(cell);
+        returning << p;
+    }
+    return returning;
+}
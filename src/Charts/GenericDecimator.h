@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _GC_GenericDecimator_h
+#define _GC_GenericDecimator_h 1
+
+#include <QVector>
+#include <QPointF>
+#include <QRectF>
+#include <QList>
+
+//
+// Reduces the points handed to QtCharts to what can actually be seen.
+//
+// Line curves are decimated keeping the minimum and maximum in each
+// bucket so peaks and troughs survive, and a pyramid of successively
+// halved levels is built once so a zoom only needs to look at the
+// coarsest level that still has enough points in the visible range.
+//
+// Scatter curves are thinned to one point per pixel cell in the visible
+// area, since overplotted markers are indistinguishable anyway.
+//
+// The full data is kept so the select tool can calculate on it.
+//
+class GenericDecimator
+{
+    public:
+
+        // below this many points we don't bother
+        static const int threshold = 4000;
+
+        GenericDecimator(const QVector<double> &xseries, const QVector<double> &yseries, bool scatter);
+
+        // is it worth it, and can we (line curves need ascending x)
+        static bool wanted(const QVector<double> &xseries, const QVector<double> &yseries, bool scatter);
+
+        // points to plot for the visible range, budget is typically
+        // the plot width in pixels (scatter uses the height too)
+        QVector<QPointF> points(double minx, double maxx, int budget) const;
+        QVector<QPointF> points(QRectF visible, int width, int height) const;
+
+        // all of it
+        const QVector<QPointF> &data() const { return levels[0]; }
+
+    private:
+
+        bool scatter;
+        QList<QVector<QPointF> > levels; // 0 is the full data
+};
+#endif
@@ -17,6 +17,7 @@
  */
 
 #include "GenericPlot.h"
+#include "GenericDecimator.h"
 #include "GenericChart.h"
 
 #include "Colors.h"
@@ -41,6 +42,7 @@ GenericPlot::GenericPlot(QWidget *parent, Context *context) : QWidget(parent), c
     chartview=NULL;
     barseries=NULL;
     bottom=left=true;
+    decimatedwidth=0;
 
     mainLayout = new QVBoxLayout(this);
     mainLayout->setSpacing(0);
@@ -263,10 +265,70 @@ static bool myqRectLess(const QRectF left, const QRectF right)
     return (left.x() < right.x());
 }
 
+// points we can usefully draw across the plot area
+int
+GenericPlot::decimationBudget(Qt::Orientation orientation)
+{
+    double size = orientation == Qt::Horizontal ? qchart->plotArea().width() : qchart->plotArea().height();
+    if (size < 100) size = orientation == Qt::Horizontal ? chartview->width() : chartview->height();
+    return qMax(100, int(size));
+}
+
+// range of the axis in series values
+static bool axisRange(QAbstractSeries *series, Qt::Orientation orientation, double &min, double &max)
+{
+    foreach(QAbstractAxis *axis, series->attachedAxes()) {
+        if (axis->orientation() != orientation) continue;
+        switch(axis->type()) {
+        case QAbstractAxis::AxisTypeValue:
+            min = static_cast<QValueAxis*>(axis)->min(); max = static_cast<QValueAxis*>(axis)->max(); return true;
+        case QAbstractAxis::AxisTypeLogValue:
+            min = static_cast<QLogValueAxis*>(axis)->min(); max = static_cast<QLogValueAxis*>(axis)->max(); return true;
+        case QAbstractAxis::AxisTypeDateTime:
+            min = static_cast<QDateTimeAxis*>(axis)->min().toMSecsSinceEpoch();
+            max = static_cast<QDateTimeAxis*>(axis)->max().toMSecsSinceEpoch();
+            return true;
+        default:
+            return false;
+        }
+    }
+    return false;
+}
+
+// zoomed or resized, so pick the points to show again
+void
+GenericPlot::redecimate()
+{
+    QMapIterator<QAbstractSeries*, GenericDecimator*> i(decimators);
+    while (i.hasNext()) {
+        i.next();
+
+        QXYSeries *series = static_cast<QXYSeries*>(i.key());
+        QXYSeries *dec = static_cast<QXYSeries*>(decorations.value(i.key(), NULL));
+
+        double minx, maxx, miny, maxy;
+        if (!axisRange(series, Qt::Horizontal, minx, maxx)) continue;
+
+        if (series->type() == QAbstractSeries::SeriesTypeScatter) {
+            if (!axisRange(series, Qt::Vertical, miny, maxy)) continue;
+            series->replace(i.value()->points(QRectF(minx, miny, maxx-minx, maxy-miny), decimationBudget(), decimationBudget(Qt::Vertical)));
+        } else {
+            series->replace(i.value()->points(minx, maxx, decimationBudget()));
+            if (dec) dec->replace(series->pointsVector());
+        }
+    }
+}
+
 // resizing, so plot area changed and likely all the scene moved
 void
 GenericPlot::plotAreaChanged()
 {
+    // point budget depends upon the plot width
+    if (decimators.count() && qchart->plotArea().width() != decimatedwidth) {
+        decimatedwidth = qchart->plotArea().width();
+        redecimate();
+    }
+
     // we need to recalculate the axis geometries
     // since the qchart methods do not make any of
     // this public we have to search through the
@@ -372,6 +434,9 @@ GenericPlot::initialiseChart(QString title, int type, bool animate, int legpos)
     foreach(Quadtree *tree, quadtrees) delete tree;
     quadtrees.clear();
 
+    foreach(GenericDecimator *decimator, decimators) delete decimator;
+    decimators.clear();
+
     foreach(GenericAxisInfo *axisinfo, axisinfos) delete axisinfo;
     axisinfos.clear();
 
@@ -458,6 +523,9 @@ GenericPlot::addCurve(QString name, QVector<double> xseries, QVector<double> yse
                 delete decor;
                 decorations.remove(existing);
             }
+
+            delete decimators.value(existing, NULL);
+            decimators.remove(existing);
         }
     }
 
@@ -513,9 +581,15 @@ GenericPlot::addCurve(QString name, QVector<double> xseries, QVector<double> yse
             add->setPen(pen);
             add->setOpacity(double(opacity) / 100.0); // 0-100% to 0.0-1.0 values
 
-            // data
+            // data, decimated if there is lots of it
+            GenericDecimator *decimator = NULL;
+            if (GenericDecimator::wanted(xseries, yseries, false)) {
+                decimator = new GenericDecimator(xseries, yseries, false);
+                decimators.insert(add, decimator);
+                add->replace(decimator->points(xseries.first(), xseries.last(), decimationBudget()));
+            }
             for (int i=0; i<xseries.size() && i<yseries.size(); i++) {
-                add->append(xseries.at(i), yseries.at(i));
+                if (!decimator) add->append(xseries.at(i), yseries.at(i));
 
                 // tell axis about the data
                 xaxis->point(xseries.at(i), yseries.at(i));
@@ -553,7 +627,8 @@ GenericPlot::addCurve(QString name, QVector<double> xseries, QVector<double> yse
                 dec->setName(dname);
 
                 // data
-                for (int i=0; i<xseries.size() && i<yseries.size(); i++)
+                if (decimator) dec->replace(add->pointsVector());
+                else for (int i=0; i<xseries.size() && i<yseries.size(); i++)
                     dec->append(xseries.at(i), yseries.at(i));
 
                 // if no line, but we still want labels then show
@@ -605,10 +680,15 @@ GenericPlot::addCurve(QString name, QVector<double> xseries, QVector<double> yse
             add->setPen(Qt::NoPen);
             add->setOpacity(double(opacity) / 100.0); // 0-100% to 0.0-1.0 values
 
-            // data
+            // data, thinned if there is lots of it
+            GenericDecimator *decimator = NULL;
+            if (GenericDecimator::wanted(xseries, yseries, true)) {
+                decimator = new GenericDecimator(xseries, yseries, true);
+                decimators.insert(add, decimator);
+            }
             GenericCalculator calc; // watching as we add
             for (int i=0; i<xseries.size() && i<yseries.size(); i++) {
-                add->append(xseries.at(i), yseries.at(i));
+                if (!decimator) add->append(xseries.at(i), yseries.at(i));
 
                 // tell axis about the data
                 xaxis->point(xseries.at(i), yseries.at(i));
@@ -625,6 +705,12 @@ GenericPlot::addCurve(QString name, QVector<double> xseries, QVector<double> yse
                 add->setPointLabelsFormat("@yPoint");
             }
 
+            // now we know the ranges we can thin to the plot area
+            if (decimator) {
+                QRectF visible(calc.x.min, calc.y.min, calc.x.max-calc.x.min, calc.y.max-calc.y.min);
+                add->replace(decimator->points(visible, decimationBudget(), decimationBudget(Qt::Vertical)));
+            }
+
             // set the quadtree up - now we know the ranges...
             Quadtree *tree = new Quadtree(QPointF(calc.x.min, calc.y.min), QPointF(calc.x.max, calc.y.max));
             for (int i=0; i<xseries.size() && i<yseries.size(); i++)
@@ -890,6 +976,14 @@ GenericPlot::finaliseChart()
                     series->attachAxis(add);
                 foreach(QAbstractSeries *series, axisinfo->decorations)
                     series->attachAxis(add);
+
+                // decimated curves follow zoom
+                if (decimators.count()) {
+                    if (add->type() == QAbstractAxis::AxisTypeDateTime)
+                        connect(add, SIGNAL(rangeChanged(QDateTime,QDateTime)), this, SLOT(redecimate()));
+                    else
+                        connect(add, SIGNAL(rangeChanged(qreal,qreal)), this, SLOT(redecimate()));
+                }
             }
         }
     }
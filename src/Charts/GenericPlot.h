@@ -55,6 +55,7 @@ class GenericPlot;
 class GenericLegend;
 class GenericSelectTool;
 class GenericAxisInfo;
+class GenericDecimator;
 
 // the chart
 class GenericPlot : public QWidget {
@@ -113,6 +114,9 @@ class GenericPlot : public QWidget {
         void barsetHover(bool status, int index, QBarSet *barset);
         void plotAreaChanged();
 
+        // decimated curves need refreshing after zoom/resize
+        void redecimate();
+
 
     protected:
 
@@ -139,6 +143,11 @@ class GenericPlot : public QWidget {
         // quadtrees
         QMap<QAbstractSeries*, Quadtree*> quadtrees;
 
+        // decimated curves keep their full data here
+        QMap<QAbstractSeries*, GenericDecimator*> decimators;
+        int decimationBudget(Qt::Orientation orientation=Qt::Horizontal);
+        double decimatedwidth;
+
 
         // annotation labels
         QList<QLabel *> labels;
@@ -17,6 +17,7 @@
  */
 
 #include "GenericSelectTool.h"
+#include "GenericDecimator.h"
 
 #include "Colors.h"
 #include "TabView.h"
@@ -1013,13 +1014,21 @@ GenericSelectTool::updateScene()
                     calc.xaxis = xaxis;
                     calc.yaxis = yaxis;
                     calc.series = line;
+                    GenericDecimator *decimator = host->decimators.value(x, NULL);
                     for(int i=0; i<line->count(); i++) {
                         QPointF point = line->at(i); // avoid deep copy
                         if (point.x() >= minx && point.x() <= maxx) {
                             if (!points.contains(point)) points << point; // avoid dupes
-                            calc.addPoint(point);
+                            if (!decimator) calc.addPoint(point);
                         }
                     }
+
+                    // stats are on all the data, not just what is plotted
+                    if (decimator) {
+                        const QVector<QPointF> &all = decimator->data();
+                        for(int i=0; i<all.count(); i++)
+                            if (all[i].x() >= minx && all[i].x() <= maxx) calc.addPoint(all[i]);
+                    }
                     calc.finalise();
                     stats.insert(line, calc);
 
@@ -1092,14 +1101,23 @@ GenericSelectTool::updateScene()
                     calc.xaxis = xaxis;
                     calc.yaxis = yaxis;
                     calc.series = scatter;
+                    GenericDecimator *decimator = host->decimators.value(x, NULL);
                     for(int i=0; i<scatter->count(); i++) {
                         QPointF point = scatter->at(i); // avoid deep copy
                         if (point.y() >= miny && point.y() <= maxy &&
                             point.x() >= minx && point.x() <= maxx) {
                             if (!points.contains(point)) points << point; // avoid dupes
-                            calc.addPoint(point);
+                            if (!decimator) calc.addPoint(point);
                         }
                     }
+
+                    // stats are on all the data, not just what is plotted
+                    if (decimator) {
+                        const QVector<QPointF> &all = decimator->data();
+                        for(int i=0; i<all.count(); i++)
+                            if (all[i].y() >= miny && all[i].y() <= maxy &&
+                                all[i].x() >= minx && all[i].x() <= maxx) calc.addPoint(all[i]);
+                    }
                     calc.finalise();
                     stats.insert(scatter, calc);
 
@@ -18,18 +18,21 @@
 
 #include <cmath>
 #include <float.h>
+#include <algorithm>
 #include "LTMOutliers.h"
 
 #include <QDebug>
 
 
-LTMOutliers::LTMOutliers(double *xdata, double *ydata, int count, int windowsize, bool absolute) : stdDeviation(0.0)
+LTMOutliers::LTMOutliers(double *xdata, double *ydata, int count, int windowsize, bool absolute) : stdDeviation(0.0), sorted(0)
 {
     double sum = 0;
     int points = 0;
     double allSum = 0.0;
     int pos=0;
 
+    rank.reserve(count);
+
     // initial samples from point 0 to windowsize
     for (; pos < windowsize && pos < count; ++pos) {
 
@@ -85,6 +88,18 @@ LTMOutliers::LTMOutliers(double *xdata, double *ydata, int count, int windowsize
     // calculate the average deviation across all points
     stdDeviation = allSum / (double)points;
 
-    // create a ranked list
-    qSort(rank);
+    // the ranked list is sorted on demand, most callers
+    // only look at the top few so we don't sort it all
+}
+
+void
+LTMOutliers::ranked(int i)
+{
+    if (i < sorted || i >= rank.count()) return;
+
+    // sort the next chunk, everything after the sorted part
+    // ranks lower so we only partially sort what is left
+    int upto = qMin(rank.count(), qMax(i+1, qMax(16, sorted*2)));
+    std::partial_sort(rank.begin()+sorted, rank.begin()+upto, rank.end());
+    sorted = upto;
 }
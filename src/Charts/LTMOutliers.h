@@ -31,8 +31,9 @@ class LTMOutliers
         int pos;
         double deviation;
 
-        bool operator< (xdev right) const {
-            return (deviation > right.deviation);  // sort ascending! (.gt not .lt)
+        bool operator< (const xdev &right) const {
+            // sort ascending! (.gt not .lt) and by position when tied
+            return (deviation > right.deviation || (deviation == right.deviation && pos < right.pos));
         }
     };
 
@@ -40,18 +41,23 @@ class LTMOutliers
         // Constructor using arrays of x values and y values
         LTMOutliers(double *x, double *y, int count, int windowsize, bool absolute=true);
 
-        // ranked values
-        int getIndexForRank(int i) { return rank[i].pos; }
-        double getXForRank(int i) { return rank[i].x; }
-        double getYForRank(int i) { return rank[i].y; }
-        double getDeviationForRank(int i) { return rank[i].deviation; }
+        // ranked values, only as many as are asked for get sorted
+        // so callers should stop as soon as they have what they need
+        int getIndexForRank(int i) { ranked(i); return rank[i].pos; }
+        double getXForRank(int i) { ranked(i); return rank[i].x; }
+        double getYForRank(int i) { ranked(i); return rank[i].y; }
+        double getDeviationForRank(int i) { ranked(i); return rank[i].deviation; }
+        int count() const { return rank.count(); }
 
         // std deviation
         double getStdDeviation() { return stdDeviation; }
 
     protected:
+        void ranked(int i);             // make sure ranks 0-i are sorted
+
         double stdDeviation;
         QVector<xdev> rank;             // ranked list of x sorted by deviation
+        int sorted;                     // how many are in rank order
 };
 
 #endif
@@ -56,6 +56,7 @@
 #include <qwt_symbol.h>
 
 #include <cmath> // for isinf() isnan()
+#include "Trace.h"
 
 //#include <QDebug>
 
@@ -223,8 +224,7 @@ LTMPlot::setAxisTitle(QwtAxisId axis, QString label)
 void
 LTMPlot::setData(LTMSettings *set)
 {
-    QTime timer;
-    timer.start();
+    GC_TRACE_SPAN("LTMPlot::setData");
 
     curveColors->isolated = false;
     isolation = false;
@@ -232,8 +232,6 @@ LTMPlot::setData(LTMSettings *set)
 
     bool haveBanister=false; // do we want to show the banister helper?
 
-    //qDebug()<<"Starting.."<<timer.elapsed();
-
     settings = set;
 
     // crop dates to at least within a year of the data available, but only if we have some data
@@ -346,8 +344,6 @@ LTMPlot::setData(LTMSettings *set)
         return;
     }
 
-    //qDebug()<<"Wiped previous.."<<timer.elapsed();
-
     // count the bars since we format them side by side and need
     // to now how to offset them from each other
     // unset stacking if not a bar chart too since we don't support
@@ -406,8 +402,6 @@ LTMPlot::setData(LTMSettings *set)
         }
     }
 
-    //qDebug()<<"Created curve data.."<<timer.elapsed();
-
     // setup the curves
     double width = appsettings->value(this, GC_LINEWIDTH, 0.5).toDouble();
     bool donestack = false;
@@ -576,8 +570,6 @@ LTMPlot::setData(LTMSettings *set)
 
     } // end of reverse for stacked plots
 
-    //qDebug()<<"First plotting iteration.."<<timer.elapsed();
-
     // do all curves excepts stacks in order
     // we skip stacked entries because they
     // are painted in reverse order in a
@@ -601,8 +593,6 @@ LTMPlot::setData(LTMSettings *set)
         else
             createTODCurveData(context, settings, metricDetail, xdata, ydata, count);
 
-        //qDebug()<<"Create curve data.."<<timer.elapsed();
-
         // Create a curve
         QwtPlotCurve *current = (metricDetail.type == METRIC_ESTIMATE || metricDetail.type == METRIC_BANISTER || metricDetail.type == METRIC_D_MEASURE)
                 ? new QwtPlotGappedCurve(metricDetail.uname, 1)
@@ -1283,8 +1273,6 @@ LTMPlot::setData(LTMSettings *set)
         current->setSamples(xdata.data(),ydata.data(), count + 1);
         current->setBaseline(metricDetail.baseline);
 
-        //qDebug()<<"Set Curve Data.."<<timer.elapsed();
-
         // update min/max Y values for the chosen axis
         if (current->maxYValue() > maxY[supportedAxes.indexOf(axisid)]) maxY[supportedAxes.indexOf(axisid)] = current->maxYValue();
         if (current->minYValue() < minY[supportedAxes.indexOf(axisid)]) minY[supportedAxes.indexOf(axisid)] = current->minYValue();
@@ -1293,8 +1281,6 @@ LTMPlot::setData(LTMSettings *set)
 
     }
 
-    //qDebug()<<"Second plotting iteration.."<<timer.elapsed();
-
 
     if (settings->groupBy != LTM_TOD) {
 
@@ -1375,8 +1361,6 @@ LTMPlot::setData(LTMSettings *set)
     if (settings->groupBy != LTM_TOD)
         refreshMarkers(settings, settings->start.date(), settings->end.date(), settings->groupBy, GColor(CPLOTMARKER));
 
-    //qDebug()<<"Final tidy.."<<timer.elapsed();
-
     // update colours etc for plot chrome will also save state
     configChanged(CONFIG_APPEARANCE);
 
@@ -1386,22 +1370,17 @@ LTMPlot::setData(LTMSettings *set)
     // plot
     replot();
 
-    //qDebug()<<"Replot and done.."<<timer.elapsed();
-
 }
 
 void
 LTMPlot::setCompareData(LTMSettings *set)
 {
-    QTime timer;
-    timer.start();
+    GC_TRACE_SPAN("LTMPlot::setCompareData");
 
     MAXX=0.0; // maximum value for x, always from 0-n
     settings = set;
     int user=0;
 
-    //qDebug()<<"Starting.."<<timer.elapsed();
-
     // wipe existing curves/axes details
     QHashIterator<QString, QwtPlotCurve*> c(curves);
     while (c.hasNext()) {
@@ -1535,8 +1514,6 @@ LTMPlot::setCompareData(LTMSettings *set)
         setAxisVisible(QwtAxis::xTop, false);
 
 
-        //qDebug()<<"Wiped previous.."<<timer.elapsed();
-
         // count the bars since we format them side by side and need
         // to now how to offset them from each other
         // unset stacking if not a bar chart too since we don't support
@@ -1584,8 +1561,6 @@ LTMPlot::setCompareData(LTMSettings *set)
             }
         }
 
-        //qDebug()<<"Created curve data.."<<timer.elapsed();
-
         // setup the curves
         double width = appsettings->value(this, GC_LINEWIDTH, 0.5).toDouble();
 
@@ -1756,8 +1731,6 @@ LTMPlot::setCompareData(LTMSettings *set)
 
         } // end of reverse for stacked plots
 
-        //qDebug()<<"First plotting iteration.."<<timer.elapsed();
-
         // do all curves excepts stacks in order
         // we skip stacked entries because they
         // are painted in reverse order in a
@@ -1781,8 +1754,6 @@ LTMPlot::setCompareData(LTMSettings *set)
             // lets catch the x-scale
             if (count > MAXX) MAXX=count;
 
-            //qDebug()<<"Create curve data.."<<timer.elapsed();
-
             // Create a curve
             QwtPlotCurve *current = new QwtPlotCurve(cd.name);
             if (metricDetail.type == METRIC_BEST)
@@ -2397,8 +2368,6 @@ LTMPlot::setCompareData(LTMSettings *set)
             current->setSamples(xdata.data(),ydata.data(), count + 1);
             current->setBaseline(metricDetail.baseline);
 
-            //qDebug()<<"Set Curve Data.."<<timer.elapsed();
-
             // update min/max Y values for the chosen axis
             if (current->maxYValue() > maxY[supportedAxes.indexOf(axisid)]) maxY[supportedAxes.indexOf(axisid)] = current->maxYValue();
             if (current->minYValue() < minY[supportedAxes.indexOf(axisid)]) minY[supportedAxes.indexOf(axisid)] = current->minYValue();
@@ -2413,8 +2382,6 @@ LTMPlot::setCompareData(LTMSettings *set)
 
     }
 
-    //qDebug()<<"Second plotting iteration.."<<timer.elapsed();
-
     // axes
 
     if (settings->groupBy != LTM_TOD) {
@@ -2501,8 +2468,6 @@ LTMPlot::setCompareData(LTMSettings *set)
     // plot
     replot();
 
-    //qDebug()<<"Replot and done.."<<timer.elapsed();
-
 }
 
 int
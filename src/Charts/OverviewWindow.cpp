@@ -303,8 +303,16 @@ OverviewWindow::rideSelected()
 //QTime timer;
 //timer.start();
 
-    // ride item changed
-    foreach(Card *card, cards) card->setData(myRideItem);
+    // rides preceding this one used by the sparklines, fetched
+    // once here rather than by every card
+    sparkWindow.clear();
+    if (myRideItem) sparkWindow = context->athlete->rideCache->getWindow(myRideItem, SPARKDAYS);
+
+    // ride item changed, cards off screen are refreshed as they
+    // are scrolled into view
+    foreach(Card *card, cards) card->stale = true;
+    current = myRideItem;
+    refreshVisibleCards();
 
 // profiling the code
 //qDebug()<<"took:"<<timer.elapsed();
@@ -313,10 +321,27 @@ OverviewWindow::rideSelected()
     updateView();
 
     // ok, remember we did this one
-    current = myRideItem;
     stale=false;
 }
 
+void
+OverviewWindow::refreshVisibleCards()
+{
+    if (current == NULL) return;
+
+    QRectF visible = view->sceneRect();
+    foreach(Card *card, cards) {
+
+        // not placed yet, so can't tell if we can be seen
+        bool placed = card->geometry().isValid() && visible.isValid();
+
+        if (card->stale && (!placed || card->geometry().intersects(visible))) {
+            card->setData(current);
+            card->stale = false;
+        }
+    }
+}
+
 // empty card
 void
 Card::setType(CardType type)
@@ -611,21 +636,29 @@ Card::setData(RideItem *item)
         }
         points << QPointF(SPARKDAYS, v);
 
-        // set the chart values with the last 10 rides
-        int index = parent->context->athlete->rideCache->rides().indexOf(item);
+        // set the chart values with the rides in the last SPARKDAYS, the
+        // window is fetched once per ride selection by the overview
+        const QVector<RideItem*> &window = parent->sparkWindow;
+
+        // metric values for the whole window in one pass
+        const RideMetric *m = NULL;
+        QVector<double> values;
+        if (type == METRIC) {
+            m = RideMetricFactory::instance().rideMetric(settings.symbol);
+            if (m) values = parent->context->athlete->rideCache->getMetricWindow(window, m->index(), parent->context->athlete->useMetricUnits);
+        }
+
+        // displayed to the metric precision, unless a duration
+        double scale = (m && units != tr("seconds")) ? pow(10, m->precision()) : 0;
 
-        int offset = 1;
         double min = v;
         double max = v;
         double sum=0, count=0, avg = 0;
-        while(index-offset >=0) { // ultimately go no further back than first ever ride
+        for(int i=window.count()-1; i>=0; i--) { // most recent first
 
             // get value from items before me
-            RideItem *prior = parent->context->athlete->rideCache->rides().at(index-offset);
-
-            // are we still in range ?
+            RideItem *prior = window[i];
             const qint64 old = prior->dateTime.daysTo(item->dateTime);
-            if (old > SPARKDAYS) break;
 
             // only activities with matching sport flags
             if (prior->isRun == item->isRun && prior->isSwim == item->isSwim) {
@@ -633,9 +666,8 @@ Card::setData(RideItem *item)
                 double v;
 
                 if (type == METRIC) {
-                    v = (units == tr("seconds")) ?
-                    prior->getForSymbol(settings.symbol, parent->context->athlete->useMetricUnits)
-                    : prior->getStringForSymbol(settings.symbol, parent->context->athlete->useMetricUnits).toDouble();
+                    v = values.isEmpty() ? 0 : values[i];
+                    if (scale) v = round(v * scale) / scale;
                 } else {
 
                     if (fieldtype == FIELD_DOUBLE)  v = prior->getText(settings.symbol, "").toDouble();
@@ -652,7 +684,6 @@ Card::setData(RideItem *item)
                     if (v > max) max = v;
                 }
             }
-            offset++;
         }
 
         if (count) avg = sum / count;
@@ -2373,6 +2404,9 @@ OverviewWindow::setViewRect(QRectF rect)
     view->setSceneRect(scaledRect);
     view->fitInView(scaledRect, Qt::KeepAspectRatio);
 
+    // cards scrolled into view may need their data
+    refreshVisibleCards();
+
     // if we're dragging, as the view changes it can be really jarring
     // as the dragged item is not under the mouse then snaps back
     // this might need to be cleaned up as a little too much of spooky
@@ -80,7 +80,7 @@ class Card : public QGraphicsWidget
 
         Card(int deep, QString name) : QGraphicsWidget(NULL), name(name),
                                                 column(0), order(0), deep(deep), onscene(false),
-                                                placing(false), drag(false), invisible(false), fieldtype(-1) {
+                                                placing(false), drag(false), invisible(false), stale(false), fieldtype(-1) {
 
             setAutoFillBackground(false);
             setFlags(flags() | QGraphicsItem::ItemClipsToShape); // don't paint outside the card
@@ -175,6 +175,7 @@ class Card : public QGraphicsWidget
         int column, order, deep;
         bool onscene, placing, drag;
         bool invisible;
+        bool stale; // needs setData when next visible
         int fieldtype;
 
         void paint(QPainter *painter, const QStyleOptionGraphicsItem *, QWidget *);
@@ -407,6 +408,9 @@ class OverviewWindow : public GcChartWindow
         // to get paint device
         QGraphicsView *device() { return view; }
 
+        // rides in the SPARKDAYS before the current ride, shared by the cards
+        QVector<RideItem*> sparkWindow;
+
     public slots:
 
         // ride item changed
@@ -443,6 +447,9 @@ class OverviewWindow : public GcChartWindow
         // set scale, zoom etc appropriately
         void updateView();
 
+        // set data on stale cards that are now on screen
+        void refreshVisibleCards();
+
         // create a route card
         Card *newCard(QString name, int column, int order, int deep, Card::CardType type) {
                                                          Card *add = new Card(deep, name);
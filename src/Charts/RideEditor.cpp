@@ -608,8 +608,8 @@ AnomalyDialog::check()
         // run through the ranked list
         for (int i=0; i<secs.count(); i++) {
 
-            // is this over variance threshold?
-            if (outliers.getDeviationForRank(i) < variance) continue;
+            // is this over variance threshold? ranked so none of the rest will be
+            if (outliers.getDeviationForRank(i) < variance) break;
 
             // ok, so its highly variant but is it over
             // the max value we are willing to accept?
@@ -1747,6 +1747,24 @@ RideEditor::endCommand(bool undo, RideCommand *cmd)
 
             break;
         }
+        case RideCommand::SetPointValues:
+        {
+            SetPointValuesCommand *spv = (SetPointValuesCommand*)cmd;
+
+            // clear current
+            if (!inLUW) table->selectionModel()->clearSelection();
+
+            // move cursor to the first point updated and
+            // highlight the range of them in that column
+            int column = model->columnFor(spv->series);
+            QModelIndex topleft = model->index(spv->row, column);
+            QItemSelection highlight(topleft, model->index(spv->row+spv->count-1, column));
+
+            table->selectionModel()->setCurrentIndex(topleft, QItemSelectionModel::Select);
+            table->selectionModel()->select(highlight, inLUW ? QItemSelectionModel::Select :
+                                                        QItemSelectionModel::SelectCurrent);
+            break;
+        }
         case RideCommand::InsertPoint:
         {
             InsertPointCommand *ip = (InsertPointCommand *)cmd;
@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "RideMapTrack.h"
+#include "RideFile.h"
+
+#include <QByteArray>
+#include <QPair>
+#include <QtEndian>
+#include <algorithm>
+#include <cmath>
+
+// metres per pixel at zoom 0 on the equator for 256 pixel tiles
+static const double METRES_PER_PIXEL = 156543.03392;
+static const double METRES_PER_DEGREE = 111319.49;
+
+void
+RideMapTrack::clear()
+{
+    lat.clear();
+    lon.clear();
+    secs.clear();
+    zoom.clear();
+}
+
+void
+RideMapTrack::setRide(const RideFile *ride)
+{
+    clear();
+    if (!ride) return;
+
+    foreach(const RideFilePoint *p, ride->dataPoints()) {
+        if (p->lat || p->lon) {
+            lat << p->lat;
+            lon << p->lon;
+            secs << p->secs;
+        }
+    }
+    simplify();
+}
+
+void
+RideMapTrack::simplify()
+{
+    int n = secs.count();
+    zoom.fill(maxZoom, n);
+    if (n < 3) {
+        zoom.fill(0, n);
+        return;
+    }
+
+    // flat projection in metres is fine for the distances involved
+    double mid = lat[n/2];
+    double xscale = METRES_PER_DEGREE * cos(mid * M_PI / 180.0);
+    double yscale = METRES_PER_DEGREE;
+
+    // how far each point is off the line when it is chosen, never more
+    // than the point that split the section it is in, so the points at
+    // each level are a subset of the next
+    QVector<double> error(n, 0);
+    error[0] = error[n-1] = HUGE_VAL;
+
+    QVector<QPair<int,int> > stack;
+    stack << QPair<int,int>(0, n-1);
+    while (!stack.isEmpty()) {
+        QPair<int,int> section = stack.takeLast();
+        int from = section.first, to = section.second;
+        if (to - from < 2) continue;
+
+        double ax = lon[from] * xscale, ay = lat[from] * yscale;
+        double dx = lon[to] * xscale - ax, dy = lat[to] * yscale - ay;
+        double length = dx*dx + dy*dy;
+
+        int furthest = from + 1;
+        double distance = -1;
+        for (int i=from+1; i<to; i++) {
+            double px = lon[i] * xscale - ax, py = lat[i] * yscale - ay;
+            double d;
+            if (length == 0) d = px*px + py*py;
+            else {
+                double t = qBound(0.0, (px*dx + py*dy) / length, 1.0);
+                double ex = px - t*dx, ey = py - t*dy;
+                d = ex*ex + ey*ey;
+            }
+            if (d > distance) {
+                distance = d;
+                furthest = i;
+            }
+        }
+
+        // all on the line (or stationary), split in the middle
+        // so a long stop doesn't peel off one point at a time
+        if (distance <= 0) furthest = (from + to) / 2;
+
+        double parent = qMin(error[from], error[to]);
+        error[furthest] = qMin(sqrt(qMax(0.0, distance)), parent);
+
+        stack << QPair<int,int>(from, furthest);
+        stack << QPair<int,int>(furthest, to);
+    }
+
+    // lowest zoom where the error is at least half a pixel
+    double zero = METRES_PER_PIXEL * cos(mid * M_PI / 180.0) / 2.0;
+    for (int i=0; i<n; i++) {
+        if (error[i] == HUGE_VAL) zoom[i] = 0;
+        else if (error[i] <= 0) zoom[i] = maxZoom;
+        else zoom[i] = qBound(0, int(ceil(log2(zero / error[i]))), maxZoom);
+    }
+}
+
+bool
+RideMapTrack::range(double from, double to, int &first, int &last) const
+{
+    first = std::lower_bound(secs.begin(), secs.end(), from) - secs.begin();
+    last = (std::upper_bound(secs.begin(), secs.end(), to) - secs.begin()) - 1;
+    return first <= last;
+}
+
+QString
+RideMapTrack::encoded() const
+{
+    QByteArray bytes(secs.count() * 3 * sizeof(qint32), 0);
+    uchar *p = reinterpret_cast<uchar*>(bytes.data());
+    for (int i=0; i<secs.count(); i++) {
+        qToLittleEndian<qint32>(qint32(round(lat[i] * 10000000.0)), p); p += 4;
+        qToLittleEndian<qint32>(qint32(round(lon[i] * 10000000.0)), p); p += 4;
+        qToLittleEndian<qint32>(zoom[i], p); p += 4;
+    }
+    return QString::fromLatin1(bytes.toBase64());
+}
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _GC_RideMapTrack_h
+#define _GC_RideMapTrack_h 1
+#include "GoldenCheetah.h"
+
+#include <QString>
+#include <QVector>
+
+class RideFile;
+
+// The GPS track of a ride for the map, with the zoom level each point
+// first becomes visible at. The levels come from a single Douglas-Peucker
+// pass; each point is ranked by how far it is off the line through the
+// points either side of it when it is chosen, and is only drawn when that
+// is at least half a pixel at the zoom level, so the map can redraw the
+// route and intervals at any zoom without asking for the data again.
+//
+class RideMapTrack
+{
+    public:
+        static const int maxZoom = 18; // all points at this and above
+
+        RideMapTrack() {}
+
+        void setRide(const RideFile *ride);
+        void clear();
+
+        bool isEmpty() const { return secs.isEmpty(); }
+        int count() const { return secs.count(); }
+
+        // first and last point recorded between from and to secs inclusive
+        // returns false if there aren't any
+        bool range(double from, double to, int &first, int &last) const;
+
+        // base64 of lat, lon (in 1e-7 degrees) and zoom for each point
+        // as little endian 32 bit integers, decoded by the map page
+        QString encoded() const;
+
+    private:
+        void simplify();
+
+        QVector<double> lat, lon, secs;
+        QVector<int> zoom;
+};
+#endif
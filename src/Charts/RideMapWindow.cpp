@@ -27,6 +27,7 @@
 #include "IntervalItem.h"
 #include "IntervalTreeView.h"
 #include "SmallPlot.h"
+#include "RideMapTrack.h"
 #include "Context.h"
 #include "Athlete.h"
 #include "Zones.h"
@@ -377,6 +378,9 @@ void RideMapWindow::createHtml()
     minLat = minLon = 1000;
     maxLat = maxLon = -1000; // larger than 360
 
+    // the track we draw, simplified for each zoom level
+    track.setRide(myRideItem->ride());
+
     // get bounding co-ordinates for ride
     foreach(RideFilePoint *rfp, myRideItem->ride()->dataPoints()) {
         if (rfp->lat || rfp->lon) {
@@ -455,29 +459,76 @@ void RideMapWindow::createHtml()
     "var markerList;\n"  // array of markers
     "var polyList;\n"  // array of polylines
     "var tmpIntervalHighlighter;\n"  // temp interval
+    "var track;\n"  // lat, lon and zoom level for each point
+    "var trackLines = [];\n"  // polylines drawn from the track
+
+    // the track arrives base64 encoded, lat, lon (1e-7 degrees) and the
+    // zoom level the point is drawn from as 32 bit integers
+    "function setTrack(encoded) {\n"
+    "    var raw = atob(encoded);\n"
+    "    var bytes = new Uint8Array(raw.length);\n"
+    "    for (var i=0; i<raw.length; i++) bytes[i] = raw.charCodeAt(i);\n"
+    "    track = new Int32Array(bytes.buffer);\n"
+    "}\n"
+
+    // the points from first to last for the zoom level, ends are always drawn
+    "function trackPath(first, last) {\n"
+    "    var zoom = map.getZoom();\n"
+    "    if (zoom === undefined) zoom = %1;\n"
+    "    var path = [];\n"
+    "    for (var i=first; i<=last; i++) {\n"
+    "        if (i == first || i == last || track[i*3+2] <= zoom) path.push(trackLatLng(i));\n"
+    "    }\n"
+    "    return path;\n"
+    "}\n"
+
+    // polylines drawn from the track are redrawn when the zoom changes
+    "function setTrackLine(line, first, last) {\n"
+    "    removeTrackLine(line);\n"
+    "    trackLines.push({ line: line, first: first, last: last });\n"
+    "    setTrackPath(line, trackPath(first, last));\n"
+    "}\n"
+    "function removeTrackLine(line) {\n"
+    "    for (var i=0; i<trackLines.length; i++) {\n"
+    "        if (trackLines[i].line === line) { trackLines.splice(i, 1); return; }\n"
+    "    }\n"
+    "}\n"
+    "function redrawTrack() {\n"
+    "    for (var i=0; i<trackLines.length; i++)\n"
+    "        setTrackPath(trackLines[i].line, trackPath(trackLines[i].first, trackLines[i].last));\n"
+    "}\n"
 
     // Draw the entire route, we use a local webbridge
     // to supply the data to a) reduce bandwidth and
     // b) allow local manipulation. This makes the UI
-    // considerably more 'snappy'
+    // considerably more 'snappy'. The whole track is fetched
+    // once, intervals and shading are drawn from ranges of it
     "function drawRoute() {\n"
 #ifdef NOWEBKIT
-    // load the GPS co-ordinates
-    "   webBridge.getLatLons(0, drawRouteForLatLons);\n"
+    "   webBridge.getTrack(function(encoded) { setTrack(encoded); drawTrack(); });\n"
 #else
-    // load the GPS co-ordinates
-    "    var latlons = webBridge.getLatLons(0);\n" // interval "0" is the entire route
-    "   drawRouteForLatLons(latlons);\n"
+    "   setTrack(webBridge.getTrack());\n"
+    "   drawTrack();\n"
 #endif
     "}\n"
-    "\n");
+    "function drawTrack() {\n"
+    "   drawRouteForRange([0, track.length/3 - 1]);\n"
+    "   drawIntervals();\n"
+    // catch signals to redraw intervals
+    "   webBridge.drawIntervals.connect(drawIntervals);\n"
+    // we're done now let the C++ side draw its overlays
+    "   webBridge.drawOverlays();\n"
+    "}\n"
+    "\n").arg(RideMapTrack::maxZoom);
 
     if (mapCombo->currentIndex() == OSM) {
         // when we have style options we draw the route in cplotmarker colors
         // and no opacity since its just a stylised map used for dashboards or
         // small thumbnails.
-        currentPage += QString("function drawRouteForLatLons(latlons) {\n"
+        currentPage += QString("function trackLatLng(i) { return new L.LatLng(track[i*3] / 10000000, track[i*3+1] / 10000000); }\n"
+            "function setTrackPath(line, path) { line.setLatLngs(path); }\n"
 
+            "function drawRouteForRange(range) {\n"
 
             // route will be drawn with these options
             "    var routeOptionsYellow = {\n"
@@ -489,14 +540,8 @@ void RideMapWindow::createHtml()
             "    };\n"
 
             // lastly, populate the route path
-            "    var path = [];\n"
-            "    var j=0;\n"
-            "    while (j < latlons.length) { \n"
-            "        path.push(new L.LatLng(latlons[j], latlons[j+1]));\n"
-            "        j += 2;\n"
-            "    };\n"
-
-            "    var routeYellow = new L.Polyline(path, routeOptionsYellow).addTo(map);\n"
+            "    var routeYellow = new L.Polyline([], routeOptionsYellow).addTo(map);\n"
+            "    setTrackLine(routeYellow, range[0], range[1]);\n"
 
             // Listen mouse events
             "routeYellow.on('mousedown', function(event) { map.dragging.disable();L.DomEvent.stopPropagation(event);webBridge.clickPath(event.latlng.lat, event.latlng.lng); });\n" // map.setOptions({draggable: false, zoomControl: false, scrollwheel: false, disableDoubleClickZoom: true});
@@ -512,7 +557,10 @@ void RideMapWindow::createHtml()
        // when we have style options we draw the route in cplotmarker colors
        // and no opacity since its just a stylised map used for dashboards or
        // small thumbnails.
-       currentPage += QString("function drawRouteForLatLons(latlons) {\n"
+       currentPage += QString("function trackLatLng(i) { return new google.maps.LatLng(track[i*3] / 10000000, track[i*3+1] / 10000000); }\n"
+           "function setTrackPath(line, path) { line.setPath(path); }\n"
+
+           "function drawRouteForRange(range) {\n"
 
            // route will be drawn with these options
            "    var routeOptionsYellow = {\n"
@@ -527,12 +575,7 @@ void RideMapWindow::createHtml()
            "    routeYellow.setMap(map);\n"
 
            // lastly, populate the route path
-           "    var path = routeYellow.getPath();\n"
-           "    var j=0;\n"
-           "    while (j < latlons.length) { \n"
-           "        path.push(new google.maps.LatLng(latlons[j], latlons[j+1]));\n"
-           "        j += 2;\n"
-           "    }\n"
+           "    setTrackLine(routeYellow, range[0], range[1]);\n"
 
            // Listen mouse events
            "    google.maps.event.addListener(routeYellow, 'mousedown', function(event) { map.setOptions({draggable: false, zoomControl: false, scrollwheel: false, disableDoubleClickZoom: true}); webBridge.clickPath(event.latLng.lat(), event.latLng.lng()); });\n"
@@ -556,7 +599,8 @@ void RideMapWindow::createHtml()
     // remove previous intervals highlighted
     "   j= intervalList.length;\n"
     "    while (j) {\n"
-    "       var highlighted = intervalList.pop();\n");
+    "       var highlighted = intervalList.pop();\n"
+    "       removeTrackLine(highlighted);\n");
 
     // remove highlighted
     if (mapCombo->currentIndex() == OSM) {
@@ -573,16 +617,17 @@ void RideMapWindow::createHtml()
 
     "   while (intervals > 0) {\n"
 #ifdef NOWEBKIT
-    "       webBridge.getLatLons(intervals, drawInterval);\n"
+    "       webBridge.getRange(intervals, drawInterval);\n"
 #else
-    "       drawInterval(webBridge.getLatLons(intervals));\n"
+    "       drawInterval(webBridge.getRange(intervals));\n"
 #endif
     "       intervals--;\n"
     "   }\n"
     "}\n");
 
     if (mapCombo->currentIndex() == OSM) {
-        currentPage += QString("function drawInterval(latlons) { \n"
+        currentPage += QString("function drawInterval(range) { \n"
+                               "   if (range.length < 2) return;\n"
                                // intervals will be drawn with these options
                                "   var polyOptions = {\n"
                                "       stroke : true,\n"
@@ -591,15 +636,44 @@ void RideMapWindow::createHtml()
                                "       weight: 10,\n"
                                "       zIndex: -1\n"  // put at the bottom
                                "   }\n"
-                               "   var path = [];\n"
-                               "   var j=0;\n"
-                               "   while (j<latlons.length) {\n"
-                               "       path.push([latlons[j], latlons[j+1]]);\n"
-                               "       j += 2;\n"
+                               "   var intervalHighlighter = L.polyline([], polyOptions).addTo(map);\n"
+                               "   intervalList.push(intervalHighlighter);\n"
+                               "   setTrackLine(intervalHighlighter, range[0], range[1]);\n"
+                               "}\n"
+
+                               // the route shaded by power, first, last and color for each segment
+                               "function drawSegments(segments, opacity) { \n"
+                               "   for (var s=0; s+2<segments.length; s+=3) {\n"
+                               "       var polyOptions = {\n"
+                               "           stroke: true,\n"
+                               "           color: segments[s+2],\n"
+                               "           weight: 3,\n"
+                               "           opacity: opacity,\n" // for out and backs, we need both
+                               "           zIndex: 0\n"
+                               "       };\n"
+                               "       var polyline = new L.Polyline([], polyOptions).addTo(map);\n"
+                               "       polyline.on('mousedown', function(event) { map.dragging.disable();L.DomEvent.stopPropagation(event);webBridge.clickPath(event.latlng.lat, event.latlng.lng); });\n"
+                               "       polyline.on('mouseup',   function(event) { map.dragging.enable();L.DomEvent.stopPropagation(event);webBridge.mouseup(); });\n"
+                               "       polyline.on('mouseover', function(event) { webBridge.hoverPath(event.latlng.lat, event.latlng.lng); });\n"
+                               "       setTrackLine(polyline, segments[s], segments[s+1]);\n"
                                "   }\n"
+                               "}\n"
 
-                               "   var intervalHighlighter = L.polyline(path, polyOptions).addTo(map);\n"
-                               "   intervalList.push(intervalHighlighter);\n"
+                               // the selection being dragged out on the route
+                               "function drawTempInterval(first, last) { \n"
+                               "   var polyOptions = {\n"
+                               "       stroke: true,\n"
+                               "       color: '#00FFFF',\n"
+                               "       opacity: 0.6,\n"
+                               "       weight: 10,\n"
+                               "       zIndex: -1\n"  // put at the bottom
+                               "   };\n"
+                               "   if (!tmpIntervalHighlighter) {\n"
+                               "      tmpIntervalHighlighter = new L.Polyline([], polyOptions);\n"
+                               "      tmpIntervalHighlighter.addTo(map);\n"
+                               "      tmpIntervalHighlighter.on('mouseup',   function(event) { map.dragging.enable();L.DomEvent.stopPropagation(event); webBridge.mouseup(); });\n"
+                               "   }\n"
+                               "   setTrackLine(tmpIntervalHighlighter, first, last);\n"
                                "}\n"
 
                                // initialise function called when map loaded
@@ -645,13 +719,11 @@ void RideMapWindow::createHtml()
                                // draw the main route data, getting the geo
                                // data from the webbridge - reduces data sent/received
                                // to the map server and makes the UI pretty snappy
+                               // then the intervals and overlays once we have it
                                "    drawRoute();\n"
-                               "    drawIntervals();\n"
-                               // catch signals to redraw intervals
-                               "    webBridge.drawIntervals.connect(drawIntervals);\n"
 
-                               // we're done now let the C++ side draw its overlays
-                               "    webBridge.drawOverlays();\n"
+                               // more or less detail as we zoom
+                               "    map.on('zoomend', redrawTrack);\n"
 
                                // Liste mouse events
                                "    map.on('mouseup', function(event) { map.dragging.enable();L.DomEvent.stopPropagation(event); webBridge.mouseup(); });\n"
@@ -660,7 +732,8 @@ void RideMapWindow::createHtml()
                                "}\n"
                                "</script>\n");
     } else if (mapCombo->currentIndex() == GOOGLE) {
-        currentPage += QString("function drawInterval(latlons) { \n"
+        currentPage += QString("function drawInterval(range) { \n"
+            "   if (range.length < 2) return;\n"
             // intervals will be drawn with these options
             "   var polyOptions = {\n"
             "       strokeColor: '#0000FF',\n"
@@ -671,14 +744,43 @@ void RideMapWindow::createHtml()
             "   var intervalHighlighter = new google.maps.Polyline(polyOptions);\n"
             "   intervalHighlighter.setMap(map);\n"
             "   intervalList.push(intervalHighlighter);\n"
-            "   var path = intervalHighlighter.getPath();\n"
-            "   var j=0;\n"
-            "   while (j<latlons.length) {\n"
-            "       path.push(new google.maps.LatLng(latlons[j], latlons[j+1]));\n"
-            "       j += 2;\n"
+            "   setTrackLine(intervalHighlighter, range[0], range[1]);\n"
+            "}\n"
+
+            // the route shaded by power, first, last and color for each segment
+            "function drawSegments(segments, opacity) { \n"
+            "   for (var s=0; s+2<segments.length; s+=3) {\n"
+            "       var polyOptions = {\n"
+            "           strokeColor: segments[s+2],\n"
+            "           strokeWeight: 3,\n"
+            "           strokeOpacity: opacity,\n" // for out and backs, we need both
+            "           zIndex: 0\n"
+            "       };\n"
+            "       var polyline = new google.maps.Polyline(polyOptions);\n"
+            "       polyline.setMap(map);\n"
+            "       google.maps.event.addListener(polyline, 'mousedown', function(event) { map.setOptions({draggable: false, zoomControl: false, scrollwheel: false, disableDoubleClickZoom: true}); webBridge.clickPath(event.latLng.lat(), event.latLng.lng()); });\n"
+            "       google.maps.event.addListener(polyline, 'mouseup',   function(event) { map.setOptions({draggable: true, zoomControl: true, scrollwheel: true, disableDoubleClickZoom: false}); webBridge.mouseup(); });\n"
+            "       google.maps.event.addListener(polyline, 'mouseover', function(event) { webBridge.hoverPath(event.latLng.lat(), event.latLng.lng()); });\n"
+            "       setTrackLine(polyline, segments[s], segments[s+1]);\n"
             "   }\n"
             "}\n"
 
+            // the selection being dragged out on the route
+            "function drawTempInterval(first, last) { \n"
+            "   var polyOptions = {\n"
+            "       strokeColor: '#00FFFF',\n"
+            "       strokeOpacity: 0.6,\n"
+            "       strokeWeight: 10,\n"
+            "       zIndex: -1\n"  // put at the bottom
+            "   }\n"
+            "   if (!tmpIntervalHighlighter) {\n"
+            "      tmpIntervalHighlighter = new google.maps.Polyline(polyOptions);\n"
+            "      tmpIntervalHighlighter.setMap(map);\n"
+            "      google.maps.event.addListener(tmpIntervalHighlighter, 'mouseup',   function(event) { map.setOptions({draggable: true, zoomControl: true, scrollwheel: true, disableDoubleClickZoom: false}); webBridge.mouseup(); });\n"
+            "   }\n"
+            "   setTrackLine(tmpIntervalHighlighter, first, last);\n"
+            "}\n"
+
             // initialise function called when map loaded
             "function initialize() {\n");
 
@@ -749,13 +851,11 @@ void RideMapWindow::createHtml()
             // draw the main route data, getting the geo
             // data from the webbridge - reduces data sent/received
             // to the map server and makes the UI pretty snappy
+            // then the intervals and overlays once we have it
             "    drawRoute();\n"
-            "    drawIntervals();\n"
-            // catch signals to redraw intervals
-            "    webBridge.drawIntervals.connect(drawIntervals);\n"
 
-            // we're done now let the C++ side draw its overlays
-            "    webBridge.drawOverlays();\n"
+            // more or less detail as we zoom
+            "    google.maps.event.addListener(map, 'zoom_changed', redrawTrack);\n"
 
             // Liste mouse events
             "    google.maps.event.addListener(map, 'mouseup', function(event) { map.setOptions({draggable: true, zoomControl: true, scrollwheel: true, disableDoubleClickZoom: false}); webBridge.mouseup(); });\n"
@@ -789,35 +889,15 @@ RideMapWindow::drawShadedRoute()
     int count=0;  // how many samples ?
     int rwatts=0; // running total of watts
     double prevtime=0; // time for previous point
+    double start=0; // time segment started
 
-    QString code;
+    // first and last point in the track and color for each
+    // segment, drawn from the track the page already has
+    QStringList segments;
 
     foreach(RideFilePoint *rfp, myRideItem->ride()->dataPoints()) {
-        if (mapCombo->currentIndex() == OSM) {
-            // Get GPS coordinates.
-            if (count == 0) {
-                // Start of segment.
-                code = QString("{\n"
-                               "var latLons = [");
-            }
 
-            if (rfp->lat || rfp->lon)
-                code += QString("[%1, %2], ").arg(rfp->lat,0,'g',GPS_COORD_TO_STRING).arg(rfp->lon,0,'g',GPS_COORD_TO_STRING);
-        } else if (mapCombo->currentIndex() == GOOGLE) {
-            if (count == 0) {
-                code = QString("{\nvar polyline = new google.maps.Polyline();\n"
-                       "   polyline.setMap(map);\n"
-                       "   path = polyline.getPath();\n");
-
-                // Listen mouse events
-                code += QString("google.maps.event.addListener(polyline, 'mousedown', function(event) { map.setOptions({draggable: false, zoomControl: false, scrollwheel: false, disableDoubleClickZoom: true}); webBridge.clickPath(event.latLng.lat(), event.latLng.lng()); });\n"
-                                "google.maps.event.addListener(polyline, 'mouseup',   function(event) { map.setOptions({draggable: true, zoomControl: true, scrollwheel: true, disableDoubleClickZoom: false}); webBridge.mouseup(); });\n"
-                                "google.maps.event.addListener(polyline, 'mouseover', function(event) { webBridge.hoverPath(event.latLng.lat(), event.latLng.lng()); });\n");
-            } else {
-                if (rfp->lat || rfp->lon)
-                    code += QString("path.push(new google.maps.LatLng(%1,%2));\n").arg(rfp->lat,0,'g',GPS_COORD_TO_STRING).arg(rfp->lon,0,'g',GPS_COORD_TO_STRING);
-            }
-        }
+        if (count == 0) start = rfp->secs;
 
         // running total of time
         rtime += rfp->secs - prevtime;
@@ -827,56 +907,28 @@ RideMapWindow::drawShadedRoute()
 
         // end of segment
         if (rtime >= intervalTime) {
-            if (mapCombo->currentIndex() == OSM) {
-                // Finalize variable "latLons" for the segment.
-                if (code.endsWith(", "))
-                    code.resize(code.length() - 2);
-                code += QString("];\n");
-            }
 
             int avgWatts = rwatts / count;
             QColor color = GetColor(avgWatts);
-            // thats this segment done, so finish off and
-            // add tooltip junk
             count = rwatts = rtime = 0;
 
-            if (mapCombo->currentIndex() == OSM) {
-                // Create and color a polyline for the segment.
-                code += QString("var polyOptions = {\n"
-                                "    stroke: true,\n"
-                                "    color: '%1',\n"
-                                "    weight: 3,\n"
-                                "    opacity: %2,\n" // for out and backs, we need both
-                                "    zIndex: 0\n"
-                                "};\n"
-                                "var polyline = new L.Polyline(latLons, polyOptions).addTo(map);\n"
-                                "polyline.on('mousedown', function(event) { map.dragging.disable();L.DomEvent.stopPropagation(event);webBridge.clickPath(event.latlng.lat, event.latlng.lng); });\n" // map.setOptions({draggable: false, zoomControl: false, scrollwheel: false, disableDoubleClickZoom: true});
-                                "polyline.on('mouseup',   function(event) { map.dragging.enable();L.DomEvent.stopPropagation(event);webBridge.mouseup(); });\n" // setOptions ?
-                                "polyline.on('mouseover', function(event) { webBridge.hoverPath(event.latlng.lat, event.latlng.lng); });\n"
-                                "path = polyline.getLatLngs();\n"
-                                "}\n").arg(styleoptions == "" ? color.name() : GColor(CPLOTMARKER).name())
-                                .arg(styleoptions == "" ? 0.5 : 1.0);
-            } else if (mapCombo->currentIndex() == GOOGLE) {
-                // color the polyline
-                code += QString("var polyOptions = {\n"
-                                "    strokeColor: '%1',\n"
-                                "    strokeWeight: 3,\n"
-                                "    strokeOpacity: %2,\n" // for out and backs, we need both
-                                "    zIndex: 0,\n"
-                                "}\n"
-                                "polyline.setOptions(polyOptions);\n"
-                                "}\n").arg(styleoptions == "" ? color.name() : GColor(CPLOTMARKER).name())
-                                      .arg(styleoptions == "" ? 0.5f : 1.0f);
-
+            // join up with the end of the last one
+            int first, last;
+            if (track.range(start, rfp->secs, first, last)) {
+                if (first > 0) first--;
+                segments << QString("%1,%2,'%3'").arg(first).arg(last)
+                                                  .arg(styleoptions == "" ? color.name() : GColor(CPLOTMARKER).name());
             }
-#ifdef NOWEBKIT
-            view->page()->runJavaScript(code);
-#else
-            view->page()->mainFrame()->evaluateJavaScript(code);
-#endif
         }
     }
 
+    QString code = QString("drawSegments([%1], %2);\n").arg(segments.join(","))
+                                                       .arg(styleoptions == "" ? 0.5 : 1.0);
+#ifdef NOWEBKIT
+    view->page()->runJavaScript(code);
+#else
+    view->page()->mainFrame()->evaluateJavaScript(code);
+#endif
 }
 
 void
@@ -884,11 +936,14 @@ RideMapWindow::clearTempInterval() {
     QString code;
     if (mapCombo->currentIndex() == OSM) {
         code = QString( "{ \n"
-                            "    if (tmpIntervalHighlighter)\n"
+                            "    if (tmpIntervalHighlighter) {\n"
+                            "       removeTrackLine(tmpIntervalHighlighter);\n"
                             "       tmpIntervalHighlighter.setLatLngs([]);\n"
+                            "    }\n"
                             "}\n" );
     } else if (mapCombo->currentIndex() == GOOGLE) {
         code = QString( "{ \n"
+                            "    removeTrackLine(tmpIntervalHighlighter);\n"
                             "    tmpIntervalHighlighter.getPath().clear();\n"
                             "}\n" );
     }
@@ -902,71 +957,14 @@ RideMapWindow::clearTempInterval() {
 
 void
 RideMapWindow::drawTempInterval(IntervalItem *current) {
-    QString code;
-
-    if (mapCombo->currentIndex() == OSM) {
-        code = QString( "{ \n"
-                    // interval will be drawn with these options
-                    "    var polyOptions = {\n"
-                    "        stroke: true,\n"
-                    "        color: '#00FFFF',\n"
-                    "        opacity: 0.6,\n"
-                    "        weight: 10,\n"
-                    "        zIndex: -1\n"  // put at the bottom
-                    "    };\n"
-
-                    "    if (!tmpIntervalHighlighter) {\n"
-                    "       tmpIntervalHighlighter = new L.Polyline([], polyOptions);\n"
-                    "       tmpIntervalHighlighter.addTo(map);\n"
-                    "       tmpIntervalHighlighter.on('mouseup',   function(event) { map.dragging.enable();L.DomEvent.stopPropagation(event); webBridge.mouseup(); });\n" // map.setOptions({draggable: true, zoomControl: true, scrollwheel: true, disableDoubleClickZoom: false});
-                    "    } \n"
-                    "    tmpIntervalHighlighter.setLatLngs([]);\n"
-                    "    var latLons = ["
-                    "\n");
-    } else if (mapCombo->currentIndex() == GOOGLE) {
-        code = QString( "{ \n"
-                    // interval will be drawn with these options
-                    "    var polyOptions = {\n"
-                    "        strokeColor: '#00FFFF',\n"
-                    "        strokeOpacity: 0.6,\n"
-                    "        strokeWeight: 10,\n"
-                    "        zIndex: -1\n"  // put at the bottom
-                    "    }\n"
-
-                    "    if (!tmpIntervalHighlighter) {\n"
-                    "       tmpIntervalHighlighter = new google.maps.Polyline(polyOptions);\n"
-                    "       tmpIntervalHighlighter.setMap(map);\n"
-                    "       google.maps.event.addListener(tmpIntervalHighlighter, 'mouseup',   function(event) { map.setOptions({draggable: true, zoomControl: true, scrollwheel: true, disableDoubleClickZoom: false}); webBridge.mouseup(); });\n"
-                    "    } \n"
-
-                    "    var path = tmpIntervalHighlighter.getPath();\n"
-                    "    path.clear();\n");
-    }
-
-    foreach(RideFilePoint *rfp, myRideItem->ride()->dataPoints()) {
-        if (rfp->secs+myRideItem->ride()->recIntSecs() > current->start
-            && rfp->secs< current->stop) {
 
-            if (rfp->lat || rfp->lon) {
-                if (mapCombo->currentIndex() == OSM) {
-                    code += QString("[%1, %2], ").arg(rfp->lat,0,'g',GPS_COORD_TO_STRING).arg(rfp->lon,0,'g',GPS_COORD_TO_STRING);
-                }
-            } else if (mapCombo->currentIndex() == GOOGLE) {
-                code += QString("    path.push(new google.maps.LatLng(%1,%2));\n").arg(rfp->lat,0,'g',GPS_COORD_TO_STRING).arg(rfp->lon,0,'g',GPS_COORD_TO_STRING);
-            }
-        }
+    int first, last;
+    if (!track.range(current->start - myRideItem->ride()->recIntSecs(), current->stop, first, last)) {
+        clearTempInterval();
+        return;
     }
 
-    if (mapCombo->currentIndex() == OSM) {
-        // Finalize variable "latLons" for the segment.
-        if (code.endsWith(", "))
-            code.resize(code.length() - 2);
-        code += QString("];\n"
-                        "path = latLons\n"  // Set the path to the current interval.
-                        "}\n" );
-    } else if (mapCombo->currentIndex() == GOOGLE) {
-        code += QString("}\n" );
-    }
+    QString code = QString("drawTempInterval(%1, %2);\n").arg(first).arg(last);
 #ifdef NOWEBKIT
     view->page()->runJavaScript(code);
 #else
@@ -1260,42 +1258,33 @@ MapWebBridge::intervalCount()
     return 0;
 }
 
-// get a latlon array for the i'th selected interval
+// the whole track, encoded for the page to decode into a typed array
+QString
+MapWebBridge::getTrack()
+{
+    return mw->mapTrack().encoded();
+}
+
+// first and last point in the track for the i'th selected
+// interval, or the entire route when i is 0
 QVariantList
-MapWebBridge::getLatLons(int i)
+MapWebBridge::getRange(int i)
 {
-    QVariantList latlons;
+    QVariantList range;
     RideItem *rideItem = mw->property("ride").value<RideItem*>();
+    const RideMapTrack &track = mw->mapTrack();
 
+    int first, last;
     if (rideItem && i > 0 && rideItem->intervalsSelected().count() >= i) {
 
         IntervalItem *current = rideItem->intervalsSelected().at(i-1);
+        if (track.range(current->start - rideItem->ride()->recIntSecs(), current->stop, first, last))
+            range << first << last;
 
-        // so this one is the interval we need.. lets
-        // snaffle up the points in this section
-        foreach (RideFilePoint *p1, rideItem->ride()->dataPoints()) {
-            if (p1->secs+rideItem->ride()->recIntSecs() > current->start
-                && p1->secs< current->stop) {
-
-                if (p1->lat || p1->lon) {
-                    latlons << p1->lat;
-                    latlons << p1->lon;
-                }
-            }
-        }
-        return latlons;
-
-    } else if (rideItem) {
-
-        // get latlons for entire route
-        foreach (RideFilePoint *p1, rideItem->ride()->dataPoints()) {
-            if (p1->lat || p1->lon) {
-                latlons << p1->lat;
-                latlons << p1->lon;
-            }
-        }
+    } else if (!track.isEmpty()) {
+        range << 0 << track.count()-1;
     }
-    return latlons;
+    return range;
 }
 
 // once the basic map and route have been marked, overlay markers, shaded areas etc
@@ -32,6 +32,7 @@
 #include "RideFile.h"
 #include "IntervalItem.h"
 #include "Context.h"
+#include "RideMapTrack.h"
 
 #include <QDialog>
 
@@ -95,7 +96,8 @@ class MapWebBridge : public QObject
 
         // drawing basic route, and interval polylines
         Q_INVOKABLE int intervalCount();
-        Q_INVOKABLE QVariantList getLatLons(int i); // get array of latitudes for highlighted n
+        Q_INVOKABLE QString getTrack(); // the whole track, encoded
+        Q_INVOKABLE QVariantList getRange(int i); // first and last point for highlighted n
 
         // once map and basic route is loaded
         // this slot is called to draw additional
@@ -170,6 +172,9 @@ class RideMapWindow : public GcChartWindow
         QString googleKey() const { return gkey->text(); }
         void setGoogleKey(QString x) { gkey->setText(x); }
 
+        // the track for the current ride
+        const RideMapTrack &mapTrack() const { return track; }
+
 
     public slots:
         void mapTypeSelected(int x);
@@ -219,6 +224,7 @@ class RideMapWindow : public GcChartWindow
         int rideCP; // rider's CP
         QString currentPage;
         RideItem *current;
+        RideMapTrack track;
         bool firstShow;
         IntervalSummaryWindow *overlayIntervals;
 
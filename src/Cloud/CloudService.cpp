@@ -34,6 +34,11 @@
 #include <QMessageBox>
 #include <QHeaderView>
 #include <QDesktopWidget>
+#if QT_VERSION > 0x050000
+# include <QtConcurrent>
+#else
+# include <QtConcurrentRun>
+#endif
 
 #include "../qzip/zipwriter.h"
 #include "../qzip/zipreader.h"
@@ -694,7 +699,8 @@ FolderNameDialog::FolderNameDialog(QWidget *parent) : QDialog(parent)
 }
 
 CloudServiceSyncDialog::CloudServiceSyncDialog(Context *context, CloudService *store)
-    : QDialog(context->mainWindow, Qt::Dialog), context(context), store(store), downloading(false), aborted(false)
+    : QDialog(context->mainWindow, Qt::Dialog), context(context), store(store), downloading(false), sync(false), aborted(false),
+      active(0), starting(false), mode(2)
 {
     setWindowTitle(tr("Synchronise ") + store->uiName());
     setMinimumSize(850 *dpiXFactor,450 *dpiYFactor);
@@ -859,6 +865,13 @@ CloudServiceSyncDialog::CloudServiceSyncDialog(Context *context, CloudService *s
 
     overwrite = new QCheckBox(tr("Overwrite existing files"), this);
 
+    // only offered if the service can cope
+    transfers = new QSpinBox(this);
+    transfers->setRange(1, qMax(1, store->transferLimit()));
+    transfers->setValue(transfers->maximum());
+    transfers->setSuffix(tr(" at once"));
+    transfers->setVisible(transfers->maximum() > 1);
+
     // layout the widget now...
     QVBoxLayout *mainLayout = new QVBoxLayout(this);
 
@@ -877,6 +890,7 @@ CloudServiceSyncDialog::CloudServiceSyncDialog(Context *context, CloudService *s
     botline->addWidget(progressLabel);
     botline->addStretch();
     botline->addWidget(overwrite);
+    botline->addWidget(transfers);
     botline->addWidget(cancelButton);
     botline->addWidget(downloadButton);
 
@@ -1306,28 +1320,33 @@ void
 CloudServiceSyncDialog::downloadClicked()
 {
     if (downloading == true) {
-        rideListDown->setSortingEnabled(true);
-        rideListUp->setSortingEnabled(true);
-        progressLabel->setText("");
-        downloadButton->setText(tr("Download"));
-        downloading=false;
+
+        // let whatever is in flight finish, anything not
+        // started stays selected so it can be resumed
         aborted=true;
-        cancelButton->show();
+        foreach(CloudServiceTransfer *transfer, pending) delete transfer;
+        pending.clear();
+
+        if (active) {
+            progressLabel->setText(tr("Aborting..."));
+            downloadButton->setEnabled(false);
+        } else transfersDone();
         return;
     } else {
         rideListDown->setSortingEnabled(false);
-        rideListUp->setSortingEnabled(true);
+        rideListUp->setSortingEnabled(false);
+        rideListSync->setSortingEnabled(false);
         downloading=true;
         aborted=false;
         downloadButton->setText(tr("Abort"));
         cancelButton->hide();
+        transfers->setEnabled(false);
     }
 
     // keeping track of progress...
     downloadcounter = 0;
     successful = 0;
     downloadtotal = 0;
-    listindex = 0;
 
     QTreeWidget *which = NULL;
     switch(tabs->currentIndex()) {
@@ -1351,283 +1370,279 @@ CloudServiceSyncDialog::downloadClicked()
         progressBar->setValue(0);
     }
 
+    // queue up the work in list order
+    mode = tabs->currentIndex();
+    sync = mode == 2;
+    for (int i=0; i<which->invisibleRootItem()->childCount(); i++) {
+        QTreeWidgetItem *curr = which->invisibleRootItem()->child(i);
+        QCheckBox *check = (QCheckBox*)which->itemWidget(curr, 0);
+        if (!check->isChecked()) continue;
+
+        CloudServiceTransfer *transfer = new CloudServiceTransfer;
+        transfer->item = curr;
+        transfer->name = curr->text(1);
+
+        switch(mode) {
+        case 0 :
+            {
+                // skip existing if overwrite not set
+                QCheckBox *exists = (QCheckBox*)rideListDown->itemWidget(curr, 4);
+                if (exists->isChecked() && !overwrite->isChecked()) {
+                    curr->setText(5, tr("File exists"));
+                    progressBar->setValue(++downloadcounter);
+                    delete transfer;
+                    continue;
+                }
+                transfer->col = 5;
+                transfer->id = curr->text(6);
+            }
+            break;
+        case 1 :
+            {
+                // skip existing if overwrite not set
+                QCheckBox *exists = (QCheckBox*)rideListUp->itemWidget(curr, 6);
+                if (exists->isChecked() && !overwrite->isChecked()) {
+                    curr->setText(7, tr("File exists"));
+                    progressBar->setValue(++downloadcounter);
+                    delete transfer;
+                    continue;
+                }
+                transfer->upload = true;
+            }
+            break;
+        default:
+        case 2 :
+            transfer->upload = curr->text(6) != tr("Download");
+            transfer->id = curr->text(8);
+            break;
+        }
+
+        if (transfer->upload)
+            transfer->filename = context->athlete->home->activities().canonicalPath() + "/" + curr->text(1);
+
+        pending << transfer;
+    }
+
     // even if nothing to download this
     // cleans up variables et al
-    sync = false;
-    switch(tabs->currentIndex()) {
-        case 0 : downloadNext(); break;
-        case 1 : uploadNext(); break;
-        case 2 : sync = true; syncNext(); break;
-    }
+    startTransfers();
 }
 
-bool
-CloudServiceSyncDialog::syncNext()
+// worker thread; read in the local file and get a compressed version to upload
+static void prepareUpload(CloudService *store, Context *context, CloudServiceTransfer *transfer)
 {
-    // the actual download/upload is kicked off using the uploader / downloader
-    // if in sync mode the completedRead / completedWrite functions
-    // just call completedSync to get the next Sync done
-    for (int i=listindex; i<rideListSync->invisibleRootItem()->childCount(); i++) {
-        QTreeWidgetItem *curr = rideListSync->invisibleRootItem()->child(i);
-        QCheckBox *check = (QCheckBox*)rideListSync->itemWidget(curr, 0);
-
-        if (check->isChecked()) {
-
-            listindex = i+1; // start from the next one
-
-            progressLabel->setText(QString(tr("Processed %1 of %2")).arg(downloadcounter).arg(downloadtotal));
-            if (curr->text(6) == tr("Download")) {
-                curr->setText(7, tr("Downloading"));
-                rideListSync->setCurrentItem(curr);
+    QFile file(transfer->filename);
+    transfer->ride = RideFileFactory::instance().openRideFile(context, file, transfer->errors);
+    if (transfer->ride) {
+        transfer->ride->moveToThread(qApp->thread()); // deleted on the GUI thread
+        transfer->data = new QByteArray;
+        store->compressRide(transfer->ride, *transfer->data, QFileInfo(transfer->name).baseName() + ".json");
+    }
+}
 
-                QByteArray *data = new QByteArray;
-                store->readFile(data, curr->text(1), curr->text(8)); // filename
-                QApplication::processEvents();
+// worker thread; uncompress and parse what was downloaded
+static void parseDownload(CloudService *store, CloudServiceTransfer *transfer)
+{
+    transfer->ride = store->uncompressRide(transfer->data, transfer->name, transfer->errors);
+    if (transfer->ride) transfer->ride->moveToThread(qApp->thread()); // saved on the GUI thread
+    delete transfer->data;
+    transfer->data = NULL;
+}
 
-            } else {
-                curr->setText(7, tr("Uploading"));
-                rideListSync->setCurrentItem(curr);
+void
+CloudServiceSyncDialog::startTransfers()
+{
+    // stores that complete whilst we are starting
+    // them call back in here, the loop below copes
+    if (starting) return;
+    starting = true;
+
+    while (!pending.isEmpty() && active < transfers->value()) {
+        active++;
+        startTransfer(pending.takeFirst());
+    }
+    starting = false;
 
-                // read in the file
-                QStringList errors;
-                QFile file(context->athlete->home->activities().canonicalPath() + "/" + curr->text(1));
-                RideFile *ride = RideFileFactory::instance().openRideFile(context, file, errors);
+    if (active == 0) transfersDone();
+    else progressLabel->setText(QString(tr("Processed %1 of %2")).arg(downloadcounter).arg(downloadtotal));
+}
 
-                if (ride) {
+void
+CloudServiceSyncDialog::startTransfer(CloudServiceTransfer *transfer)
+{
+    QTreeWidget *which = transfer->item->treeWidget();
+    which->setCurrentItem(transfer->item);
 
-                    // get a compressed version
-                    QByteArray data;
-                    store->compressRide(ride, data, QFileInfo(curr->text(1)).baseName() + ".json");
+    if (transfer->upload) {
 
-                    store->writeFile(data, QFileInfo(curr->text(1)).baseName() + store->uploadExtension(), ride);
-                    QApplication::processEvents();
-                    delete ride; // clean up!
-                    return true;
+        // read and compress in the background
+        transfer->item->setText(transfer->col, tr("Uploading"));
+        QFutureWatcher<void> *watcher = new QFutureWatcher<void>(this);
+        working.insert(watcher, transfer);
+        connect(watcher, SIGNAL(finished()), this, SLOT(uploadPrepared()));
+        watcher->setFuture(QtConcurrent::run(prepareUpload, store, context, transfer));
 
-                } else {
-                    curr->setText(7, tr("Parse failure"));
-                    QApplication::processEvents();
-                }
+    } else {
 
-            }
-            return true;
+        transfer->item->setText(transfer->col, tr("Downloading"));
+        transfer->data = new QByteArray; // gets deleted once parsed
+        reads.insert(transfer->data, transfer);
+        if (store->readFile(transfer->data, transfer->name, transfer->id) == false && reads.contains(transfer->data)) {
+            reads.remove(transfer->data);
+            delete transfer->data;
+            transfer->data = NULL;
+            finishTransfer(transfer, tr("Download failed"), false);
         }
     }
-
-    //
-    // Our work is done!
-    //
-    rideListDown->setSortingEnabled(true);
-    rideListUp->setSortingEnabled(true);
-    rideListSync->setSortingEnabled(true);
-    progressLabel->setText(tr("Sync complete"));
-    downloadButton->setText(tr("Synchronize"));
-    downloading=false;
-    aborted=false;
-    sync=false;
-    cancelButton->show();
-    selectAllSync->setChecked(Qt::Unchecked);
-    for (int i=0; i<rideListSync->invisibleRootItem()->childCount(); i++) {
-        QTreeWidgetItem *curr = rideListSync->invisibleRootItem()->child(i);
-        QCheckBox *check = (QCheckBox*)rideListSync->itemWidget(curr, 0);
-        check->setChecked(false);
-    }
-    progressLabel->setText(QString(tr("Processed %1 of %2 successfully")).arg(successful).arg(downloadtotal));
-
-    // save the ride cache, we don't want to lose that if we crash etc.
-    context->athlete->rideCache->save();
-
-    return false;
 }
 
-bool
-CloudServiceSyncDialog::downloadNext()
+void
+CloudServiceSyncDialog::uploadPrepared()
 {
-    for (int i=listindex; i<rideListDown->invisibleRootItem()->childCount(); i++) {
-        QTreeWidgetItem *curr = rideListDown->invisibleRootItem()->child(i);
-        QCheckBox *check = (QCheckBox*)rideListDown->itemWidget(curr, 0);
-        QCheckBox *exists = (QCheckBox*)rideListDown->itemWidget(curr, 4);
+    QFutureWatcher<void> *watcher = static_cast<QFutureWatcher<void>*>(QObject::sender());
+    CloudServiceTransfer *transfer = working.take(watcher);
+    watcher->deleteLater();
+    if (!transfer) return;
 
-        // skip existing if overwrite not set
-        if (check->isChecked() && exists->isChecked() && !overwrite->isChecked()) {
-            curr->setText(5, tr("File exists"));
-            progressBar->setValue(++downloadcounter);
-            continue;
-        }
-
-        if (check->isChecked()) {
-
-            listindex = i+1; // start from the next one
-            curr->setText(5, tr("Downloading"));
-            rideListDown->setCurrentItem(curr);
-            progressLabel->setText(QString(tr("Downloaded %1 of %2")).arg(downloadcounter).arg(downloadtotal));
-
-            QByteArray *data = new QByteArray; // gets deleted when read completes
-            store->readFile(data, curr->text(1), curr->text(6));
-            QApplication::processEvents();
-            //delete data;
-            return true;
-        }
+    if (transfer->ride == NULL) {
+        finishTransfer(transfer, tr("Parse failure"), false);
+        return;
     }
-
-    //
-    // Our work is done!
-    //
-    rideListDown->setSortingEnabled(true);
-    rideListUp->setSortingEnabled(true);
-    progressLabel->setText(tr("Downloads complete"));
-    downloadButton->setText(tr("Download"));
-    downloading=false;
-    aborted=false;
-    cancelButton->show();
-    selectAll->setChecked(Qt::Unchecked);
-    for (int i=0; i<rideListDown->invisibleRootItem()->childCount(); i++) {
-        QTreeWidgetItem *curr = rideListDown->invisibleRootItem()->child(i);
-        QCheckBox *check = (QCheckBox*)rideListDown->itemWidget(curr, 0);
-        check->setChecked(false);
+    if (aborted) {
+        finishTransfer(transfer, tr("Aborted"), false);
+        return;
     }
-    progressLabel->setText(QString(tr("Downloaded %1 of %2 successfully")).arg(successful).arg(downloadtotal));
-
-    // save the ride cache, we don't want to lose that if we crash etc.
-    context->athlete->rideCache->save();
 
-    return false;
+    // the store works from the data and ride whilst writing,
+    // so they are kept until it completes (or fails)
+    QString remotename = QFileInfo(transfer->name).baseName() + store->uploadExtension();
+    writes << transfer;
+    transfer->id = remotename;
+    if (store->writeFile(*transfer->data, remotename, transfer->ride) == false && writes.contains(transfer)) {
+        writes.removeOne(transfer);
+        finishTransfer(transfer, tr("Upload failed"), false);
+    }
 }
 
 void
 CloudServiceSyncDialog::completedRead(QByteArray *data, QString name, QString /*message*/)
 {
-    QTreeWidget *which = sync ? rideListSync : rideListDown;
-    int col = sync ? 7 : 5;
+    CloudServiceTransfer *transfer = reads.take(data);
+    if (!transfer) return; // not one of ours
 
     // was abort pressed?
     if (aborted == true) {
-        QTreeWidgetItem *curr = which->invisibleRootItem()->child(listindex-1);
-        curr->setText(col, tr("Aborted"));
+        delete transfer->data;
+        transfer->data = NULL;
+        finishTransfer(transfer, tr("Aborted"), false);
         return;
     }
 
-    // uncompress and parse, note the filename is passed and may be
-    // different to what we asked for (sometimes the data is converted
-    // from one file format to another).
-    QStringList errors;
-    RideFile *ride = store->uncompressRide(data, name, errors);
-
-    // was allocated in before calling readfile
-    delete data;
-
-    progressBar->setValue(++downloadcounter);
-
-    QTreeWidgetItem *curr = which->invisibleRootItem()->child(listindex-1);
-    if (ride) {
-        if (saveRide(ride, errors) == true) {
-            curr->setText(col, tr("Saved"));
-            successful++;
-        } else {
-            curr->setText(col, errors.join(" "));
-        }
+    // uncompress and parse in the background, note the filename is passed
+    // and may be different to what we asked for (sometimes the data is
+    // converted from one file format to another).
+    transfer->name = name;
+    QFutureWatcher<void> *watcher = new QFutureWatcher<void>(this);
+    working.insert(watcher, transfer);
+    connect(watcher, SIGNAL(finished()), this, SLOT(downloadParsed()));
+    watcher->setFuture(QtConcurrent::run(parseDownload, store, transfer));
+}
 
-        // delete once saved
-        delete ride;
+void
+CloudServiceSyncDialog::downloadParsed()
+{
+    QFutureWatcher<void> *watcher = static_cast<QFutureWatcher<void>*>(QObject::sender());
+    CloudServiceTransfer *transfer = working.take(watcher);
+    watcher->deleteLater();
+    if (!transfer) return;
+
+    if (aborted) {
+        finishTransfer(transfer, tr("Aborted"), false);
+    } else if (transfer->ride && saveRide(transfer->ride, transfer->errors) == true) {
+        finishTransfer(transfer, tr("Saved"), true);
     } else {
-        curr->setText(col, errors.join(" "));
+        finishTransfer(transfer, transfer->errors.join(" "), false);
     }
-
-    QApplication::processEvents();
-
-    if (sync)
-        syncNext();
-    else
-        downloadNext();
 }
 
-bool
-CloudServiceSyncDialog::uploadNext()
+void
+CloudServiceSyncDialog::completedWrite(QString name, QString result)
 {
-    for (int i=listindex; i<rideListUp->invisibleRootItem()->childCount(); i++) {
-        QTreeWidgetItem *curr = rideListUp->invisibleRootItem()->child(i);
-        QCheckBox *check = (QCheckBox*)rideListUp->itemWidget(curr, 0);
-        QCheckBox *exists = (QCheckBox*)rideListUp->itemWidget(curr, 6);
-
-        // skip existing if overwrite not set
-        if (check->isChecked() && exists->isChecked() && !overwrite->isChecked()) {
-            curr->setText(7, tr("File exists"));
-            progressBar->setValue(++downloadcounter);
-            continue;
+    if (writes.isEmpty()) return; // not one of ours
+
+    // match on the name, some stores don't pass
+    // it back so fall back to the order we asked
+    CloudServiceTransfer *transfer = writes.first();
+    foreach(CloudServiceTransfer *write, writes) {
+        if (write->id == name) {
+            transfer = write;
+            break;
         }
+    }
+    writes.removeOne(transfer);
 
-        if (check->isChecked()) {
-
-            listindex = i+1; // start from the next one
-            curr->setText(7, tr("Uploading"));
-            rideListUp->setCurrentItem(curr);
-            progressLabel->setText(QString(tr("Uploaded %1 of %2")).arg(downloadcounter).arg(downloadtotal));
+    // was abort pressed?
+    if (aborted == true) finishTransfer(transfer, tr("Aborted"), false);
+    else finishTransfer(transfer, result, result == tr("Completed."));
+}
 
-            // read in the file - TEMPORARILY *** WE DON'T USE IN MEMORY VERSION ***
-            QStringList errors;
-            QFile file(context->athlete->home->activities().canonicalPath() + "/" + curr->text(1));
-            RideFile *ride = RideFileFactory::instance().openRideFile(context, file, errors);
+void
+CloudServiceSyncDialog::finishTransfer(CloudServiceTransfer *transfer, QString status, bool ok)
+{
+    transfer->item->setText(transfer->col, status);
+    progressBar->setValue(++downloadcounter);
 
-            if (ride) {
+    // done, so won't be repeated if resumed
+    if (ok) {
+        successful++;
+        QTreeWidget *which = transfer->item->treeWidget();
+        QCheckBox *check = (QCheckBox*)which->itemWidget(transfer->item, 0);
+        check->setChecked(false);
+    }
 
-                    // get a compressed version
-                    QByteArray data;
-                    store->compressRide(ride, data, QFileInfo(curr->text(1)).baseName() + ".json");
-                    store->writeFile(data, QFileInfo(curr->text(1)).baseName() + store->uploadExtension(), ride);
-                    QApplication::processEvents();
-                    delete ride; // clean up!
-                    return true;
+    delete transfer->ride;
+    delete transfer->data;
+    delete transfer;
 
-            } else {
-                curr->setText(7, tr("Parse failure"));
-                QApplication::processEvents();
-            }
-        }
-    }
+    active--;
+    startTransfers();
+}
 
+void
+CloudServiceSyncDialog::transfersDone()
+{
     //
     // Our work is done!
     //
     rideListDown->setSortingEnabled(true);
     rideListUp->setSortingEnabled(true);
-    progressLabel->setText(tr("Uploads complete"));
-    downloadButton->setText(tr("Upload"));
+    rideListSync->setSortingEnabled(true);
     downloading=false;
     aborted=false;
+    downloadButton->setEnabled(true);
+    transfers->setEnabled(true);
     cancelButton->show();
-    selectAllUp->setChecked(Qt::Unchecked);
-    for (int i=0; i<rideListUp->invisibleRootItem()->childCount(); i++) {
-        QTreeWidgetItem *curr = rideListUp->invisibleRootItem()->child(i);
-        QCheckBox *check = (QCheckBox*)rideListUp->itemWidget(curr, 0);
-        check->setChecked(false);
-    }
-    progressLabel->setText(QString(tr("Uploaded %1 of %2 successfully")).arg(successful).arg(downloadtotal));
-    return false;
-}
 
-void
-CloudServiceSyncDialog::completedWrite(QString, QString result)
-{
-    QTreeWidget *which = sync ? rideListSync : rideListUp;
-
-    // was abort pressed?
-    if (aborted == true) {
-        QTreeWidgetItem *curr = which->invisibleRootItem()->child(listindex-1);
-        curr->setText(7, tr("Aborted"));
-        return;
+    // anything that failed is still selected so can be tried again
+    switch(mode) {
+    case 0 :
+        downloadButton->setText(tr("Download"));
+        progressLabel->setText(QString(tr("Downloaded %1 of %2 successfully")).arg(successful).arg(downloadtotal));
+        break;
+    case 1 :
+        downloadButton->setText(tr("Upload"));
+        progressLabel->setText(QString(tr("Uploaded %1 of %2 successfully")).arg(successful).arg(downloadtotal));
+        break;
+    default:
+    case 2 :
+        downloadButton->setText(tr("Synchronize"));
+        progressLabel->setText(QString(tr("Processed %1 of %2 successfully")).arg(successful).arg(downloadtotal));
+        break;
     }
+    sync=false;
 
-    progressBar->setValue(++downloadcounter);
-
-    QTreeWidgetItem *curr = which->invisibleRootItem()->child(listindex-1);
-    curr->setText(7, result);
-    if (result == tr("Completed.")) successful++;
-    QApplication::processEvents();
-
-    if (sync)
-        syncNext();
-    else
-        uploadNext();
+    // save the ride cache, we don't want to lose that if we crash etc.
+    if (mode != 1) context->athlete->rideCache->save();
 }
 
 bool
@@ -36,6 +36,8 @@
 #include <QPushButton>
 #include <QProgressBar>
 #include <QPropertyAnimation>
+#include <QSpinBox>
+#include <QFutureWatcher>
 
 #include "Context.h"
 #include "Athlete.h"
@@ -132,6 +134,10 @@ class CloudService : public QObject {
         }
         void notifyReadComplete(QByteArray *data, QString name, QString message) { emit readComplete(data,name,message); }
 
+        // how many reads/writes can be in flight at once when syncing, services
+        // that keep state for a single request must leave this at 1
+        virtual int transferLimit() const { return 1; }
+
         // list and select an athlete - list will need to block rather than notify asynchronously
         virtual QList<CloudServiceAthlete> listAthletes() { return QList<CloudServiceAthlete>(); }
         virtual bool selectAthlete(CloudServiceAthlete) { return false; }
@@ -311,6 +317,21 @@ class FolderNameDialog : public QDialog
 
 };
 
+// a download or upload being worked on by the sync dialog
+struct CloudServiceTransfer {
+
+    CloudServiceTransfer() : item(NULL), col(7), upload(false), data(NULL), ride(NULL) {}
+
+    QTreeWidgetItem *item;  // row in the list
+    int col;                // status column
+    bool upload;
+    QString name, id;       // remote name and id
+    QString filename;       // local file to upload
+    QByteArray *data;       // read buffer, or compressed data to upload
+    RideFile *ride;         // parsed on a worker thread
+    QStringList errors;
+};
+
 //
 // The Sync Dialog
 //
@@ -338,6 +359,13 @@ class CloudServiceSyncDialog : public QDialog
 
         void completedRead(QByteArray *data, QString name, QString message);
         void completedWrite(QString name,QString message);
+
+    private slots:
+
+        // worker threads have finished
+        void uploadPrepared();
+        void downloadParsed();
+
     private:
         Context *context;
         CloudService *store;
@@ -355,16 +383,23 @@ class CloudServiceSyncDialog : public QDialog
         // keeping track of progress...
         int downloadcounter,    // *x* of n downloading
             downloadtotal,      // x of *n* downloading
-            successful,         // how many downloaded ok?
-            listindex;          // where in rideList we've got to
+            successful;         // how many downloaded ok?
+
+        // transfers waiting to start, on a worker thread and with the store,
+        // reads are matched up by buffer and writes by name (or in order)
+        QList<CloudServiceTransfer*> pending;
+        QHash<QFutureWatcher<void>*, CloudServiceTransfer*> working;
+        QHash<QByteArray*, CloudServiceTransfer*> reads;
+        QList<CloudServiceTransfer*> writes;
+        int active;             // started and not yet finished
+        bool starting;          // stores may complete whilst we start them
+        int mode;               // tab we are working on
 
         bool saveRide(RideFile *, QStringList &);
-        bool syncNext();        // kick off another download/upload
-                                // returns false if none left
-        bool downloadNext();    // kick off another download
-                                // returns false if none left
-        bool uploadNext();     // kick off another upload
-                                // returns false if none left
+        void startTransfers();  // keep the store busy
+        void startTransfer(CloudServiceTransfer *);
+        void finishTransfer(CloudServiceTransfer *, QString status, bool ok);
+        void transfersDone();   // all finished, or aborted
 
         // tabs - Upload/Download
         QTabWidget *tabs;
@@ -397,6 +432,7 @@ class CloudServiceSyncDialog : public QDialog
         QLabel *progressLabel;
 
         QCheckBox *overwrite;
+        QSpinBox *transfers;    // how many at once
 };
 
 // Representing a File or Folder
@@ -51,6 +51,9 @@ class Dropbox : public CloudService {
         // read a file
         bool readFile(QByteArray *data, QString remotename, QString);
 
+        // requests are tracked by reply
+        int transferLimit() const { return 4; }
+
         // create a folder
         bool createFolder(QString path);
 
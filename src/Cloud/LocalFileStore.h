@@ -51,6 +51,9 @@ class LocalFileStore : public CloudService {
         // read a file
         bool readFile(QByteArray *data, QString remotename, QString);
 
+        // reads and writes complete straight away
+        int transferLimit() const { return 4; }
+
         // create a folder
         bool createFolder(QString path);
 
@@ -30,6 +30,7 @@
 #include "HrZones.h"
 #include "PaceZones.h"
 #include "Measures.h"
+#include "Trace.h"
 
 #include <QTemporaryFile>
 #include <QFile>
@@ -37,6 +38,8 @@
 void
 APIWebService::service(HttpRequest &request, HttpResponse &response)
 {
+    GC_TRACE_SPAN("APIWebService::service");
+
     // remove trailing '/' from request, just to be consistent
     QString fullPath = request.getPath();
     while (fullPath.endsWith("/")) fullPath.chop(1);
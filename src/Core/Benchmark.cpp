@@ -0,0 +1,415 @@
+/*
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "Benchmark.h"
+#include "Context.h"
+#include "Athlete.h"
+#include "Settings.h"
+#include "GcUpgrade.h"
+#include "RideCache.h"
+#include "RideItem.h"
+#include "RideFile.h"
+#include "RideFileCache.h"
+#include "RideMetric.h"
+#include "Specification.h"
+#include "DataFilter.h"
+#include "PMCData.h"
+#include "WPrime.h"
+#include "RideImportPipeline.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QMap>
+#include <QSet>
+#include <QThread>
+#include <QElapsedTimer>
+#include <QCoreApplication>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <algorithm>
+
+static double
+msecsSince(const QElapsedTimer &timer)
+{
+    return timer.nsecsElapsed() / 1000000.0;
+}
+
+//
+// BenchmarkResult
+//
+double
+BenchmarkResult::min() const
+{
+    if (msecs.isEmpty()) return 0;
+    return *std::min_element(msecs.begin(), msecs.end());
+}
+
+double
+BenchmarkResult::median() const
+{
+    if (msecs.isEmpty()) return 0;
+
+    QVector<double> sorted = msecs;
+    std::sort(sorted.begin(), sorted.end());
+    int half = sorted.count() / 2;
+    if (sorted.count() % 2) return sorted[half];
+    return (sorted[half-1] + sorted[half]) / 2.0;
+}
+
+double
+BenchmarkResult::max() const
+{
+    if (msecs.isEmpty()) return 0;
+    return *std::max_element(msecs.begin(), msecs.end());
+}
+
+//
+// Benchmark
+//
+Benchmark::Benchmark(Context *context) : context(context), iterations(5)
+{
+    formula = "Duration > 1800 && Average_Power > 150";
+}
+
+bool
+Benchmark::createAthlete(QString root, QString &error)
+{
+    QString name = "bench";
+    QDir rootDir(root);
+    if (!rootDir.exists(name) && !rootDir.mkdir(name)) {
+        error = QString("Cannot create athlete in %1").arg(root);
+        return false;
+    }
+
+    // as per new athlete, no upgrade required
+    QDir athleteDir(rootDir.canonicalPath() + "/" + name);
+    AthleteDirectoryStructure home(athleteDir);
+    home.createAllSubdirs();
+    appsettings->initializeQSettingsNewAthlete(rootDir.canonicalPath(), name);
+    appsettings->setCValue(name, GC_UPGRADE_FOLDER_SUCCESS, true);
+    appsettings->setCValue(name, GC_VERSION_USED, QVariant(VERSION_LATEST));
+    return true;
+}
+
+QStringList
+Benchmark::sampleFiles() const
+{
+    QStringList returning;
+    if (samples == "") return returning;
+
+    QStringList folders;
+    folders << "rides" << "runs" << "swims";
+    foreach(QString folder, folders) {
+        QDir dir(samples + "/" + folder);
+        foreach(QFileInfo info, dir.entryInfoList(QDir::Files, QDir::Name))
+            returning << info.absoluteFilePath();
+    }
+    return returning;
+}
+
+int
+Benchmark::importSamples()
+{
+    // the import pipeline writes the json, as it does for the
+    // wizard, but we add the rides to the library ourselves
+    QList<RideImportJob> jobs = RideImportPipeline::jobsFor(sampleFiles(), context->athlete->home->activities());
+    RideImportPipeline pipeline(context, jobs, false);
+    pipeline.start();
+    pipeline.wait();
+
+    // named by start time as per import, the same activity is
+    // in several formats so only add it once
+    QSet<QString> added;
+    for (int i=0; i<pipeline.count(); i++) {
+        const RideImportJob &job = pipeline.job(i);
+        if (!job.ok || added.contains(job.activitiesTarget)) continue;
+
+        context->athlete->addRide(job.activitiesTarget, false, false, false, false);
+        added << job.activitiesTarget;
+    }
+    return added.count();
+}
+
+bool
+Benchmark::run()
+{
+    // let any refresh started when the athlete was opened finish
+    RideCache *cache = context->athlete->rideCache;
+    while (cache->isRunning()) {
+        QCoreApplication::processEvents();
+        QThread::msleep(10);
+    }
+
+    results.clear();
+    openFiles();
+    refresh();
+    computeMetrics();
+    fileCache();
+    wprime();
+    pmc();
+    dataFilter();
+    rideCache();
+
+    if (results.isEmpty()) {
+        error = "Nothing to benchmark, no samples and no activities.";
+        return false;
+    }
+    return true;
+}
+
+// opening each sample file, by format
+void
+Benchmark::openFiles()
+{
+    // files we can open by suffix, opening them once also
+    // means the timings don't include reading from disk
+    QMap<QString, QStringList> formats;
+    foreach(QString filename, sampleFiles()) {
+        QStringList errors;
+        QFile file(filename);
+        RideFile *ride = RideFileFactory::instance().openRideFile(context, file, errors);
+        if (ride) formats[QFileInfo(filename).suffix().toLower()] << filename;
+        delete ride;
+    }
+
+    QMapIterator<QString, QStringList> i(formats);
+    while (i.hasNext()) {
+        i.next();
+
+        BenchmarkResult result("open " + i.key(), i.value().count());
+        for (int n=0; n<iterations; n++) {
+            QElapsedTimer timer;
+            timer.start();
+            foreach(QString filename, i.value()) {
+                QStringList errors;
+                QFile file(filename);
+                delete RideFileFactory::instance().openRideFile(context, file, errors);
+            }
+            result.msecs << msecsSince(timer);
+        }
+        results << result;
+    }
+}
+
+// RideItem::refresh, as run by the ride cache
+void
+Benchmark::refresh()
+{
+    QVector<RideItem*> &rides = context->athlete->rideCache->rides();
+    if (rides.isEmpty()) return;
+
+    BenchmarkResult result("refresh", rides.count());
+    for (int n=0; n<iterations; n++) {
+        QElapsedTimer timer;
+        timer.start();
+        foreach(RideItem *item, rides) {
+            item->isstale = true;
+            item->refresh();
+        }
+        result.msecs << msecsSince(timer);
+    }
+    results << result;
+}
+
+// the ride is opened before timing these, since that's in refresh
+void
+Benchmark::computeMetrics()
+{
+    QVector<RideItem*> &rides = context->athlete->rideCache->rides();
+    if (rides.isEmpty()) return;
+
+    const QStringList &metrics = RideMetricFactory::instance().allMetrics();
+    BenchmarkResult result("computeMetrics", rides.count());
+    result.msecs.fill(0, iterations);
+
+    foreach(RideItem *item, rides) {
+        bool close = !item->isOpen();
+        if (!item->ride()) continue;
+
+        for (int n=0; n<iterations; n++) {
+            QElapsedTimer timer;
+            timer.start();
+            RideMetric::computeMetrics(item, Specification(), metrics);
+            result.msecs[n] += msecsSince(timer);
+        }
+        if (close) item->close();
+    }
+    results << result;
+}
+
+void
+Benchmark::fileCache()
+{
+    QVector<RideItem*> &rides = context->athlete->rideCache->rides();
+    if (rides.isEmpty()) return;
+
+    BenchmarkResult result("RideFileCache", rides.count());
+    result.msecs.fill(0, iterations);
+
+    foreach(RideItem *item, rides) {
+        bool close = !item->isOpen();
+        RideFile *ride = item->ride();
+        if (!ride) continue;
+
+        for (int n=0; n<iterations; n++) {
+            QElapsedTimer timer;
+            timer.start();
+            RideFileCache compute(ride);
+            result.msecs[n] += msecsSince(timer);
+        }
+        if (close) item->close();
+    }
+    results << result;
+}
+
+void
+Benchmark::wprime()
+{
+    QVector<RideItem*> &rides = context->athlete->rideCache->rides();
+    if (rides.isEmpty()) return;
+
+    BenchmarkResult result("WPrime", rides.count());
+    result.msecs.fill(0, iterations);
+
+    foreach(RideItem *item, rides) {
+        bool close = !item->isOpen();
+        RideFile *ride = item->ride();
+        if (!ride) continue;
+
+        for (int n=0; n<iterations; n++) {
+            QElapsedTimer timer;
+            timer.start();
+            WPrime wprime;
+            wprime.setRide(ride);
+            result.msecs[n] += msecsSince(timer);
+        }
+        if (close) item->close();
+    }
+    results << result;
+}
+
+void
+Benchmark::pmc()
+{
+    int count = context->athlete->rideCache->count();
+    if (count == 0) return;
+
+    BenchmarkResult result("PMCData", count);
+    for (int n=0; n<iterations; n++) {
+        QElapsedTimer timer;
+        timer.start();
+        PMCData pmc(context, Specification(), "coggan_tss");
+        pmc.refresh();
+        result.msecs << msecsSince(timer);
+    }
+    results << result;
+}
+
+// parsing and evaluating the formula across all the activities
+void
+Benchmark::dataFilter()
+{
+    int count = context->athlete->rideCache->count();
+    if (count == 0 || formula == "") return;
+
+    BenchmarkResult result("DataFilter", count);
+    for (int n=0; n<iterations; n++) {
+        QElapsedTimer timer;
+        timer.start();
+        DataFilter filter(NULL, context);
+        filter.parseFilter(context, formula);
+        result.msecs << msecsSince(timer);
+    }
+    results << result;
+}
+
+void
+Benchmark::rideCache()
+{
+    RideCache *cache = context->athlete->rideCache;
+    if (cache->count() == 0) return;
+
+    BenchmarkResult save("RideCache save", cache->count());
+    BenchmarkResult load("RideCache load", cache->count());
+    for (int n=0; n<iterations; n++) {
+        QElapsedTimer timer;
+        timer.start();
+        cache->save();
+        save.msecs << msecsSince(timer);
+
+        timer.restart();
+        cache->load();
+        load.msecs << msecsSince(timer);
+    }
+    results << save << load;
+}
+
+QByteArray
+Benchmark::json() const
+{
+    QJsonObject root;
+    root.insert("version", QString(VERSION_STRING));
+    root.insert("build", VERSION_LATEST);
+    root.insert("qt", QString(qVersion()));
+    root.insert("threads", QThread::idealThreadCount());
+    root.insert("athlete", context->athlete->cyclist);
+    root.insert("activities", context->athlete->rideCache->count());
+    root.insert("iterations", iterations);
+
+    QJsonArray stages;
+    foreach(const BenchmarkResult &result, results) {
+        QJsonObject stage;
+        stage.insert("name", result.name);
+        stage.insert("items", result.items);
+        stage.insert("min_ms", result.min());
+        stage.insert("median_ms", result.median());
+        stage.insert("max_ms", result.max());
+        stage.insert("per_item_ms", result.perItem());
+        stage.insert("per_second", result.perSecond());
+
+        QJsonArray msecs;
+        foreach(double m, result.msecs) msecs.append(m);
+        stage.insert("msecs", msecs);
+        stages.append(stage);
+    }
+    root.insert("results", stages);
+
+    return QJsonDocument(root).toJson();
+}
+
+QString
+Benchmark::report() const
+{
+    QString returning = QString("%1 %2 iterations\n")
+                        .arg("stage", -20).arg(iterations);
+    returning += QString("%1 %2 %3 %4 %5 %6\n")
+                 .arg("", -20).arg("items", 6).arg("min ms", 10).arg("median ms", 10)
+                 .arg("max ms", 10).arg("per sec", 10);
+
+    foreach(const BenchmarkResult &result, results) {
+        returning += QString("%1 %2 %3 %4 %5 %6\n")
+                     .arg(result.name, -20)
+                     .arg(result.items, 6)
+                     .arg(result.min(), 10, 'f', 2)
+                     .arg(result.median(), 10, 'f', 2)
+                     .arg(result.max(), 10, 'f', 2)
+                     .arg(result.perSecond(), 10, 'f', 1);
+    }
+    return returning;
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _GC_Benchmark_h
+#define _GC_Benchmark_h 1
+#include "GoldenCheetah.h"
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QList>
+#include <QByteArray>
+
+class Context;
+class RideItem;
+
+// one timed stage, msecs for each iteration over its items
+class BenchmarkResult
+{
+    public:
+        BenchmarkResult() : items(0) {}
+        BenchmarkResult(QString name, int items) : name(name), items(items) {}
+
+        QString name;
+        int items;
+        QVector<double> msecs;
+
+        double min() const;
+        double median() const;
+        double max() const;
+        double perItem() const { return items ? median() / items : 0; }
+        double perSecond() const { double m = median(); return m > 0 ? items * 1000.0 / m : 0; }
+};
+
+//
+// Times the expensive parts of working with an athlete's data; opening
+// each file format, refreshing rides, computing metrics, the mean max
+// cache, W'bal, the PMC, formulas and loading and saving the ride cache.
+//
+// Run headless with --bench (or make gcbench) against an athlete, or the
+// sample files in test/ imported into a throwaway athlete so the runs
+// are comparable between builds. Each stage is run a number of times
+// and the median is reported, results are written as json.
+//
+class Benchmark
+{
+    public:
+        Benchmark(Context *context);
+
+        // folder with rides, runs and swims folders of sample files
+        void setSamples(QString dir) { samples = dir; }
+        void setIterations(int n) { iterations = qMax(1, n); }
+        void setFormula(QString formula) { this->formula = formula; }
+
+        // create an empty athlete folder named bench in root
+        static bool createAthlete(QString root, QString &error);
+
+        // import the samples into the athlete, returns how many
+        int importSamples();
+
+        // run all the stages
+        bool run();
+
+        // json results, and a table to read
+        QByteArray json() const;
+        QString report() const;
+
+        QString errorString() const { return error; }
+
+    private:
+        QStringList sampleFiles() const;
+
+        void openFiles();
+        void refresh();
+        void computeMetrics();
+        void fileCache();
+        void wprime();
+        void pmc();
+        void dataFilter();
+        void rideCache();
+
+        Context *context;
+        QString samples, formula, error;
+        int iterations;
+        QList<BenchmarkResult> results;
+};
+
+#endif // _GC_Benchmark_h
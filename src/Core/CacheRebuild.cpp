@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "CacheRebuild.h"
+#include "Context.h"
+#include "Athlete.h"
+#include "RideCache.h"
+#include "RideItem.h"
+#include "Estimator.h"
+
+#include <QFile>
+#include <QThread>
+#include <QThreadPool>
+#include <QElapsedTimer>
+#include <QCoreApplication>
+
+CacheRebuild::CacheRebuild(Context *context, qint64 openMsecs, uint started) : context(context), started(started)
+{
+    stage("open", openMsecs, context->athlete->rideCache->count());
+}
+
+int
+CacheRebuild::clear(const QDir &home)
+{
+    AthleteDirectoryStructure structure(home);
+
+    // the ride cache and the caches alongside the .cpx
+    QStringList filters;
+    filters << "*.cpx" << "*.cen" << "*.hmp" << "*.gcb";
+
+    int count = 0;
+    QStringList folders;
+    folders << structure.cache().canonicalPath() << structure.cache().canonicalPath() + "/planned";
+    foreach(QString folder, folders) {
+        QDir dir(folder);
+        foreach(QString name, dir.entryList(filters, QDir::Files))
+            if (dir.remove(name)) count++;
+    }
+    if (QFile::remove(structure.cache().canonicalPath() + "/rideDB.json")) count++;
+    return count;
+}
+
+void
+CacheRebuild::stage(QString name, double msecs, int items)
+{
+    double secs = msecs / 1000.0;
+    lines << QString("%1 %2 secs %3 items %4 items/s")
+             .arg(name, -10)
+             .arg(secs, 10, 'f', 3)
+             .arg(items, 8)
+             .arg(secs > 0 ? items / secs : 0, 10, 'f', 1);
+}
+
+bool
+CacheRebuild::run()
+{
+    RideCache *cache = context->athlete->rideCache;
+
+    // the refresh was started when the athlete was opened
+    QElapsedTimer timer;
+    timer.start();
+    int last = -1;
+    while (cache->isRunning()) {
+        QCoreApplication::processEvents();
+        QThread::msleep(10);
+
+        int progress = int(cache->progress()) / 10 * 10;
+        if (progress != last) {
+            fprintf(stderr, "refreshing %d%%\n", progress);
+            last = progress;
+        }
+    }
+    QCoreApplication::processEvents(); // deliver finished
+
+    // those refreshed set their timestamp
+    int refreshed = 0;
+    foreach(RideItem *item, cache->rides()) {
+        if (item->timestamp >= started) refreshed++;
+        if (item->isstale) {
+            error = QString("%1 was not refreshed").arg(item->fileName);
+        }
+    }
+    stage("refresh", timer.nsecsElapsed() / 1000000.0, refreshed);
+
+    // the estimates are kicked off at the end of a refresh in the
+    // background, but only after a delay when nothing was stale
+    timer.restart();
+    cache->estimator->calculate();
+    cache->estimator->wait();
+    stage("estimates", timer.nsecsElapsed() / 1000000.0, cache->count());
+
+    timer.restart();
+    cache->save();
+    stage("save", timer.nsecsElapsed() / 1000000.0, cache->count());
+
+    lines << QString("threads %1").arg(QThreadPool::globalInstance()->maxThreadCount());
+    return error == "";
+}
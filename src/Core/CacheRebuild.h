@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _GC_CacheRebuild_h
+#define _GC_CacheRebuild_h 1
+#include "GoldenCheetah.h"
+
+#include <QString>
+#include <QStringList>
+#include <QDir>
+
+class Context;
+
+//
+// Brings an athlete's caches up to date headless, so they can be
+// warmed before the athlete is handed over; the metrics, intervals and
+// .cpx etc via the usual RideCache refresh, then the estimates, then the
+// ride cache is saved. Opening the athlete starts the refresh, this
+// waits for it and reports how long each stage took.
+//
+// For a full rebuild the caches are removed before opening the athlete
+// so everything is stale, the number of refresh threads is set on the
+// global thread pool before the athlete is opened too.
+//
+class CacheRebuild
+{
+    public:
+        CacheRebuild(Context *context, qint64 openMsecs, uint started);
+
+        // remove the ride cache and per activity caches, returns how many
+        static int clear(const QDir &home);
+
+        // wait for the refresh, estimates and save
+        bool run();
+
+        // one line per stage
+        QString report() const { return lines.join("\n") + "\n"; }
+
+        QString errorString() const { return error; }
+
+    private:
+        void stage(QString name, double msecs, int items);
+
+        Context *context;
+        uint started;
+        QString error;
+        QStringList lines;
+};
+
+#endif // _GC_CacheRebuild_h
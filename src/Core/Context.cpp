@@ -23,6 +23,7 @@
 #include "UserMetricSettings.h"
 #include "UserMetricParser.h"
 #include "DataFilter.h"
+#include "TelemetryBus.h"
 
 #include <QXmlInputSource>
 #include <QXmlSimpleReader>
@@ -38,6 +39,7 @@ Context::Context(MainWindow *mainWindow): mainWindow(mainWindow)
     isfiltered = ishomefiltered = false;
     isCompareIntervals = isCompareDateRanges = false;
     isRunning = isPaused = false;
+    telemetry = new TelemetryBus();
 
 #ifdef GC_HAS_CLOUD_DB
     cdbChartListDialog = NULL;
@@ -51,6 +53,29 @@ Context::~Context()
 {
     int i=_contexts.indexOf(this);
     if (i >= 0) _contexts.removeAt(i);
+
+    delete telemetry;
+}
+
+void
+Context::notifyTelemetryUpdate(const RealtimeData &rtData)
+{
+    telemetry->publish(rtData);
+
+    // the charts are updated from the event loop, not whilst we
+    // are in the middle of the train update, and if they fall
+    // behind they only get the latest and skip the rest
+    if (telemetryPending.testAndSetOrdered(0, 1))
+        QMetaObject::invokeMethod(this, "dispatchTelemetry", Qt::QueuedConnection);
+}
+
+void
+Context::dispatchTelemetry()
+{
+    telemetryPending.store(0);
+
+    RealtimeData rtData;
+    if (telemetry->latest(rtData)) emit telemetryUpdate(rtData);
 }
 
 void 
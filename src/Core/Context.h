@@ -20,6 +20,7 @@
 #define _GC_Context_h 1
 
 #include "TimeUtils.h" // for class DateRange
+#include <QAtomicInt>
 #include "RealtimeData.h" // for class RealtimeData
 #include "SpecialFields.h" // for class RealtimeData
 #include "CompareInterval.h" // what intervals are being compared?
@@ -66,6 +67,7 @@ class VideoSyncFile;
 
 class Context;
 class Athlete;
+class TelemetryBus;
 class MainWindow;
 class Tab;
 
@@ -110,6 +112,9 @@ class Context : public QObject
         bool isRunning;
         bool isPaused;
 
+        // latest telemetry, charts can sample it when they paint
+        TelemetryBus *telemetry;
+
         // comparing things
         bool isCompareIntervals;
         QList<CompareInterval> compareIntervals;
@@ -150,7 +155,7 @@ class Context : public QObject
         void setIndex(int i) { viewIndex = i; emit viewChanged(i); }
 
         // realtime signals
-        void notifyTelemetryUpdate(const RealtimeData &rtData) { telemetryUpdate(rtData); }
+        void notifyTelemetryUpdate(const RealtimeData &rtData);
         void notifyErgFileSelected(ErgFile *x) { workout=x; ergFileSelected(x); }
         void notifyVideoSyncFileSelected(VideoSyncFile *x) { videosync=x; videoSyncFileSelected(x); }
         ErgFile *currentErgFile() { return workout; }
@@ -212,6 +217,15 @@ class Context : public QObject
         // and we need to notify other contexts !
         void userMetricsConfigChanged();
 
+    private slots:
+
+        // send the latest telemetry to the charts
+        void dispatchTelemetry();
+
+    private:
+
+        QAtomicInt telemetryPending;
+
     signals:
 
         // global filter changed
@@ -17,6 +17,7 @@
  */
 
 #include "Utils.h"
+#include "RollingStats.h"
 #include "Statistic.h"
 #include "DataFilter.h"
 #include "Context.h"
@@ -33,6 +34,8 @@
 #include "GenericSelectTool.h" // for generic calculator
 #include <QDebug>
 #include <QMutex>
+#include <QThread>
+#include <QtConcurrent>
 #include "lmcurve.h"
 #include "LTMTrend.h" // for LR when copying CP chart filtering mechanism
 
@@ -176,6 +179,8 @@ static struct {
     { "lr", 2 },   // lr(xlist, ylist) - linear regression on x,y co-ords returns vector [slope, intercept, r2, see]
 
     { "smooth", 0 }, // smooth(list, algorithm, ... parameters) - returns smoothed data.
+                     // algorithms are sma, ewma and the moving median and mad (median absolute deviation)
+                     // smooth(list, median|mad, windowsize) which are useful for finding outliers
 
     { "sqrt", 1 }, // sqrt(x) - returns square root, for vectors returns the sqrt of the sum
 
@@ -226,6 +231,10 @@ static struct {
     { "", -1 }
 };
 
+// the math.h functions and sum .. count at the top of the
+// list, they only depend upon their parameters
+static const int DataFilterMathFunctions = 26;
+
 static QStringList pdmodels()
 {
     QStringList returning;
@@ -1367,7 +1376,7 @@ void Leaf::validateFilter(Context *context, DataFilterRuntime *df, Leaf *leaf)
             QRegExp constValidSymbols("^(e|pi)$", Qt::CaseInsensitive); // just do basics for now
             QRegExp dateRangeValidSymbols("^(start|stop)$", Qt::CaseInsensitive); // date range
             QRegExp pmcValidSymbols("^(stress|lts|sts|sb|rr|date)$", Qt::CaseInsensitive);
-            QRegExp smoothAlgos("^(sma|ewma)$", Qt::CaseInsensitive);
+            QRegExp smoothAlgos("^(sma|ewma|median|mad)$", Qt::CaseInsensitive);
             QRegExp annotateTypes("^(label)$", Qt::CaseInsensitive);
             QRegExp curveData("^(x|y|z|d|t)$", Qt::CaseInsensitive);
 
@@ -1792,6 +1801,18 @@ void Leaf::validateFilter(Context *context, DataFilterRuntime *df, Leaf *leaf)
                                     validateFilter(context, df, leaf->fparms[0]);
                                     validateFilter(context, df, leaf->fparms[2]);
                                 }
+
+                            } else if (algo == "median" || algo == "mad") {
+                                // smooth(list, median|mad, windowsize)
+
+                                if (leaf->fparms.count() != 3) {
+                                    leaf->inerror = true;
+                                    DataFiltererrors << QString(tr("smooth(list, %1, windowsize)").arg(algo));
+                                } else {
+                                    // check list and windowsize
+                                    validateFilter(context, df, leaf->fparms[0]);
+                                    validateFilter(context, df, leaf->fparms[2]);
+                                }
                             }
                         }
                     }
@@ -2494,6 +2515,161 @@ Result::vectorize(int count)
 // used by lowerbound
 struct comparedouble { bool operator()(const double p1, const double p2) { return p1 < p2; } };
 
+//
+// Vector kernels
+//
+// Arithmetic and math functions on vectors are the bulk of the work when
+// user charts compute over every sample in a ride or a season. We size
+// the result once and run tight loops over contiguous arrays with the
+// operation hoisted out, which the compiler can vectorize, rather than
+// appending one element at a time through a switch.
+//
+static double vectorSum(const double *v, int n)
+{
+    // four accumulators to break the dependency chain
+    double s0=0, s1=0, s2=0, s3=0;
+    int i=0;
+    for(; i+3<n; i+=4) { s0 += v[i]; s1 += v[i+1]; s2 += v[i+2]; s3 += v[i+3]; }
+    for(; i<n; i++) s0 += v[i];
+    return (s0+s1) + (s2+s3);
+}
+
+static void vectorOperation(int op, Result &lhs, Result &rhs, Result &returning)
+{
+    int ln = lhs.vector.count();
+    int rn = rhs.vector.count();
+    int size = ln > rn ? ln : rn;
+
+    // vectors of differing lengths are recycled, scalars broadcast
+    if (ln && rn && ln != rn) {
+        lhs.vectorize(size);
+        rhs.vectorize(size);
+        ln = rn = size;
+    }
+
+    returning.vector.resize(size);
+    double *out = returning.vector.data();
+    const double *l = ln ? lhs.vector.constData() : NULL;
+    const double *r = rn ? rhs.vector.constData() : NULL;
+    const double ls = lhs.number, rs = rhs.number;
+
+    switch (op) {
+    case ADD:
+        if (l && r) for(int i=0; i<size; i++) out[i] = l[i] + r[i];
+        else if (l) for(int i=0; i<size; i++) out[i] = l[i] + rs;
+        else        for(int i=0; i<size; i++) out[i] = ls + r[i];
+        break;
+    case SUBTRACT:
+        if (l && r) for(int i=0; i<size; i++) out[i] = l[i] - r[i];
+        else if (l) for(int i=0; i<size; i++) out[i] = l[i] - rs;
+        else        for(int i=0; i<size; i++) out[i] = ls - r[i];
+        break;
+    case MULTIPLY:
+        if (l && r) for(int i=0; i<size; i++) out[i] = l[i] * r[i];
+        else if (l) for(int i=0; i<size; i++) out[i] = l[i] * rs;
+        else        for(int i=0; i<size; i++) out[i] = ls * r[i];
+        break;
+    case DIVIDE:
+        // divide by zero is zero, not inf
+        if (l && r) for(int i=0; i<size; i++) out[i] = r[i] ? l[i] / r[i] : 0;
+        else if (l) for(int i=0; i<size; i++) out[i] = rs ? l[i] / rs : 0;
+        else        for(int i=0; i<size; i++) out[i] = r[i] ? ls / r[i] : 0;
+        break;
+    case POW:
+        for(int i=0; i<size; i++) out[i] = pow(l ? l[i] : ls, r ? r[i] : rs);
+        break;
+    }
+    returning.number = vectorSum(out, size);
+}
+
+//
+// Parallel sapply
+//
+// When the expression applied to each element only depends upon x, i,
+// literals and existing user symbols, and only calls math functions, then
+// evaluating it cannot change the runtime and elements can be computed
+// concurrently. Anything else (assignment, user functions, metrics, data
+// access, while loops) is evaluated serially as before.
+//
+static bool sapplyPure(DataFilterRuntime *df, Leaf *leaf)
+{
+    if (leaf == NULL) return true;
+
+    switch(leaf->type) {
+    case Leaf::Float :
+    case Leaf::Integer :
+    case Leaf::String :
+        return true;
+
+    case Leaf::Symbol :
+        {
+            QString symbol = *(leaf->lvalue.n);
+            return symbol == "x" || symbol == "i" || df->symbols.contains(symbol);
+        }
+
+    case Leaf::Logical :
+        if (leaf->op == AND || leaf->op == OR) return sapplyPure(df, leaf->lvalue.l) && sapplyPure(df, leaf->rvalue.l);
+        return sapplyPure(df, leaf->lvalue.l);
+
+    case Leaf::UnaryOperation :
+        return sapplyPure(df, leaf->lvalue.l);
+
+    case Leaf::BinaryOperation :
+    case Leaf::Operation :
+        return leaf->op != ASSIGN && sapplyPure(df, leaf->lvalue.l) && sapplyPure(df, leaf->rvalue.l);
+
+    case Leaf::Conditional :
+        return (leaf->op == IF_ || leaf->op == 0) && sapplyPure(df, leaf->cond.l) &&
+               sapplyPure(df, leaf->lvalue.l) && sapplyPure(df, leaf->rvalue.l);
+
+    case Leaf::Index :
+        return sapplyPure(df, leaf->lvalue.l) && sapplyPure(df, leaf->fparms[0]);
+
+    case Leaf::Function :
+        {
+            if (leaf->series || df->functions.contains(leaf->function)) return false;
+
+            // math.h functions and sum, mean, max, min, count
+            bool math=false;
+            for (int i=0; i<DataFilterMathFunctions; i++) {
+                if (DataFilterFunctions[i].name == leaf->function) {
+                    math = true;
+                    break;
+                }
+            }
+            if (!math) return false;
+            foreach(Leaf *parm, leaf->fparms) if (!sapplyPure(df, parm)) return false;
+            return true;
+        }
+
+    default:
+        return false;
+    }
+}
+
+struct SapplyChunk {
+    DataFilterRuntime *df;
+    Leaf *leaf;
+    const double *in;
+    double *out;
+    int from, to;
+    RideItem *m;
+    RideFilePoint *p;
+    const QHash<QString,RideMetric*> *c;
+    Specification s;
+    DateRange d;
+};
+
+static void sapplyChunk(SapplyChunk &chunk)
+{
+    Leaf *expr = chunk.leaf->fparms[1];
+    for(int i=chunk.from; i<chunk.to; i++)
+        chunk.out[i] = chunk.leaf->eval(chunk.df, expr, chunk.in[i], i, chunk.m, chunk.p, chunk.c, chunk.s, chunk.d).number;
+}
+
+// below this it isn't worth farming out to threads
+static const int SAPPLY_PARALLEL_MIN = 4096;
+
 Result Leaf::eval(DataFilterRuntime *df, Leaf *leaf, float x, long it, RideItem *m, RideFilePoint *p, const QHash<QString,RideMetric*> *c, Specification s, DateRange d)
 {
     // if error state all bets are off
@@ -2772,12 +2948,16 @@ Result Leaf::eval(DataFilterRuntime *df, Leaf *leaf, float x, long it, RideItem
             Result v = eval(df, leaf->fparms[0],x, it, m, p, c, s, d);
             if (v.vector.count() == 0) return Result(v.number);
 
+            int n = v.vector.count();
+            returning.vector.resize(n);
+            const double *in = v.vector.constData();
+            double *out = returning.vector.data();
             double cumsum = 0;
-            for(int it=0; it < v.vector.count(); it++) {
-                cumsum += v.vector[it];
-                returning.number += cumsum;
-                returning.vector << cumsum;
+            for(int it=0; it < n; it++) {
+                cumsum += in[it];
+                out[it] = cumsum;
             }
+            returning.number = vectorSum(out, n);
             return returning;
         }
 
@@ -3369,15 +3549,29 @@ Result Leaf::eval(DataFilterRuntime *df, Leaf *leaf, float x, long it, RideItem
             // need a vector, always
             if (!value.vector.count()) return returning;
 
-            // loop and evaluate, non-zero we keep, zero we lose
-            for(int i=0; i<value.vector.count(); i++) {
-                x = value.vector.at(i);
-                double r = eval(df,leaf->fparms[1],x, i, m, p, c, s, d).number;
+            int n = value.vector.count();
+            returning.vector.resize(n);
+            const double *in = value.vector.constData();
+            double *out = returning.vector.data();
+
+            if (n >= SAPPLY_PARALLEL_MIN && QThread::idealThreadCount() > 1 && sapplyPure(df, leaf->fparms[1])) {
 
-                // we want it
-                returning.vector << r;
-                returning.number += r;
+                // split into a few chunks per core
+                QVector<SapplyChunk> chunks;
+                int nchunks = QThread::idealThreadCount() * 4;
+                int step = (n + nchunks - 1) / nchunks;
+                for(int from=0; from < n; from += step) {
+                    SapplyChunk chunk = { df, leaf, in, out, from, qMin(n, from+step), m, p, c, s, d };
+                    chunks << chunk;
+                }
+                QtConcurrent::blockingMap(chunks, sapplyChunk);
+
+            } else {
+
+                // loop and evaluate
+                for(int i=0; i<n; i++) out[i] = eval(df,leaf->fparms[1],in[i], i, m, p, c, s, d).number;
             }
+            returning.number = vectorSum(out, n);
             return returning;
         }
 
@@ -3431,6 +3625,22 @@ Result Leaf::eval(DataFilterRuntime *df, Leaf *leaf, float x, long it, RideItem
                 Result data = eval(df,leaf->fparms[0],x, it, m, p, c, s, d);
 
                 returning.vector = Utils::smooth_ewma(data.vector, alpha);
+
+            } else if (*(leaf->fparms[1]->lvalue.n) == "median") {
+
+                // moving median, trailing window
+                int window = eval(df,leaf->fparms[2],x, it, m, p, c, s, d).number;
+                Result data = eval(df,leaf->fparms[0],x, it, m, p, c, s, d);
+
+                returning.vector = RollingStats::median(data.vector, window);
+
+            } else if (*(leaf->fparms[1]->lvalue.n) == "mad") {
+
+                // moving median absolute deviation, trailing window
+                int window = eval(df,leaf->fparms[2],x, it, m, p, c, s, d).number;
+                Result data = eval(df,leaf->fparms[0],x, it, m, p, c, s, d);
+
+                returning.vector = RollingStats::mad(data.vector, window);
             }
 
             // sum. ugh.
@@ -3708,11 +3918,12 @@ Result Leaf::eval(DataFilterRuntime *df, Leaf *leaf, float x, long it, RideItem
 
                 Result v = eval(df, leaf->fparms[0],x, it, m, p, c, s, d);
                 if (v.vector.count()) {
-                    for(int i=0; i<v.vector.count(); i++) {
-                        double r = func(v.vector[i]);
-                        returning.vector << r;
-                        returning.number += r;
-                    }
+                    int n = v.vector.count();
+                    returning.vector.resize(n);
+                    const double *in = v.vector.constData();
+                    double *out = returning.vector.data();
+                    for(int i=0; i<n; i++) out[i] = func(in[i]);
+                    returning.number = vectorSum(out, n);
                 } else {
                     returning.number =  func(v.number);
                 }
@@ -4531,27 +4742,7 @@ Result Leaf::eval(DataFilterRuntime *df, Leaf *leaf, float x, long it, RideItem
                 // its a vector operation...
                 if (lhs.vector.count() || rhs.vector.count()) {
 
-                    int size = lhs.vector.count() > rhs.vector.count() ? lhs.vector.count() : rhs.vector.count();
-
-                    // coerce both into a vector of matching size
-                    lhs.vectorize(size);
-                    rhs.vectorize(size);
-
-                    for(int i=0; i<size; i++) {
-                        double left = lhs.vector[i];
-                        double right = rhs.vector[i];
-                        double value = 0;
-
-                        switch (leaf->op) {
-                        case ADD: value = left + right; break;
-                        case SUBTRACT: value = left - right; break;
-                        case DIVIDE: value = right ? left / right : 0; break;
-                        case MULTIPLY: value = left * right; break;
-                        case POW: value = pow(left,right); break;
-                        }
-                        returning.vector << value;
-                        returning.number += value;
-                    }
+                    vectorOperation(leaf->op, lhs, rhs, returning);
 
                 } else {
                     switch (leaf->op) {
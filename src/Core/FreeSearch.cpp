@@ -22,6 +22,7 @@
 #include "RideItem.h"
 #include "IntervalItem.h"
 #include "RideCache.h"
+#include "SearchIndex.h"
 
 FreeSearch::FreeSearch(QObject *parent, Context *context) : QObject(parent), context(context)
 {
@@ -83,36 +84,10 @@ QList<QString> FreeSearch::search(QString query)
     // search split will tokenise and handle quoting and escaping
     QStringList tokens = searchSplit(query);
 
-    foreach(RideItem*item, context->athlete->rideCache->rides()) {
-
-        QMapIterator<QString,QString> meta(item->metadata());
-        meta.toFront();
-        while (meta.hasNext()) {
-            meta.next();
-
-            // does the super string contain the tokens?
-            foreach(QString token, tokens) {
-
-                if (meta.value().contains(token, Qt::CaseInsensitive)) {
-                    filenames << item->fileName;
-                    goto nextItem;
-                }
-            }
-        }
-
-        // user intervals - even autodiscovered
-        foreach(IntervalItem *interval, item->intervals()) {
-
-            foreach (QString token, tokens) {
-
-                if (interval->name.contains(token, Qt::CaseInsensitive)) {
-                    filenames << item->fileName;
-                    goto nextItem;
-                }
-            }
-        }
-        nextItem:;
-    }
+    // the index returns rides matching any of the tokens in
+    // metadata or interval names, see SearchIndex.cpp
+    foreach(RideItem*item, context->athlete->rideCache->searchIndex()->search(tokens))
+        filenames << item->fileName;
 
     emit results(filenames);
 
@@ -25,6 +25,8 @@
 #include "Specification.h"
 #include "DataProcessor.h"
 #include "Estimator.h"
+#include "SearchIndex.h"
+#include "Trace.h"
 
 #include "Route.h"
 
@@ -55,6 +57,7 @@ RideCache::RideCache(Context *context) : context(context)
     plannedDirectory = context->athlete->home->planned();
 
     progress_ = 100;
+    generation_ = 0;
     exiting = false;
     estimator = new Estimator(context);
 
@@ -129,10 +132,17 @@ RideCache::RideCache(Context *context) : context(context)
 
     // now sort it
     qSort(rides_.begin(), rides_.end(), rideCacheLessThan);
+    renumber();
 
     // set model once we have the basics
     model_ = new RideCacheModel(context, this);
 
+    // search index is built on first use and then kept up to date
+    searchIndex_ = new SearchIndex(this);
+    connect(context, SIGNAL(rideSaved(RideItem*)), searchIndex_, SLOT(invalidate(RideItem*)));
+    connect(context, SIGNAL(intervalsUpdate(RideItem*)), searchIndex_, SLOT(invalidate(RideItem*)));
+    connect(context, SIGNAL(refreshEnd()), searchIndex_, SLOT(refreshEnd()));
+
     // after the first ridecache refresh we set initial pd estimates
     first= true;
     connect(context, SIGNAL(refreshEnd()), this, SLOT(initEstimates()));
@@ -197,6 +207,7 @@ RideCache::configChanged(qint32 what)
         foreach(RideItem *item, rides()) {
             item->metadata_.insert("Calendar Text", context->athlete->rideMetadata()->calendarText(item));
         }
+        searchIndex_->invalidateAll();
     }
 
     // if zones or weight has changed refresh metrics
@@ -218,6 +229,9 @@ RideCache::itemChanged()
     // BECAUSE IT IS ASSUMED BELOW THE SENDER IS A RIDEITEM
     RideItem *item = static_cast<RideItem*>(QObject::sender());
 
+    // metadata and intervals may have changed
+    searchIndex_->invalidate(item);
+
     // the model is particularly interested in ANY item that changes
     emit itemChanged(item);
 
@@ -255,6 +269,7 @@ RideCache::addRide(QString name, bool dosignal, bool select, bool useTempActivit
     bool added = false;
     for (int index=0; index < rides_.count(); index++) {
         if (rides_[index]->fileName == last->fileName) {
+            searchIndex_->remove(rides_[index]);
             rides_[index] = last;
             added = true;
             break;
@@ -266,11 +281,15 @@ RideCache::addRide(QString name, bool dosignal, bool select, bool useTempActivit
         model_->beginReset();
         rides_ << last;
         qSort(rides_.begin(), rides_.end(), rideCacheLessThan);
+        renumber();
         model_->endReset();
+    } else {
+        renumber();
     }
 
     // refresh metrics for *this ride only*
     last->refresh();
+    searchIndex_->invalidate(last);
 
     if (dosignal) context->notifyRideAdded(last); // here so emitted BEFORE rideSelected is emitted!
 
@@ -335,6 +354,8 @@ RideCache::removeCurrentRide()
     // but model needs to know about this!
     model_->startRemove(index);
     rides_.remove(index, 1);
+    renumber();
+    searchIndex_->remove(todelete);
     delete_<<todelete;
     model_->endRemove(index);
 
@@ -356,7 +377,7 @@ RideCache::removeCurrentRide()
 
     // remove any other derived/additional files; notes, cpi etc (they can only exist in /cache )
     QStringList extras;
-    extras << "notes" << "cpi" << "cpx";
+    extras << "notes" << "cpi" << "cpx" << "gcb" << "cen" << "hmp";
     foreach (QString extension, extras) {
 
         QString deleteMe = QFileInfo(strOldFileName).baseName() + "." + extension;
@@ -449,6 +470,8 @@ itemRefresh(RideItem *&item)
 {
     // need parser to be reentrant !item->refresh();
     if (item->isstale) {
+        GC_TRACE_THREAD("Worker");
+        GC_TRACE_SPAN("RideCache::itemRefresh");
         item->refresh();
 
         // and trap changes during refresh to current ride
@@ -466,6 +489,7 @@ RideCache::progressing(int value)
 {
     // we're working away, notfy everyone where we got
     progress_ = 100.0f * (double(value) / double(watcher.progressMaximum()));
+    GC_TRACE_COUNTER("RideCache::progress", progress_);
     if (value) {
         QDate here = reverse_.at(value-1)->dateTime.date();
         context->notifyRefreshUpdate(here);
@@ -489,14 +513,18 @@ RideCache::refresh()
     // already on it !
     if (future.isRunning()) return;
 
+    GC_TRACE_SPAN("RideCache::refresh");
+
     // how many need refreshing ?
     int staleCount = 0;
 
     foreach(RideItem *item, rides_) {
 
         // ok set stale so we refresh
-        if (item->checkStale())
+        if (item->checkStale()) {
+            searchIndex_->invalidate(item);
             staleCount++;
+        }
     }
 
     // start if there is work to do
@@ -678,6 +706,73 @@ RideCache::getAllFilenames()
     return returning;
 }
 
+void
+RideCache::renumber()
+{
+    for (int i=0; i<rides_.count(); i++) rides_[i]->index = i;
+    generation_++;
+}
+
+int
+RideCache::indexOf(RideItem *item)
+{
+    // items know where they are, unless they aren't ours
+    if (item->index >= 0 && item->index < rides_.count() && rides_[item->index] == item) return item->index;
+
+    // the list is sorted by date, so find the first ride at the
+    // same time and then step over any that share it
+    QVector<RideItem*>::iterator i = std::lower_bound(rides_.begin(), rides_.end(), item, rideCacheLessThan);
+    for (; i != rides_.end() && (*i)->dateTime == item->dateTime; i++)
+        if (*i == item) return i - rides_.begin();
+
+    // not found (or list out of order), fall back to a search
+    return rides_.indexOf(item);
+}
+
+QVector<RideItem*>
+RideCache::getWindow(RideItem *item, int n, bool days)
+{
+    QVector<RideItem*> returning;
+
+    int index = indexOf(item);
+    if (index < 0 || n <= 0) return returning;
+
+    // walk back to the start of the window
+    int from = index;
+    while (from > 0) {
+        if (days && rides_[from-1]->dateTime.daysTo(item->dateTime) > n) break;
+        if (!days && index - from >= n) break;
+        from--;
+    }
+
+    // and take a contiguous copy
+    returning = rides_.mid(from, index-from);
+    return returning;
+}
+
+QVector<double>
+RideCache::getMetricWindow(const QVector<RideItem*> &window, int index, bool useMetricUnits)
+{
+    QVector<double> returning(window.count(), 0.0);
+
+    const RideMetricFactory &factory = RideMetricFactory::instance();
+    if (index < 0 || index >= factory.metricCount()) return returning;
+
+    // resolve the metric once for unit conversion, value(v, metric)
+    // is const so we don't need the setValue hack in RideItem
+    const RideMetric *m = factory.rideMetric(factory.metricName(index));
+
+    for (int i=0; i<window.count(); i++) {
+        const QVector<double> &metrics = window[i]->metrics();
+        if (index >= metrics.count()) continue; // not computed yet
+
+        double value = metrics[index];
+        if (std::isinf(value) || std::isnan(value)) value = 0;
+        returning[i] = m->value(value, useMetricUnits);
+    }
+    return returning;
+}
+
 RideItem *
 RideCache::getRide(QString filename)
 {
@@ -44,6 +44,11 @@ class AthleteBest;
 class RideCacheModel;
 class Estimator;
 class Banister;
+class SearchIndex;
+
+// for sorting, in date order
+extern bool rideCacheGreaterThan(const RideItem *a, const RideItem *b);
+extern bool rideCacheLessThan(const RideItem *a, const RideItem *b);
 
 class RideCache : public QObject
 {
@@ -57,6 +62,9 @@ class RideCache : public QObject
         // table models
         RideCacheModel *model() { return model_; }
 
+        // free text search over metadata and intervals
+        SearchIndex *searchIndex() { return searchIndex_; }
+
         // query the cache
         int count() const { return rides_.count(); }
         RideItem *getRide(QString filename);
@@ -64,6 +72,20 @@ class RideCache : public QObject
 	    QList<QDateTime> getAllDates();
         QStringList getAllFilenames();
 
+        // position in the ride list
+        int indexOf(RideItem *item);
+
+        // bumped whenever ride positions change, so anything
+        // indexed by position (e.g. filter bitmaps) can be rebuilt
+        int generation() const { return generation_; }
+
+        // rides preceding item, oldest first; either those within the last
+        // n days or the last n rides. O(n) in the size of the window.
+        QVector<RideItem*> getWindow(RideItem *item, int n, bool days=true);
+
+        // values of a metric, by index, across a window of rides
+        QVector<double> getMetricWindow(const QVector<RideItem*> &window, int index, bool useMetricUnits=true);
+
         // get an aggregate applying the passed spec
         QString getAggregate(QString name, Specification spec, bool useMetricUnits, bool nofmt=false);
 
@@ -133,6 +155,9 @@ class RideCache : public QObject
 
     protected:
 
+        // set item positions after the list changes
+        void renumber();
+
         friend class ::Athlete;
         friend class ::MainWindow; // save dialog
         friend class ::RideCacheBackgroundRefresh;
@@ -144,6 +169,8 @@ class RideCache : public QObject
 
         QVector<RideItem*> rides_, reverse_, delete_;
         RideCacheModel *model_;
+        SearchIndex *searchIndex_;
+        int generation_;
         bool exiting;
 	    double progress_; // percent
 
@@ -25,6 +25,9 @@
 
 #include "RideCacheModel.h"
 
+#include <QRegExp>
+#include <algorithm>
+
 RideCacheModel::RideCacheModel(Context *context, RideCache *cache) : QAbstractTableModel(cache), context(context), rideCache(cache)
 {
     factory = &RideMetricFactory::instance();
@@ -62,14 +65,35 @@ RideCacheModel::flags(const QModelIndex &index) const
 QVariant 
 RideCacheModel::data(const QModelIndex &index, int role) const
 {
-    Q_UNUSED(role);
-
     if (!index.isValid() || index.row() < 0 || index.row() >= rideCache->count() ||
         index.column() < 0 || index.column() >= columns_) return QVariant();
 
-    RideItem *item = rideCache->rides()[index.row()];
+    int row = index.row();
+    int column = index.column();
+    int rows = rideCache->count();
 
-    switch (index.column()) {
+    // where it goes when the column is sorted
+    if (role == SortRole) {
+        if (ranks.count() != columns_) ranks.resize(columns_);
+        if (ranks[column].count() != rows) ranks[column] = rank(column);
+        return ranks[column][row];
+    }
+
+    // formatting is expensive, and the navigator asks
+    // for the same cells over and over as it paints
+    if (cells.count() != columns_) cells.resize(columns_);
+    QVector<QVariant> &values = cells[column];
+    if (values.count() != rows) values.fill(QVariant(), rows);
+    if (!values[row].isValid()) values[row] = cell(row, column);
+    return values[row];
+}
+
+QVariant
+RideCacheModel::cell(int row, int column) const
+{
+    RideItem *item = rideCache->rides()[row];
+
+    switch (column) {
         case 0 : return item->path;
         case 1 : return item->fileName;
         case 2 : return item->dateTime;
@@ -81,10 +105,10 @@ RideCacheModel::data(const QModelIndex &index, int role) const
         {
             // from here we're either a metric or meta
             // lets work that out ...
-            if (index.column()-5 < factory->metricCount()) {
+            if (column-5 < factory->metricCount()) {
 
                 // is a metric
-                int i=index.column()-5;
+                int i=column-5;
 
                 // unpack metric value into ridemetric and use it to get a stringified
                 // version using the right metric/imperial conversion
@@ -95,15 +119,15 @@ RideCacheModel::data(const QModelIndex &index, int role) const
                 // but not if high precision, which means
                 // metrics with high precision don't sort this is crap XXX
                 if (m->isTime()) {
-                    return QTime(0,0,0).addSecs(rideCache->rides().at(index.row())->metrics_[m->index()]);
+                    return QTime(0,0,0).addSecs(rideCache->rides().at(row)->metrics_[m->index()]);
                 } else if (m->units(true) != "km" && m->precision() > 0) {
-                    m->setValue(rideCache->rides().at(index.row())->metrics_[m->index()]);
+                    m->setValue(rideCache->rides().at(row)->metrics_[m->index()]);
                     return m->toString(context->athlete->useMetricUnits); // string
                 } else {
 
                     // make low precision numbers sort, including distance which we picked
                     // up as a special case. not sure about pace ....
-                    double value = rideCache->rides().at(index.row())->metrics_[m->index()];
+                    double value = rideCache->rides().at(row)->metrics_[m->index()];
 
                     // convert to imperial if needed
                     if (context->athlete->useMetricUnits == false) 
@@ -115,19 +139,98 @@ RideCacheModel::data(const QModelIndex &index, int role) const
             } else {
 
                 // is a metadata
-                int i = index.column() -5 - factory->metricCount();
+                int i = column -5 - factory->metricCount();
                 return item->getText(metadata[i].name, "");
             }
         }
     }
 }
 
+// sort keys for rank(), numbers sort before text
+struct RideCacheModelKey {
+    int row;
+    bool numeric;
+    double number;
+    QString text;
+};
+
+static bool
+rideCacheModelLessThan(const RideCacheModelKey &left, const RideCacheModelKey &right)
+{
+    if (left.numeric != right.numeric) return left.numeric;
+    if (left.numeric) return left.number < right.number;
+    return QString::localeAwareCompare(left.text, right.text) < 0;
+}
+
+QVector<int>
+RideCacheModel::rank(int column) const
+{
+    // sort a copy of the values, a background refresh can change them
+    // while we sort and the sort needs them to stay put; ties stay in
+    // ride order so the result is the same every time
+    int rows = rideCache->count();
+    QVector<RideCacheModelKey> keys(rows);
+
+    if (column > 5 && column-5 < factory->metricCount()) {
+
+        // metrics sort by value, conversions don't change the order
+        const RideMetric *m = factory->rideMetric(factory->metricName(column-5));
+        for (int i=0; i<rows; i++) {
+            keys[i].row = i;
+            keys[i].numeric = true;
+            keys[i].number = rideCache->rides().at(i)->metrics_.value(m->index());
+        }
+
+    } else if (column == 2) {
+
+        // ride date
+        for (int i=0; i<rows; i++) {
+            keys[i].row = i;
+            keys[i].numeric = true;
+            keys[i].number = rideCache->rides().at(i)->dateTime.toMSecsSinceEpoch();
+        }
+
+    } else {
+
+        // text, but numbers as numbers
+        QRegExp alpha("[^0-9.,]");
+        for (int i=0; i<rows; i++) {
+            keys[i].row = i;
+            keys[i].text = data(index(i, column)).toString();
+            keys[i].numeric = !keys[i].text.contains(alpha);
+            keys[i].number = keys[i].numeric ? keys[i].text.toDouble() : 0;
+        }
+    }
+
+    std::stable_sort(keys.begin(), keys.end(), rideCacheModelLessThan);
+
+    QVector<int> returning(rows);
+    for (int k=0; k<rows; k++) returning[keys[k].row] = k;
+    return returning;
+}
+
+void
+RideCacheModel::invalidate(int row)
+{
+    // any change can move every rank
+    ranks.clear();
+
+    if (row < 0) {
+        cells.clear();
+        return;
+    }
+
+    for (int c=0; c<cells.count(); c++)
+        if (row < cells[c].count()) cells[c][row] = QVariant();
+}
+
 void
 RideCacheModel::itemChanged(RideItem *item)
 {
     // ok so lets signal that
-    int row = rideCache->rides().indexOf(item);
-    if (row >= 0 && row <= rideCache->count()) {
+    int row = rideCache->indexOf(item);
+    if (row >= 0 && row < rideCache->count()) {
+        invalidate(row);
         emit dataChanged(createIndex(row,0), createIndex(row,columns_-1));
     }
     //XXX hack to get the navigator to redraw
@@ -135,7 +238,7 @@ RideCacheModel::itemChanged(RideItem *item)
 }
 
 void RideCacheModel::beginReset() { beginResetModel(); }
-void RideCacheModel::endReset() { endResetModel(); }
+void RideCacheModel::endReset() { invalidate(); endResetModel(); }
 
 void 
 RideCacheModel::itemAdded(RideItem*)
@@ -154,6 +257,7 @@ RideCacheModel::startRemove(int index)
 void
 RideCacheModel::endRemove(int)
 {
+    invalidate();
     endRemoveRows();
 }
 
@@ -189,6 +293,9 @@ RideCacheModel::configChanged(qint32)
     // get field config
     metadata = context->athlete->rideMetadata()->getFields();
 
+    // units or fields may have changed
+    invalidate();
+
     // set new column count
     // 0    QString path;
     // 1    QString fileName;
@@ -241,6 +348,8 @@ RideCacheModel::configChanged(qint32)
 void 
 RideCacheModel::refreshUpdate(QDate)
 {
+    // metrics are being recomputed in the background
+    invalidate();
 }
 
 void 
@@ -251,4 +360,5 @@ RideCacheModel::refreshStart()
 void 
 RideCacheModel::refreshEnd()
 {
+    invalidate();
 }
@@ -40,6 +40,10 @@ class RideCacheModel : public QAbstractTableModel
     public:
         RideCacheModel(Context *, RideCache *);
 
+        // the position of a cell when its column is sorted, as an int,
+        // so proxies can sort any column without looking at the values
+        enum { SortRole = Qt::UserRole + 10 };
+
         // must reimplement these
         int rowCount(const QModelIndex &parent = QModelIndex()) const; 
         int columnCount(const QModelIndex &parent = QModelIndex()) const;
@@ -71,10 +75,21 @@ class RideCacheModel : public QAbstractTableModel
         void endRemove(int);
 
     private:
+        QVariant cell(int row, int column) const;
+        QVector<int> rank(int column) const;
+
+        // forget cached cells and ranks, for a row or all of them
+        void invalidate(int row=-1);
+
         Context *context;
         RideCache *rideCache;
         RideMetricFactory *factory;
 
+        // formatted display values and sort positions, [column][row]
+        // filled as they are asked for, empty when not known yet
+        mutable QVector<QVector<QVariant> > cells;
+        mutable QVector<QVector<int> > ranks;
+
         int columns_; // column count, based upon metric + meta config
         QStringList headings_;
 
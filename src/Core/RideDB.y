@@ -90,8 +90,8 @@ ride: '{' rideelement_list '}'                                  {
 
                                                                                 found = true;
 
-                                                                                // progress update
-                                                                                if (jc->context->mainWindow->progress) {
+                                                                                // progress update, there's no mainwindow when headless
+                                                                                if (jc->context->mainWindow && jc->context->mainWindow->progress) {
 
                                                                                     // percentage progress
                                                                                     QString m = QString("%1%")
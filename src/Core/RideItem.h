@@ -28,6 +28,7 @@
 #include <QString>
 #include <QMap>
 #include <QVector>
+#include <QAtomicInt>
 
 class RideFile;
 class RideFileCache;
@@ -102,6 +103,7 @@ class RideItem : public QObject
         bool isstale;     // metric data is out of date and needs recomputing
         bool isedit;      // is being edited at the moment
         bool skipsave;    // on exit we don't save the state to force rebuild at startup
+        int index;        // position in the ride cache, -1 if not in it
 
         // set from another, e.g. during load of rideDB.json
         void setFrom(RideItem&, bool temp=false);
@@ -154,6 +156,7 @@ class RideItem : public QObject
         int dbversion; // metric version
         int udbversion; // user metric version
         double weight; // what weight was used ?
+        int revision; // changes whenever the metrics do, for caches of them
 
         // access to the cached data !
         BodyMeasure weightData;
@@ -220,6 +223,9 @@ class RideItem : public QObject
 
     private:
         void updateIntervals();
+        void newRevision();
+
+        static QAtomicInt revisions; // unique across all items
 };
 
 #endif // _GC_RideItem_h
@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "RollingStats.h"
+
+#include <algorithm>
+#include <cmath>
+
+//
+// RollingMedian
+//
+void
+RollingMedian::add(double value)
+{
+    if (low.empty() || value <= low.top()) {
+        low.push(value);
+        lowCount++;
+    } else {
+        high.push(value);
+        highCount++;
+    }
+    balance();
+}
+
+void
+RollingMedian::remove(double value)
+{
+    removed[value]++;
+
+    // which half is it in, equal to the low top may be
+    // in either but they are interchangeable
+    if (!low.empty() && value <= low.top()) lowCount--;
+    else highCount--;
+
+    prune();
+    balance();
+}
+
+double
+RollingMedian::median() const
+{
+    if (lowCount == 0) return 0;
+    if (lowCount > highCount) return low.top();
+    return (low.top() + high.top()) / 2.0;
+}
+
+void
+RollingMedian::balance()
+{
+    // low has the same number or one more than high
+    if (lowCount > highCount + 1) {
+        high.push(low.top());
+        low.pop();
+        lowCount--;
+        highCount++;
+    } else if (lowCount < highCount) {
+        low.push(high.top());
+        high.pop();
+        highCount--;
+        lowCount++;
+    }
+    prune();
+}
+
+// drop removed values from the tops of the heaps
+template<class T> static void
+pruneHeap(T &heap, std::map<double,int> &removed)
+{
+    while (!heap.empty()) {
+        std::map<double,int>::iterator it = removed.find(heap.top());
+        if (it == removed.end()) return;
+        if (--(it->second) == 0) removed.erase(it);
+        heap.pop();
+    }
+}
+
+void
+RollingMedian::prune()
+{
+    pruneHeap(low, removed);
+    pruneHeap(high, removed);
+}
+
+//
+// RollingStats
+//
+void
+RollingStats::median(const double *in, int n, int window, double *out)
+{
+    if (window < 1) window = 1;
+
+    RollingMedian rolling;
+    for (int i=0; i<n; i++) {
+        rolling.add(in[i]);
+        if (i >= window) rolling.remove(in[i-window]);
+        out[i] = rolling.median();
+    }
+}
+
+void
+RollingStats::mad(const double *in, int n, int window, double *out)
+{
+    if (window < 1) window = 1;
+
+    // the deviations depend on the median of each window so they
+    // can't be rolled, but a selection is still cheaper than a sort
+    QVector<double> medians(n);
+    median(in, n, window, medians.data());
+
+    std::vector<double> deviations;
+    deviations.reserve(window);
+    for (int i=0; i<n; i++) {
+        int from = i < window ? 0 : i-window+1;
+        deviations.clear();
+        for (int j=from; j<=i; j++) deviations.push_back(fabs(in[j] - medians[i]));
+
+        int half = deviations.size() / 2;
+        std::nth_element(deviations.begin(), deviations.begin() + half, deviations.end());
+        double value = deviations[half];
+        if (deviations.size() % 2 == 0) {
+            // even, average with the largest of the lower half
+            value = (value + *std::max_element(deviations.begin(), deviations.begin() + half)) / 2.0;
+        }
+        out[i] = value;
+    }
+}
+
+QVector<double>
+RollingStats::median(const QVector<double> &in, int window)
+{
+    QVector<double> returning(in.count());
+    median(in.constData(), in.count(), window, returning.data());
+    return returning;
+}
+
+QVector<double>
+RollingStats::mad(const QVector<double> &in, int window)
+{
+    QVector<double> returning(in.count());
+    mad(in.constData(), in.count(), window, returning.data());
+    return returning;
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _GC_RollingStats_h
+#define _GC_RollingStats_h 1
+
+#include <QVector>
+#include <queue>
+#include <vector>
+#include <map>
+#include <functional>
+
+//
+// Median of a sliding window, kept as two heaps; the lower half in a max
+// heap and the upper half in a min heap. Values leaving the window are
+// only removed when they reach the top of a heap, so add and remove are
+// both O(log window).
+//
+class RollingMedian
+{
+    public:
+        RollingMedian() : lowCount(0), highCount(0) {}
+
+        void add(double value);
+        void remove(double value); // must have been added
+        double median() const;
+        int count() const { return lowCount + highCount; }
+
+    private:
+        void balance();
+        void prune();
+
+        std::priority_queue<double> low;
+        std::priority_queue<double, std::vector<double>, std::greater<double> > high;
+        std::map<double, int> removed;  // waiting to reach the top
+        int lowCount, highCount;        // excluding removed
+};
+
+//
+// Moving window statistics on contiguous arrays, for smooth() in formulas.
+//
+// All windows are trailing; out[i] covers in[i-window+1] .. in[i],
+// at the start of the series the window is whatever is available.
+// The out array must be n long and can't be the in array.
+//
+namespace RollingStats
+{
+    void median(const double *in, int n, int window, double *out);
+
+    // median absolute deviation from the window median
+    void mad(const double *in, int n, int window, double *out);
+
+    // convenience for QVectors
+    QVector<double> median(const QVector<double> &in, int window);
+    QVector<double> mad(const QVector<double> &in, int window);
+};
+
+#endif
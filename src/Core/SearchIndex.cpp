@@ -0,0 +1,216 @@
+/*
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "SearchIndex.h"
+#include "RideCache.h"
+#include "RideItem.h"
+#include "IntervalItem.h"
+
+SearchIndex::SearchIndex(RideCache *cache) : QObject(cache), cache(cache), all(true), rebuild(false)
+{
+    // built lazily on first search
+}
+
+QStringList
+SearchIndex::words(QString text)
+{
+    QStringList returning;
+    QString current;
+
+    // words are runs of letters and numbers, everything
+    // else is a separator
+    text = text.toCaseFolded();
+    for (int i=0; i<text.length(); i++) {
+        if (text[i].isLetterOrNumber()) {
+            current += text[i];
+        } else if (current != "") {
+            returning << current;
+            current = "";
+        }
+    }
+    if (current != "") returning << current;
+
+    return returning;
+}
+
+void
+SearchIndex::invalidate(RideItem *item)
+{
+    if (item && !all) dirty.insert(item);
+}
+
+void
+SearchIndex::invalidateAll()
+{
+    all = true;
+    dirty.clear();
+    rebuild = false;
+    refreshing.clear();
+}
+
+void
+SearchIndex::remove(RideItem *item)
+{
+    dirty.remove(item);
+    refreshing.remove(item);
+    unindex(item);
+}
+
+void
+SearchIndex::refreshEnd()
+{
+    if (rebuild) invalidateAll();
+    else {
+        foreach(RideItem *item, refreshing) invalidate(item);
+        refreshing.clear();
+    }
+}
+
+void
+SearchIndex::unindex(RideItem *item)
+{
+    QHash<RideItem*, QStringList>::iterator it = indexed.find(item);
+    if (it == indexed.end()) return;
+
+    foreach(QString word, it.value()) {
+        QMap<QString, QSet<RideItem*> >::iterator p = postings.find(word);
+        if (p != postings.end()) {
+            p.value().remove(item);
+            if (p.value().isEmpty()) postings.erase(p);
+        }
+    }
+    indexed.erase(it);
+}
+
+void
+SearchIndex::index(RideItem *item)
+{
+    unindex(item);
+
+    QSet<QString> unique;
+    QMapIterator<QString,QString> meta(item->metadata());
+    while (meta.hasNext()) {
+        meta.next();
+        foreach(QString word, words(meta.value())) unique.insert(word);
+    }
+
+    // user intervals - even autodiscovered
+    foreach(IntervalItem *interval, item->intervals())
+        foreach(QString word, words(interval->name)) unique.insert(word);
+
+    QStringList list = unique.toList();
+    foreach(QString word, list) postings[word].insert(item);
+    indexed.insert(item, list);
+}
+
+void
+SearchIndex::update()
+{
+    // items still being refreshed in the background may change
+    // again, so remember them for when the refresh ends
+    bool running = cache->isRunning();
+
+    if (all) {
+        postings.clear();
+        indexed.clear();
+        foreach(RideItem *item, cache->rides()) index(item);
+        all = false;
+        rebuild = running;
+        return;
+    }
+
+    foreach(RideItem *item, dirty) index(item);
+    if (running) refreshing.unite(dirty);
+    dirty.clear();
+}
+
+QSet<RideItem*>
+SearchIndex::matching(QString fragment) const
+{
+    QSet<RideItem*> returning;
+
+    // words starting with the fragment are contiguous in the
+    // dictionary so find them with a binary search first
+    QMap<QString, QSet<RideItem*> >::const_iterator it = postings.lowerBound(fragment);
+    QMap<QString, QSet<RideItem*> >::const_iterator prefixEnd = it;
+    while (prefixEnd != postings.constEnd() && prefixEnd.key().startsWith(fragment)) {
+        returning.unite(prefixEnd.value());
+        prefixEnd++;
+    }
+
+    // then any word containing it elsewhere, this scans the
+    // dictionary which grows far slower than the ride count
+    for (QMap<QString, QSet<RideItem*> >::const_iterator i = postings.constBegin(); i != postings.constEnd(); i++) {
+        if (i == it) { i = prefixEnd; if (i == postings.constEnd()) break; }
+        if (i.key().contains(fragment)) returning.unite(i.value());
+    }
+    return returning;
+}
+
+bool
+SearchIndex::contains(RideItem *item, QString token)
+{
+    QMapIterator<QString,QString> meta(item->metadata());
+    while (meta.hasNext()) {
+        meta.next();
+        if (meta.value().contains(token, Qt::CaseInsensitive)) return true;
+    }
+    foreach(IntervalItem *interval, item->intervals())
+        if (interval->name.contains(token, Qt::CaseInsensitive)) return true;
+
+    return false;
+}
+
+QList<RideItem*>
+SearchIndex::search(QStringList tokens)
+{
+    update();
+
+    QSet<RideItem*> found;
+    foreach(QString token, tokens) {
+
+        QStringList parts = words(token);
+
+        // no letters or numbers at all, so we can't use the index
+        if (parts.isEmpty()) {
+            foreach(RideItem *item, cache->rides())
+                if (contains(item, token)) found.insert(item);
+            continue;
+        }
+
+        // a single word can only ever match inside a single indexed
+        // word, so the dictionary lookup is exact
+        QSet<RideItem*> candidates = matching(parts[0]);
+        if (parts.count() == 1 && parts[0] == token.toCaseFolded()) {
+            found.unite(candidates);
+            continue;
+        }
+
+        // phrases and punctuation; narrow down with each word and
+        // then check what is left against the original text
+        for (int i=1; i<parts.count() && !candidates.isEmpty(); i++)
+            candidates.intersect(matching(parts[i]));
+
+        foreach(RideItem *item, candidates)
+            if (!found.contains(item) && contains(item, token)) found.insert(item);
+    }
+
+    QList<RideItem*> returning = found.toList();
+    qSort(returning.begin(), returning.end(), rideCacheLessThan);
+    return returning;
+}
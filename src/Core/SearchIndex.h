@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _GC_SearchIndex_h
+#define _GC_SearchIndex_h 1
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QMap>
+#include <QHash>
+#include <QSet>
+#include <QList>
+
+class RideCache;
+class RideItem;
+
+//
+// Inverted index over the free text attached to each ride in the ride
+// cache; metadata values and interval names.
+//
+// Each text is split into words that are case folded and posted against
+// the rides that contain them. The word dictionary is kept sorted so a
+// query can find all words sharing a prefix with a binary search, and
+// since a query word must always fall within a single indexed word we
+// only ever need to look at the dictionary, not the rides themselves.
+//
+// The index is maintained incrementally; the ride cache marks items as
+// dirty when they change and the dirty items are re-indexed the next
+// time a search is run. Items being refreshed in the background are
+// indexed as they are when searched and once more after the refresh
+// ends, rather than on every search while it runs. All access is from
+// the GUI thread.
+//
+class SearchIndex : public QObject
+{
+    Q_OBJECT
+
+    public:
+
+        SearchIndex(RideCache *cache);
+
+        // rides that contain any of the tokens, in ride cache order
+        QList<RideItem*> search(QStringList tokens);
+
+        // split text into case folded words, as used for indexing
+        static QStringList words(QString text);
+
+    public slots:
+
+        // mark for re-indexing at next search
+        void invalidate(RideItem *item);
+        void invalidateAll();
+
+        // forget about an item, it is about to be deleted
+        void remove(RideItem *item);
+
+        // the background refresh finished, pick up its changes
+        void refreshEnd();
+
+    private:
+
+        // bring the index up to date
+        void update();
+        void index(RideItem *item);
+        void unindex(RideItem *item);
+
+        // rides with a word containing the passed fragment
+        QSet<RideItem*> matching(QString fragment) const;
+
+        // brute force check, used to verify multi-word tokens
+        static bool contains(RideItem *item, QString token);
+
+        RideCache *cache;
+
+        bool all;                               // full rebuild needed
+        QSet<RideItem*> dirty;                  // items to re-index
+
+        bool rebuild;                           // rebuilt during a refresh
+        QSet<RideItem*> refreshing;             // re-indexed during a refresh
+
+        QMap<QString, QSet<RideItem*> > postings; // word -> rides
+        QHash<RideItem*, QStringList> indexed;    // ride -> words
+};
+#endif
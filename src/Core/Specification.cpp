@@ -20,6 +20,80 @@
 #include "RideItem.h"
 #include "IntervalItem.h"
 #include "RideFile.h"
+#include "RideCache.h"
+#include "Athlete.h"
+#include "Context.h"
+
+void
+FilterSet::addFilter(bool on, QStringList list)
+{
+    if (!on) return;
+
+    // copy on write, the bitmap gets built again when needed
+    QSharedPointer<Filters> update(new Filters);
+    if (filters_) update->sets = filters_->sets;
+    update->sets << list.toSet();
+    filters_ = update;
+}
+
+bool
+FilterSet::pass(QString name) const
+{
+    if (!filters_) return true;
+
+    for(int i=0; i<filters_->sets.count(); i++)
+        if (!filters_->sets[i].contains(name))
+            return false;
+    return true;
+}
+
+bool
+FilterSet::pass(RideItem *item) const
+{
+    if (!filters_ || filters_->sets.isEmpty()) return true;
+
+    // not in the cache, e.g. a temporary item
+    RideCache *cache = (item->context && item->context->athlete) ? item->context->athlete->rideCache : NULL;
+    if (!cache || item->index < 0 || item->index >= cache->count() || cache->rides()[item->index] != item)
+        return pass(item->fileName);
+
+    return bitmap(cache)->test(item->index);
+}
+
+QSharedPointer<const RideBitmap>
+FilterSet::bitmap(RideCache *cache) const
+{
+    if (!filters_) return QSharedPointer<const RideBitmap>();
+
+    QMutexLocker locker(&filters_->lock);
+
+    // still good, nothing moved
+    if (filters_->bitmap && filters_->cache == cache && filters_->generation == cache->generation())
+        return filters_->bitmap;
+
+    // one pass over the rides for each filter, then and them together
+    const QVector<RideItem*> &rides = cache->rides();
+    RideBitmap *passed = NULL;
+    for(int f=0; f<filters_->sets.count(); f++) {
+        const QSet<QString> &set = filters_->sets[f];
+        RideBitmap matches(rides.count());
+        for(int i=0; i<rides.count(); i++)
+            if (set.contains(rides[i]->fileName)) matches.set(i);
+
+        if (passed) *passed &= matches;
+        else passed = new RideBitmap(matches);
+    }
+    if (!passed) {
+        // no filters, everything passes
+        passed = new RideBitmap(rides.count());
+        for(int i=0; i<rides.count(); i++) passed->set(i);
+    }
+
+    filters_->cache = cache;
+    filters_->generation = cache->generation();
+    filters_->bitmap = QSharedPointer<const RideBitmap>(passed);
+    return filters_->bitmap;
+}
 
 Specification::Specification(DateRange dr, FilterSet fs) : dr(dr), fs(fs), it(NULL), recintsecs(0), ri(NULL) {}
 Specification::Specification(IntervalItem *it, double recintsecs) : it(it), recintsecs(recintsecs), ri(NULL) {}
@@ -36,7 +110,7 @@ Specification::pass(QDate date)
 bool 
 Specification::pass(RideItem*item)
 {
-    return (dr.pass(item->dateTime.date()) && fs.pass(item->fileName));
+    return (dr.pass(item->dateTime.date()) && fs.pass(item));
 }
 
 bool
@@ -22,6 +22,9 @@
 #include <QString>
 #include <QStringList>
 #include <QSet>
+#include <QVector>
+#include <QMutex>
+#include <QSharedPointer>
 #include "TimeUtils.h"
 
 //
@@ -37,26 +40,62 @@ class RideFile;
 class IntervalItem;
 struct RideFilePoint;
 
-class FilterSet
+class RideCache;
+
+// a set of rides in the ride cache, as one bit for each position
+// so sets can be combined a word at a time
+class RideBitmap
 {
+    public:
+        RideBitmap(int n=0) : n(n), words((n+63)/64, 0) {}
+
+        void set(int i) { words[i>>6] |= quint64(1) << (i&63); }
+        bool test(int i) const { return i >= 0 && i < n && ((words[i>>6] >> (i&63)) & 1); }
+        int size() const { return n; }
+
+        // combine, both must be the same size
+        RideBitmap &operator&=(const RideBitmap &other) {
+            for(int i=0; i<words.count(); i++) words[i] &= other.words[i];
+            return *this;
+        }
+        RideBitmap &operator|=(const RideBitmap &other) {
+            for(int i=0; i<words.count(); i++) words[i] |= other.words[i];
+            return *this;
+        }
+
+    private:
+        int n;
+        QVector<quint64> words;
+};
 
-    // used to collect filters and apply if needed
-    QVector<QSet<QString>> filters_;
+class FilterSet
+{
+    // used to collect filters and apply if needed, the filters
+    // are shared by copies of the set so the bitmap of rides that
+    // pass is only built once for all of them
+    struct Filters {
+        Filters() : cache(NULL), generation(-1) {}
+        QVector<QSet<QString> > sets;
+
+        QMutex lock;
+        RideCache *cache;
+        int generation;
+        QSharedPointer<const RideBitmap> bitmap;
+    };
+    QSharedPointer<Filters> filters_;
 
     public:
 
         // create one with a set
         FilterSet(bool on, QStringList list) {
-            if (on) filters_ << list.toSet();
+            addFilter(on, list);
         }
 
         // create an empty set
         FilterSet() {}
 
-        // add a new filter
-        void addFilter(bool on, QStringList list) {
-            if (on) filters_ << list.toSet();
-        }
+        // add a new filter, copies no longer share with us
+        void addFilter(bool on, QStringList list);
 
         // clear the filter set
         void clear() {
@@ -64,14 +103,15 @@ class FilterSet
         }
 
         // does the name in question pass the filter set ?
-        bool pass(QString name) {
-            foreach(QSet<QString> set, filters_)
-                if (!set.contains(name))
-                    return false;
-            return true;
-        }
+        bool pass(QString name) const;
+
+        // does the ride pass, uses the bitmap for rides in the cache
+        bool pass(RideItem *item) const;
+
+        // all the rides in the cache that pass
+        QSharedPointer<const RideBitmap> bitmap(RideCache *cache) const;
 
-        int count() { return filters_.count(); }
+        int count() const { return filters_ ? filters_->sets.count() : 0; }
 };
 
 class RideFileIterator;
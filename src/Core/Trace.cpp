@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "Trace.h"
+
+#ifdef GC_WANT_TRACE
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QThreadStorage>
+#include <QThread>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QAtomicInt>
+#include <QVector>
+#include <QList>
+#include <QFile>
+#include <QTextStream>
+
+struct TraceEvent {
+    const char *name;
+    qint64 start;
+    qint64 duration;    // -1 for a counter
+    double value;
+};
+
+// events for one thread, only that thread appends but the
+// buffer is read when writing so it has its own lock (which
+// is uncontended the rest of the time)
+struct TraceBuffer {
+    TraceBuffer(int tid) : tid(tid) {}
+
+    int tid;
+    QString name;
+    QMutex lock;
+    QVector<TraceEvent> events;
+};
+
+// the buffers outlive their threads since the events are written
+// after worker threads have finished, so thread storage only holds
+// a reference to a buffer that belongs to the list below
+struct TraceThread {
+    TraceThread(TraceBuffer *buffer) : buffer(buffer) {}
+    TraceBuffer *buffer;
+};
+
+static QAtomicInt traceEnabled(0);
+static QElapsedTimer traceClock;
+static QMutex traceLock;
+static QList<TraceBuffer*> traceBuffers;
+static QThreadStorage<TraceThread*> traceThread;
+
+static TraceBuffer *
+buffer()
+{
+    if (!traceThread.hasLocalData()) {
+        QMutexLocker locker(&traceLock);
+        TraceBuffer *add = new TraceBuffer(traceBuffers.count() + 1);
+        if (QCoreApplication::instance() && QThread::currentThread() == QCoreApplication::instance()->thread())
+            add->name = "GUI";
+        traceBuffers << add;
+        traceThread.setLocalData(new TraceThread(add));
+    }
+    return traceThread.localData()->buffer;
+}
+
+void
+Trace::enable(bool on)
+{
+    QMutexLocker locker(&traceLock);
+    if (on && !traceClock.isValid()) traceClock.start();
+    traceEnabled.store(on ? 1 : 0);
+}
+
+bool
+Trace::isEnabled()
+{
+    return traceEnabled.load() != 0;
+}
+
+qint64
+Trace::now()
+{
+    return traceClock.nsecsElapsed() / 1000;
+}
+
+void
+Trace::span(const char *name, qint64 start, qint64 duration)
+{
+    TraceBuffer *b = buffer();
+    TraceEvent add = { name, start, duration, 0 };
+
+    QMutexLocker locker(&b->lock);
+    b->events << add;
+}
+
+void
+Trace::counter(const char *name, double value)
+{
+    TraceBuffer *b = buffer();
+    TraceEvent add = { name, now(), -1, value };
+
+    QMutexLocker locker(&b->lock);
+    b->events << add;
+}
+
+void
+Trace::setThreadName(QString name)
+{
+    TraceBuffer *b = buffer();
+
+    QMutexLocker locker(&b->lock);
+    b->name = name;
+}
+
+static QString
+escaped(QString text)
+{
+    return text.replace("\\", "\\\\").replace("\"", "\\\"");
+}
+
+bool
+Trace::write(QString filename)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) return false;
+
+    QTextStream out(&file);
+    out.setCodec("UTF-8");
+
+    qint64 pid = QCoreApplication::applicationPid();
+    bool first = true;
+
+    out << "{\"traceEvents\":[\n";
+
+    QMutexLocker locker(&traceLock);
+    foreach (TraceBuffer *b, traceBuffers) {
+        QMutexLocker bufferLocker(&b->lock);
+
+        // metadata so the threads have names in the viewer
+        if (!first) out << ",\n";
+        first = false;
+        QString name = b->name.isEmpty() ? QString("Thread %1").arg(b->tid) : b->name;
+        out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid << ",\"tid\":" << b->tid
+            << ",\"args\":{\"name\":\"" << escaped(name) << "\"}}";
+
+        foreach (const TraceEvent &e, b->events) {
+            out << ",\n";
+            if (e.duration >= 0) {
+                out << "{\"name\":\"" << escaped(e.name) << "\",\"ph\":\"X\",\"pid\":" << pid
+                    << ",\"tid\":" << b->tid << ",\"ts\":" << e.start << ",\"dur\":" << e.duration << "}";
+            } else {
+                out << "{\"name\":\"" << escaped(e.name) << "\",\"ph\":\"C\",\"pid\":" << pid
+                    << ",\"tid\":" << b->tid << ",\"ts\":" << e.start
+                    << ",\"args\":{\"value\":" << e.value << "}}";
+            }
+        }
+    }
+    out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+    out.flush();
+    file.close();
+    return file.error() == QFile::NoError;
+}
+
+#endif
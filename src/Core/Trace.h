@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _GC_Trace_h
+#define _GC_Trace_h 1
+
+//
+// Tracing of the hot paths; where the time goes when opening an athlete,
+// refreshing rides, switching charts or riding in train view.
+//
+// Spans are scoped, they start where the macro is and end when the
+// enclosing block exits. Counters record a value at a point in time.
+//
+//     GC_TRACE_SPAN("RideItem::refresh");
+//     GC_TRACE_COUNTER("RideCache::progress", progress);
+//
+// Worker threads are numbered unless they name themselves first.
+//
+//     GC_TRACE_THREAD("Estimator");
+//
+// Names must be string literals (or otherwise live for the life of the
+// program) since only the pointer is kept. Events go into a buffer per
+// thread so recording doesn't contend, and are written out as Chrome
+// trace json that chrome://tracing or https://ui.perfetto.dev can open.
+//
+// It is only compiled in when GC_WANT_TRACE is defined in gcconfig.pri,
+// otherwise the macros are empty. When compiled in nothing is recorded
+// until it is enabled, typically by running with --trace=file.json.
+//
+
+#ifdef GC_WANT_TRACE
+
+#include <QString>
+#include <QtGlobal>
+
+namespace Trace
+{
+    // start recording, and stop (the events are kept until written)
+    void enable(bool on=true);
+    bool isEnabled();
+
+    // microseconds since tracing was first enabled
+    qint64 now();
+
+    // record a completed span or a counter value on this thread
+    void span(const char *name, qint64 start, qint64 duration);
+    void counter(const char *name, double value);
+
+    // name this thread in the trace, otherwise threads are numbered
+    void setThreadName(QString name);
+
+    // write everything recorded so far as Chrome trace json
+    bool write(QString filename);
+};
+
+class TraceSpan
+{
+    public:
+        TraceSpan(const char *name) : name(name), start(Trace::isEnabled() ? Trace::now() : -1) {}
+        ~TraceSpan() { if (start >= 0) Trace::span(name, start, Trace::now() - start); }
+
+    private:
+        const char *name;
+        qint64 start;
+};
+
+#define GC_TRACE_CONCAT2(a, b) a ## b
+#define GC_TRACE_CONCAT(a, b) GC_TRACE_CONCAT2(a, b)
+#define GC_TRACE_SPAN(name) TraceSpan GC_TRACE_CONCAT(traceSpan, __LINE__)(name)
+#define GC_TRACE_COUNTER(name, value) do { if (Trace::isEnabled()) Trace::counter(name, value); } while(0)
+#define GC_TRACE_THREAD(name) do { if (Trace::isEnabled()) Trace::setThreadName(name); } while(0)
+
+#else
+
+#define GC_TRACE_SPAN(name) do {} while(0)
+#define GC_TRACE_COUNTER(name, value) do {} while(0)
+#define GC_TRACE_THREAD(name) do {} while(0)
+
+#endif
+#endif
@@ -28,11 +28,18 @@
 #include "IdleTimer.h"
 #include "PowerProfile.h"
 #include "GcCrashDialog.h" // for versionHTML
+#include "TrainSimulator.h"
+#include "Benchmark.h"
+#include "CacheRebuild.h"
+#include "Trace.h"
 
 #include <QApplication>
 #include <QDesktopWidget>
 #include <QtGui>
 #include <QFile>
+#include <QTemporaryDir>
+#include <QThreadPool>
+#include <QElapsedTimer>
 #ifndef NOWEBKIT
 #include <QWebSettings>
 #endif
@@ -66,6 +73,9 @@
 bool restarting = false;
 static bool nogui;
 static int gc_opened=0;
+#ifdef GC_WANT_TRACE
+static QString traceFile;
+#endif
 
 //
 // global application
@@ -91,6 +101,11 @@ RTool *rtool = NULL;
 //
 void terminate(int code)
 {
+#ifdef GC_WANT_TRACE
+    // exit won't come back to main
+    if (traceFile != "") Trace::write(traceFile);
+#endif
+
 #ifdef GC_WANT_HTTP
     if (listener) listener->close();
 #endif
@@ -204,6 +219,15 @@ main(int argc, char *argv[])
     nogui = false;
     bool help = false;
     bool newgui = false;
+    bool trainsim = false;
+    QString simWorkout, simReplay;
+    double simSpeedup = 0;
+    int simResponse = 0;
+    bool bench = false;
+    QString benchSamples, benchOutput;
+    int benchIterations = 5;
+    bool rebuild = false, rebuildFull = false;
+    int threads = 0;
 
     // honour command line switches
     foreach (QString arg, sargs) {
@@ -223,6 +247,21 @@ main(int argc, char *argv[])
             fprintf(stderr, "--help or --usage   to print this message and exit\n");
             fprintf(stderr, "--version           to print detailed version information and exit\n");
             fprintf(stderr, "--newgui            to open the new gui (WIP)\n");
+            fprintf(stderr, "--trainsim          to ride a simulated trainer headless and report timings\n");
+            fprintf(stderr, "  --workout=file    workout to ride (default ergo at 200w)\n");
+            fprintf(stderr, "  --replay=file     recorded activity to replay as the rider\n");
+            fprintf(stderr, "  --speedup=n       1 for real time, 0 as fast as possible (default)\n");
+            fprintf(stderr, "  --response=ms     trainer response time (default 0)\n");
+            fprintf(stderr, "--bench             to time opening, refreshing and analysing activities headless\n");
+            fprintf(stderr, "  --samples=dir     sample files to open, imported if no athlete is passed\n");
+            fprintf(stderr, "  --iterations=n    times to run each stage (default 5)\n");
+            fprintf(stderr, "  --output=file     write the json results to file instead of stdout\n");
+            fprintf(stderr, "--rebuild           to bring the athlete's caches up to date headless and exit\n");
+            fprintf(stderr, "  --full            rebuild all of them, not just those out of date\n");
+            fprintf(stderr, "  --threads=n       refresh threads (default one per core)\n");
+#ifdef GC_WANT_TRACE
+            fprintf(stderr, "--trace=file        to record where the time goes as chrome trace json\n");
+#endif
 #ifdef GC_WANT_HTTP
             fprintf(stderr, "--server            to run as an API server\n");
 #endif
@@ -256,6 +295,51 @@ main(int argc, char *argv[])
         } else if (arg == "--newgui") {
             newgui = true;
 
+        } else if (arg == "--trainsim") {
+            nogui = trainsim = true;
+
+        } else if (arg.startsWith("--workout=")) {
+            simWorkout = arg.mid(10);
+
+        } else if (arg.startsWith("--replay=")) {
+            simReplay = arg.mid(9);
+
+        } else if (arg.startsWith("--speedup=")) {
+            simSpeedup = arg.mid(10).toDouble();
+
+        } else if (arg.startsWith("--response=")) {
+            simResponse = arg.mid(11).toInt();
+
+        } else if (arg == "--bench") {
+            nogui = bench = true;
+
+        } else if (arg.startsWith("--samples=")) {
+            benchSamples = arg.mid(10);
+
+        } else if (arg.startsWith("--iterations=")) {
+            benchIterations = arg.mid(13).toInt();
+
+        } else if (arg.startsWith("--output=")) {
+            benchOutput = arg.mid(9);
+
+        } else if (arg == "--rebuild") {
+            nogui = rebuild = true;
+
+        } else if (arg == "--full") {
+            rebuildFull = true;
+
+        } else if (arg.startsWith("--threads=")) {
+            threads = arg.mid(10).toInt();
+
+        } else if (arg.startsWith("--trace=")) {
+#ifdef GC_WANT_TRACE
+            traceFile = arg.mid(8);
+            Trace::enable();
+#else
+            fprintf(stderr, "Tracing not compiled in, exiting.\n");
+            exit(1);
+#endif
+
         } else if (arg == "--server") {
 #ifdef GC_WANT_HTTP
             nogui = server = true;
@@ -536,9 +620,10 @@ main(int argc, char *argv[])
         appsettings->initializeQSettingsGlobal(gcroot);
 
 
-        // now redirect stderr
+        // now redirect stderr, but not when headless since
+        // that's where the progress and errors are reported
 #ifndef WIN32
-        if (!debug) nostderr(home.canonicalPath());
+        if (!debug && !rebuild && !bench && !trainsim) nostderr(home.canonicalPath());
 #else
         Q_UNUSED(debug)
 #endif
@@ -606,6 +691,130 @@ main(int argc, char *argv[])
             
         }
 
+        // ride the simulated trainer headless and exit, the
+        // athlete is needed for zones and bike settings only
+        if (trainsim) {
+            int status = 1;
+            QString cyclist = lastOpened.toStringList().value(0);
+            QString homeDir = home.canonicalPath();
+
+            if (cyclist != "" && home.cd(cyclist)) {
+                appsettings->initializeQSettingsAthlete(homeDir, cyclist);
+
+                Context *context = new Context(NULL);
+                context->athlete = new Athlete(context, home);
+
+                TrainSimulator sim(context);
+                sim.setSpeedup(simSpeedup);
+                sim.setResponse(simResponse);
+                if ((simWorkout == "" || sim.setWorkout(simWorkout)) &&
+                    (simReplay == "" || sim.setReplay(simReplay)) && sim.run()) {
+                    fprintf(stdout, "%s", sim.report().toLocal8Bit().constData());
+                    status = 0;
+                } else {
+                    fprintf(stderr, "%s\n", sim.errorString().toLocal8Bit().constData());
+                }
+            } else {
+                fprintf(stderr, "No athlete to simulate, pass the athlete on the command line.\n");
+            }
+            delete trainDB;
+            terminate(status);
+        }
+
+        // run the benchmarks headless and exit, against the athlete
+        // passed or the samples imported into a throwaway athlete
+        // so the results can be compared between builds
+        if (bench) {
+            int status = 1;
+            QString error;
+            QTemporaryDir temp;
+            QString cyclist = args.count() > 1 ? lastOpened.toStringList().value(0) : QString();
+            bool samples = cyclist == "";
+
+            if (samples) {
+                if (temp.isValid() && Benchmark::createAthlete(temp.path(), error)) {
+                    home = QDir(temp.path());
+                    cyclist = "bench";
+                }
+            }
+            QString homeDir = home.canonicalPath();
+
+            if (cyclist != "" && home.cd(cyclist)) {
+                appsettings->initializeQSettingsAthlete(homeDir, cyclist);
+
+                Context *context = new Context(NULL);
+                context->athlete = new Athlete(context, home);
+
+                Benchmark benchmark(context);
+                benchmark.setSamples(benchSamples);
+                benchmark.setIterations(benchIterations);
+                if (samples) benchmark.importSamples();
+
+                if (benchmark.run()) {
+                    // the report goes alongside the json when it's on stdout
+                    fprintf(benchOutput == "" ? stderr : stdout, "%s", benchmark.report().toLocal8Bit().constData());
+
+                    QFile output(benchOutput);
+                    if (benchOutput == "") {
+                        fprintf(stdout, "%s", benchmark.json().constData());
+                        status = 0;
+                    } else if (output.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+                        output.write(benchmark.json());
+                        output.close();
+                        status = 0;
+                    } else {
+                        fprintf(stderr, "Cannot write %s\n", benchOutput.toLocal8Bit().constData());
+                    }
+                } else {
+                    fprintf(stderr, "%s\n", benchmark.errorString().toLocal8Bit().constData());
+                }
+            } else {
+                if (error == "") error = "No athlete to benchmark.";
+                fprintf(stderr, "%s\n", error.toLocal8Bit().constData());
+            }
+
+            // terminate won't run the destructors
+            if (samples) temp.remove();
+            delete trainDB;
+            terminate(status);
+        }
+
+        // refresh the athlete's caches headless and exit, the refresh
+        // starts as the athlete is opened so threads are set up first.
+        // the athlete must be passed, never the last one opened, since
+        // --full deletes their caches
+        if (rebuild) {
+            int status = 1;
+            QString cyclist = args.count() > 1 ? lastOpened.toStringList().value(0) : QString();
+            QString homeDir = home.canonicalPath();
+
+            if (cyclist != "" && home.cd(cyclist)) {
+                if (threads > 0) QThreadPool::globalInstance()->setMaxThreadCount(threads);
+                if (rebuildFull) fprintf(stderr, "removed %d cache files\n", CacheRebuild::clear(home));
+
+                appsettings->initializeQSettingsAthlete(homeDir, cyclist);
+
+                uint started = QDateTime::currentDateTime().toTime_t();
+                QElapsedTimer timer;
+                timer.start();
+
+                Context *context = new Context(NULL);
+                context->athlete = new Athlete(context, home);
+
+                CacheRebuild rebuilder(context, timer.elapsed(), started);
+                if (rebuilder.run()) status = 0;
+                else {
+                    fprintf(stderr, "%s\n", rebuilder.errorString().toLocal8Bit().constData());
+                    status = 2;
+                }
+                fprintf(stdout, "%s", rebuilder.report().toLocal8Bit().constData());
+            } else {
+                fprintf(stderr, "usage: GoldenCheetah --rebuild [--full] [--threads=n] [directory] athlete\n");
+            }
+            delete trainDB;
+            terminate(status);
+        }
+
 #ifdef GC_WANT_HTTP
 
         // The API server offers webservices (default port 12021, see httpserver.ini)
@@ -760,5 +969,9 @@ main(int argc, char *argv[])
 
     delete application;
 
+#ifdef GC_WANT_TRACE
+    if (traceFile != "") Trace::write(traceFile);
+#endif
+
     return ret;
 }
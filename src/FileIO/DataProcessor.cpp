@@ -109,6 +109,29 @@ DataProcessorFactory::autoProcess(RideFile *ride, QString mode, QString op)
     return changed;
 }
 
+bool
+DataProcessorFactory::autoProcessThreadSafe(QString mode)
+{
+    if (!autoprocess) return true;
+
+#ifdef GC_WANT_PYTHON
+    // make sure python fixes are registered before we look
+    fixPySettings->initialize();
+#endif
+
+    QMapIterator<QString, DataProcessor*> i(processors);
+    i.toFront();
+    while (i.hasNext()) {
+        i.next();
+        QString configsetting = QString("dp/%1/apply").arg(i.key());
+
+        if (appsettings->value(NULL, GC_QSETTINGS_GLOBAL_GENERAL+configsetting, "Manual").toString() == mode &&
+            !i.value()->isThreadSafe())
+            return false;
+    }
+    return true;
+}
+
 ManualDataProcessorDialog::ManualDataProcessorDialog(Context *context, QString name, RideItem *ride) : context(context), ride(ride)
 {
     setAttribute(Qt::WA_DeleteOnClose);
@@ -79,6 +79,10 @@ class DataProcessor
         virtual DataProcessorConfig *processorConfig(QWidget *parent, const RideFile* ride = NULL) = 0;
         virtual QString name() = 0; // Localized Name for user interface
         virtual bool isCoreProcessor() { return true; }
+
+        // can it be run on a worker thread, core processors are unless they
+        // need the GUI or the network (python fixes never are)
+        virtual bool isThreadSafe() { return isCoreProcessor(); }
 };
 
 // all data processors
@@ -100,6 +104,7 @@ class DataProcessorFactory {
         void unregisterProcessor(QString name);
         QMap<QString,DataProcessor*> getProcessors(bool coreProcessorsOnly = false) const;
         bool autoProcess(RideFile *, QString mode, QString op); // run auto processes (after open rideFile)
+        bool autoProcessThreadSafe(QString mode); // can autoProcess for mode run off the GUI thread
         void setAutoProcessRule(bool b) { autoprocess = b; } // allows to switch autoprocess off (e.g. for Upgrades)
 };
 
@@ -258,6 +258,10 @@ FixDerivePower::postProcess(RideFile *ride, DataProcessorConfig *config=0, QStri
 
     if (ride->areDataPresent()->slope && ride->areDataPresent()->alt
      && ride->areDataPresent()->km) {
+
+        // estimates are collected and applied in one go
+        QVector<double> power(ride->dataPoints().count());
+
         for (int i=0; i<ride->dataPoints().count(); i++) {
             RideFilePoint *p = ride->dataPoints()[i];
 
@@ -303,7 +307,7 @@ FixDerivePower::postProcess(RideFile *ride, DataProcessorConfig *config=0, QStri
                 Ka = 176.5 * exp(-p->alt * .0001253) * CdA * DraftM / (273 + T);
                 //qDebug()<<"acc="<<p->kphd<<" , V="<<V<<" , m="<<M<<" , Pa="<<(p->kphd > 1 ? 1 : p->kphd*V*M);
                 double watts = (afCm * V * (Ka * (vw * vw) + Frg + V * CrDyn))+(p->kphd > 1 ? 1 : p->kphd*V*M);
-                ride->command->setPointValue(i, RideFile::watts, watts > 0 ? (watts > 1000 ? 1000 : watts) : 0);
+                power[i] = watts > 0 ? (watts > 1000 ? 1000 : watts) : 0;
                 // qDebug() << "watts = "<<p->watts;
                 // qDebug() << "  " << afCm * V * Ka * (vw * vw) << " = afCm(=" << afCm << ") * V(=" << V << ") * Ka(="<<Ka<<") * (vw^2(=" << V+W << "^2))";
                 // qDebug() << "  " << afCm * V * Frg << " = afCm * V * Frg(=" << Frg << ")";
@@ -311,25 +315,26 @@ FixDerivePower::postProcess(RideFile *ride, DataProcessorConfig *config=0, QStri
                 // qDebug() << "  " << p->kphd*V*M << " = kphd(=" << p->kphd << ") * V * M(=" << M << ")";
                 // qDebug() << "    Ka="<<Ka<<", CwaRi="<<CwaRider<<", slope="<<p->slope<<", v="<<p->kph<<" Cwa="<<(CwaRider + CwaBike);
             } else {
-                ride->command->setPointValue(i, RideFile::watts, 0);
+                power[i] = 0;
             }
         }
 
         int smoothPoints = 3;
         // initialise rolling average
         double rtot = 0;
-        for (int i=smoothPoints; i>0 && ride->dataPoints().count()-i >=0; i--) {
-            rtot += ride->dataPoints()[ride->dataPoints().count()-i]->watts;
+        for (int i=smoothPoints; i>0 && power.count()-i >=0; i--) {
+            rtot += power[power.count()-i];
         }
 
         // now run backwards setting the rolling average
-        for (int i=ride->dataPoints().count()-1; i>=smoothPoints; i--) {
-            double here = ride->dataPoints()[i]->watts;
-            ride->dataPoints()[i]->watts = rtot / smoothPoints;
-            if (ride->dataPoints()[i]->watts<0) ride->dataPoints()[i]->watts = 0;
+        for (int i=power.count()-1; i>=smoothPoints; i--) {
+            double here = power[i];
+            power[i] = rtot / smoothPoints;
+            if (power[i]<0) power[i] = 0;
                 rtot -= here;
-                rtot += ride->dataPoints()[i-smoothPoints]->watts;
+                rtot += power[i-smoothPoints];
         }
+        ride->command->setPointValues(0, RideFile::watts, power);
         ride->setDataPresent(ride->watts, true);
     }
 
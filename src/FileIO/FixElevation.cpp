@@ -96,6 +96,9 @@ class FixElevation : public DataProcessor {
         QString name() {
             return (tr("Fix Elevation errors"));
         }
+
+        // pops up a message box and fetches from the network
+        bool isThreadSafe() { return false; }
 };
 
 static bool fixElevationAdded = DataProcessorFactory::instance().registerProcessor(QString("Fix Elevation errors"), new FixElevation());
@@ -116,6 +119,10 @@ FixElevation::postProcess(RideFile *ride, DataProcessorConfig *config=0, QString
 
     ride->command->startLUW("Fix Elevation Data");
 
+    // work on a copy of the altitude and apply it in one go
+    QVector<double> alt(ride->dataPoints().count());
+    for (int i=0; i<alt.count(); i++) alt[i] = ride->dataPoints()[i]->alt;
+
     int lastDistance = 0;
     for (int i=0; i<ride->dataPoints().count(); i++) {
         // is the gps point any good?
@@ -133,7 +140,7 @@ FixElevation::postProcess(RideFile *ride, DataProcessorConfig *config=0, QString
                 //grab a gps point every 20 meters
                 lastDistance = (int) (ride->dataPoints()[i]->km * 1000) + 20;
             }
-            ride->command->setPointValue(i, RideFile::alt, 0);
+            alt[i] = 0;
         }
     }
 
@@ -167,6 +174,7 @@ FixElevation::postProcess(RideFile *ride, DataProcessorConfig *config=0, QString
                          tr("The following problem occured: %1").arg(err));
         oops.exec();
         // close LUW
+        ride->command->setPointValues(0, RideFile::alt, alt);
         ride->command->endLUW();
         return false;
     }
@@ -203,31 +211,27 @@ FixElevation::postProcess(RideFile *ride, DataProcessorConfig *config=0, QString
         for( std::vector<elevationGPSPoint>::iterator point = elvPoints.begin() ; point != elvPoints.end() ; ++point ) {
             double elev = smoothArray.size() > loopCount ? smoothArray[loopCount] : -100;
             // ignore any seriously negative points
-            if (elev>-100) ride->command->setPointValue(point->rideFileIndex, RideFile::alt, elev);
+            if (elev>-100) alt[point->rideFileIndex] = elev;
             ++loopCount;
         }
 
-        // set data present if not currently so
-        if (ride->areDataPresent()->alt == false) ride->command->setDataPresent(RideFile::alt, true);
-
-
         int lastgood = -1;  // where did we last have decent GPS data?
-        for (int i=0; i<ride->dataPoints().count(); i++) {
+        for (int i=0; i<alt.count(); i++) {
             // is this one decent?
-            if (ride->dataPoints()[i]->alt != double(0)) {
+            if (alt[i] != double(0)) {
 
                 if (lastgood != -1 && (lastgood+1) != i) {
                     // interpolate from last good to here
                     // then set last good to here
-                    double deltaAlt = (ride->dataPoints()[i]->alt - ride->dataPoints()[lastgood]->alt) / double(i-lastgood);
+                    double deltaAlt = (alt[i] - alt[lastgood]) / double(i-lastgood);
                     for (int j=lastgood+1; j<i; j++) {
-                        ride->command->setPointValue(j, RideFile::alt, ride->dataPoints()[lastgood]->alt + (double(j-lastgood)*deltaAlt));
+                        alt[j] = alt[lastgood] + (double(j-lastgood)*deltaAlt);
                         errors++;
                     }
                 } else if (lastgood == -1) {
                     // fill to front
                     for (int j=0; j<i; j++) {
-                        ride->command->setPointValue(j, RideFile::alt, ride->dataPoints()[i]->alt);
+                        alt[j] = alt[i];
                         errors++;
                     }
                 }
@@ -236,20 +240,24 @@ FixElevation::postProcess(RideFile *ride, DataProcessorConfig *config=0, QString
         }
 
         // fill to end...
-        if (lastgood != -1 && lastgood != (ride->dataPoints().count()-1)) {
+        if (lastgood != -1 && lastgood != (alt.count()-1)) {
            // fill from lastgood to end with lastgood
-            for (int j=lastgood+1; j<ride->dataPoints().count(); j++) {
-                ride->command->setPointValue(j, RideFile::alt, ride->dataPoints()[lastgood]->alt);
+            for (int j=lastgood+1; j<alt.count(); j++) {
+                alt[j] = alt[lastgood];
                 errors++;
             }
         }
 
+        // set data present if not currently so
+        if (ride->areDataPresent()->alt == false) ride->command->setDataPresent(RideFile::alt, true);
+
         // Invalidate slope data to be recomputed based on new altitude data
         if (ride->areDataPresent()->slope == true)
             ride->command->setDataPresent(RideFile::slope, false);
     }
 
     // close LUW
+    ride->command->setPointValues(0, RideFile::alt, alt);
     ride->command->endLUW();
 
     if (errors) {
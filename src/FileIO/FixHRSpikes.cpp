@@ -141,23 +141,27 @@ FixHRSpikes::postProcess(RideFile *ride, DataProcessorConfig *config=0, QString
 
     ride->command->startLUW("Fix Spikes in Recording"); // Start LogicalUnitOfWork
 
+    // work on a copy and apply the fixes in one go
+    QVector<double> hr(ride->dataPoints().count());
+    for (int i=0; i<hr.count(); i++) hr[i] = ride->dataPoints()[i]->hr;
+
     int lastgood = -1;  // where did we last have decent HR data?
-    for (int i=0; i<ride->dataPoints().count(); i++) {
+    for (int i=0; i<hr.count(); i++) {
       // If we have a non-zero HR that is not above the specified MAX
-      if(ride->dataPoints()[i]->hr > 0 && ride->dataPoints()[i]->hr <= max) {
+      if(hr[i] > 0 && hr[i] <= max) {
 	if (lastgood != -1 && (lastgood+1) != i) {
 	  // interpolate from last good to here
-	  double deltaHR = (ride->dataPoints()[i]->hr - ride->dataPoints()[lastgood]->hr) / double(i-lastgood);
+	  double deltaHR = (hr[i] - hr[lastgood]) / double(i-lastgood);
 
 	  for (int j=lastgood+1; j<i; j++) {
 	    // Round as fractional HR is not very useful
-	    ride->command->setPointValue(j, RideFile::hr, ride->dataPoints()[lastgood]->hr + round(double(j-lastgood)*deltaHR));
+	    hr[j] = hr[lastgood] + round(double(j-lastgood)*deltaHR);
 	    spikes++;
 	  }
 	} else if (lastgood == -1) {
 	  // fill to front
 	  for (int j=0; j<i; j++) {
-	    ride->command->setPointValue(j, RideFile::hr, ride->dataPoints()[i]->hr);
+	    hr[j] = hr[i];
 	    spikes++;
 	  }
 	}
@@ -166,13 +170,14 @@ FixHRSpikes::postProcess(RideFile *ride, DataProcessorConfig *config=0, QString
       }
     }
     // fill to end...
-    if (lastgood != -1 && lastgood != (ride->dataPoints().count()-1)) {
+    if (lastgood != -1 && lastgood != (hr.count()-1)) {
        // fill from lastgood to end with lastgood
-        for (int j=lastgood+1; j<ride->dataPoints().count(); j++) {
-            ride->command->setPointValue(j, RideFile::hr, ride->dataPoints()[lastgood]->hr);
+        for (int j=lastgood+1; j<hr.count(); j++) {
+            hr[j] = hr[lastgood];
             spikes++;
         }
     }
+    ride->command->setPointValues(0, RideFile::hr, hr);
 
     ride->command->endLUW();	// End of LogicalUnitOfWork
 
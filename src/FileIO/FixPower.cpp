@@ -154,6 +154,7 @@ FixPower::postProcess(RideFile *ride, DataProcessorConfig *config=0, QString op=
 
     // apply the change
     ride->command->startLUW("Adjust Power");
+    QVector<double> power(ride->dataPoints().count());
     for (int i=0; i<ride->dataPoints().count(); i++) {
         RideFilePoint *point = ride->dataPoints()[i];
         double newWatts = point->watts;
@@ -165,11 +166,9 @@ FixPower::postProcess(RideFile *ride, DataProcessorConfig *config=0, QString op=
         if (point->watts != 0 && absoluteAdjust != 0) {
             newWatts += absoluteAdjust;
         }
-        if (newWatts != point->watts) {
-           ride->command->setPointValue(i, RideFile::watts, newWatts);
-        }
-
+        power[i] = newWatts;
     }
+    ride->command->setPointValues(0, RideFile::watts, power);
     ride->command->endLUW();
 
     double currentta = ride->getTag("Power Adjust", "0.0").toDouble();
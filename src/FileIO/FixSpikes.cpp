@@ -179,10 +179,10 @@ FixSpikes::postProcess(RideFile *ride, DataProcessorConfig *config=0, QString op
     for (int i=0; i<secs.count(); i++) {
 
         // An entry is a fixup candidate only if its variance is high AND it is above a concerning power level.
+        // ranked by deviation so once it drops below the variance there are no more
+        if (outliers->getDeviationForRank(i) < variance) break;
         double y = outliers->getYForRank(i);
-        if (   outliers->getDeviationForRank(i) < variance
-            || y < max)
-            continue;
+        if (y < max) continue;
 
         // Houston, we have a spike
         spikes++;
@@ -192,11 +192,15 @@ FixSpikes::postProcess(RideFile *ride, DataProcessorConfig *config=0, QString op
         int pos = outliers->getIndexForRank(i);
         double left=0.0, right=0.0;
 
-        if (pos > 0) left = ride->dataPoints()[pos-1]->watts;
-        if (pos < (ride->dataPoints().count()-1)) right = ride->dataPoints()[pos+1]->watts;
+        if (pos > 0) left = power[pos-1];
+        if (pos < (power.count()-1)) right = power[pos+1];
 
-        ride->command->setPointValue(pos, RideFile::watts, (left+right)/2.0);
+        // fix our copy, so neighbouring spikes see it
+        power[pos] = (left+right)/2.0;
     }
+
+    // and apply all the fixes in one go
+    ride->command->setPointValues(0, RideFile::watts, power);
     ride->command->endLUW();
 
     delete outliers;
@@ -0,0 +1,556 @@
+/*
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "GcbRideFile.h"
+#include "JsonRideFile.h"
+#include "Context.h"
+#include "Athlete.h"
+
+#include <QDataStream>
+#include <QFileInfo>
+#include <QProgressDialog>
+#include <QSaveFile>
+#include <QtEndian>
+#include <string.h>
+
+static int gcbFileReaderRegistered =
+    RideFileFactory::instance().registerReader(
+        "gcb", "GoldenCheetah Binary", new GcbFileReader());
+
+// the sample series stored as columns, SECS is always stored and INTERVAL
+// is an int so they are handled separately. Columns are named so series
+// added later can be skipped by older versions
+static const struct {
+    const char *name;
+    double RideFilePoint::*value;
+    bool RideFileDataPresent::*present;
+} gcbSeries[] = {
+    { "CAD", &RideFilePoint::cad, &RideFileDataPresent::cad },
+    { "HR", &RideFilePoint::hr, &RideFileDataPresent::hr },
+    { "KM", &RideFilePoint::km, &RideFileDataPresent::km },
+    { "KPH", &RideFilePoint::kph, &RideFileDataPresent::kph },
+    { "NM", &RideFilePoint::nm, &RideFileDataPresent::nm },
+    { "WATTS", &RideFilePoint::watts, &RideFileDataPresent::watts },
+    { "ALT", &RideFilePoint::alt, &RideFileDataPresent::alt },
+    { "LON", &RideFilePoint::lon, &RideFileDataPresent::lon },
+    { "LAT", &RideFilePoint::lat, &RideFileDataPresent::lat },
+    { "HEADWIND", &RideFilePoint::headwind, &RideFileDataPresent::headwind },
+    { "SLOPE", &RideFilePoint::slope, &RideFileDataPresent::slope },
+    { "TEMP", &RideFilePoint::temp, &RideFileDataPresent::temp },
+    { "LRBALANCE", &RideFilePoint::lrbalance, &RideFileDataPresent::lrbalance },
+    { "LTE", &RideFilePoint::lte, &RideFileDataPresent::lte },
+    { "RTE", &RideFilePoint::rte, &RideFileDataPresent::rte },
+    { "LPS", &RideFilePoint::lps, &RideFileDataPresent::lps },
+    { "RPS", &RideFilePoint::rps, &RideFileDataPresent::rps },
+    { "LPCO", &RideFilePoint::lpco, &RideFileDataPresent::lpco },
+    { "RPCO", &RideFilePoint::rpco, &RideFileDataPresent::rpco },
+    { "LPPB", &RideFilePoint::lppb, &RideFileDataPresent::lppb },
+    { "RPPB", &RideFilePoint::rppb, &RideFileDataPresent::rppb },
+    { "LPPE", &RideFilePoint::lppe, &RideFileDataPresent::lppe },
+    { "RPPE", &RideFilePoint::rppe, &RideFileDataPresent::rppe },
+    { "LPPPB", &RideFilePoint::lpppb, &RideFileDataPresent::lpppb },
+    { "RPPPB", &RideFilePoint::rpppb, &RideFileDataPresent::rpppb },
+    { "LPPPE", &RideFilePoint::lpppe, &RideFileDataPresent::lpppe },
+    { "RPPPE", &RideFilePoint::rpppe, &RideFileDataPresent::rpppe },
+    { "SMO2", &RideFilePoint::smo2, &RideFileDataPresent::smo2 },
+    { "THB", &RideFilePoint::thb, &RideFileDataPresent::thb },
+    { "RVERT", &RideFilePoint::rvert, &RideFileDataPresent::rvert },
+    { "RCAD", &RideFilePoint::rcad, &RideFileDataPresent::rcad },
+    { "RCON", &RideFilePoint::rcontact, &RideFileDataPresent::rcontact },
+    { "TCORE", &RideFilePoint::tcore, &RideFileDataPresent::tcore },
+    { NULL, NULL, NULL }
+};
+
+//
+// Columns are byte shuffled little endian doubles, compressed
+//
+static QByteArray
+packColumn(const QVector<double> &values)
+{
+    int n = values.count();
+    QByteArray shuffled(n * 8, 0);
+    char *to = shuffled.data();
+
+    for(int i=0; i<n; i++) {
+        quint64 bits;
+        memcpy(&bits, &values[i], 8);
+        bits = qToLittleEndian(bits);
+        for(int b=0; b<8; b++) to[b*n + i] = char((bits >> (b*8)) & 0xff);
+    }
+    return qCompress(shuffled);
+}
+
+static bool
+unpackColumn(const QByteArray &packed, int n, QVector<double> &values)
+{
+    QByteArray shuffled = qUncompress(packed);
+    if (shuffled.size() != n * 8) return false;
+
+    const uchar *from = reinterpret_cast<const uchar*>(shuffled.constData());
+    values.resize(n);
+    for(int i=0; i<n; i++) {
+        quint64 bits = 0;
+        for(int b=0; b<8; b++) bits |= quint64(from[b*n + i]) << (b*8);
+        bits = qFromLittleEndian(bits);
+        memcpy(&values[i], &bits, 8);
+    }
+    return true;
+}
+
+// all the values of a point, used for references
+static void
+writePoint(QDataStream &out, const RideFilePoint *p)
+{
+    out << p->secs;
+    for(int s=0; gcbSeries[s].name; s++) out << p->*gcbSeries[s].value;
+    out << qint32(p->interval);
+}
+
+static void
+readPoint(QDataStream &in, RideFilePoint &p)
+{
+    qint32 interval;
+    in >> p.secs;
+    for(int s=0; gcbSeries[s].name; s++) in >> p.*gcbSeries[s].value;
+    in >> interval;
+    p.interval = interval;
+}
+
+static QDataStream &
+setup(QDataStream &stream)
+{
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.setFloatingPointPrecision(QDataStream::DoublePrecision);
+    return stream;
+}
+
+// check the header, leaves the stream positioned after it
+static bool
+readHeader(QDataStream &in, qint64 &size, qint64 &modified)
+{
+    quint32 magic, version;
+    in >> magic >> version;
+    if (in.status() != QDataStream::Ok || magic != GCB_MAGIC || version > GCB_VERSION) return false;
+
+    in >> size >> modified;
+    return in.status() == QDataStream::Ok;
+}
+
+bool
+GcbFileReader::write(const RideFile *ride, QIODevice &device, qint64 size, QDateTime modified)
+{
+    QDataStream out(&device);
+    setup(out);
+
+    // header, size and modified are 0 unless we are a cache
+    out << quint32(GCB_MAGIC) << quint32(GCB_VERSION);
+    out << size << qint64(modified.isValid() ? modified.toMSecsSinceEpoch() : 0);
+
+    // first class variables
+    out << qint64(ride->startTime().toMSecsSinceEpoch());
+    out << ride->recIntSecs() << ride->deviceType() << ride->id();
+
+    // metadata
+    out << ride->metricOverrides;
+    out << ride->tags();
+
+    // intervals
+    out << qint32(ride->intervals().count());
+    foreach(RideFileInterval *i, ride->intervals())
+        out << qint32(i->type) << i->start << i->stop << i->name << i->color << i->test;
+
+    // calibrations
+    out << qint32(ride->calibrations().count());
+    foreach(RideFileCalibration *c, ride->calibrations())
+        out << c->start << qint32(c->value) << c->name;
+
+    // references
+    out << qint32(ride->referencePoints().count());
+    foreach(RideFilePoint *p, ride->referencePoints()) writePoint(out, p);
+
+    // samples, a column for each series that is present
+    int n = ride->dataPoints().count();
+    QStringList names;
+    QList<QByteArray> columns;
+    QVector<double> values(n);
+
+    for(int i=0; i<n; i++) values[i] = ride->dataPoints()[i]->secs;
+    names << "SECS";
+    columns << packColumn(values);
+
+    for(int s=0; gcbSeries[s].name; s++) {
+        if (!(ride->areDataPresent()->*gcbSeries[s].present)) continue;
+        for(int i=0; i<n; i++) values[i] = ride->dataPoints()[i]->*gcbSeries[s].value;
+        names << gcbSeries[s].name;
+        columns << packColumn(values);
+    }
+
+    if (ride->areDataPresent()->interval) {
+        for(int i=0; i<n; i++) values[i] = ride->dataPoints()[i]->interval;
+        names << "INTERVAL";
+        columns << packColumn(values);
+    }
+
+    out << qint32(n) << qint32(names.count());
+    for(int c=0; c<names.count(); c++) out << names[c] << columns[c];
+
+    // xdata, columns for secs, km and each value
+    QMap<QString,XDataSeries*> &xdata = const_cast<RideFile*>(ride)->xdata();
+    out << qint32(xdata.count());
+    QMapIterator<QString,XDataSeries*> it(xdata);
+    while(it.hasNext()) {
+        it.next();
+        XDataSeries *series = it.value();
+
+        QList<qint32> types;
+        foreach(RideFile::SeriesType type, series->valuetype) types << qint32(type);
+
+        int xn = series->datapoints.count();
+        int xv = qMin(series->valuename.count(), XDATA_MAXVALUES);
+        out << it.key() << series->name << series->valuename << series->unitname << types;
+        out << qint32(xn) << qint32(xv);
+
+        QVector<double> xvalues(xn);
+        for(int i=0; i<xn; i++) xvalues[i] = series->datapoints[i]->secs;
+        out << packColumn(xvalues);
+        for(int i=0; i<xn; i++) xvalues[i] = series->datapoints[i]->km;
+        out << packColumn(xvalues);
+
+        for(int v=0; v<xv; v++) {
+            for(int i=0; i<xn; i++) xvalues[i] = series->datapoints[i]->number[v];
+            out << packColumn(xvalues);
+
+            // strings are rarely used so only stored when we have some
+            QStringList strings;
+            bool used = false;
+            for(int i=0; i<xn; i++) {
+                strings << series->datapoints[i]->string[v];
+                if (strings.last() != "") used = true;
+            }
+            out << used;
+            if (used) out << qCompress(strings.join(QChar(0)).toUtf8());
+        }
+    }
+
+    return out.status() == QDataStream::Ok;
+}
+
+RideFile *
+GcbFileReader::read(QIODevice &device, QStringList &errors, qint64 *size, QDateTime *modified)
+{
+    QDataStream in(&device);
+    setup(in);
+
+    qint64 jsonsize, jsonmodified;
+    if (!readHeader(in, jsonsize, jsonmodified)) {
+        errors << "not a GoldenCheetah Binary file, or a later version";
+        return NULL;
+    }
+    if (size) *size = jsonsize;
+    if (modified) *modified = QDateTime::fromMSecsSinceEpoch(jsonmodified);
+
+    RideFile *ride = new RideFile;
+
+    // first class variables
+    qint64 start;
+    double recIntSecs;
+    QString deviceType, id;
+    in >> start >> recIntSecs >> deviceType >> id;
+    ride->setStartTime(QDateTime::fromMSecsSinceEpoch(start));
+    ride->setRecIntSecs(recIntSecs);
+    ride->setDeviceType(deviceType);
+    ride->setId(id);
+
+    // metadata
+    QMap<QString,QString> tags;
+    in >> ride->metricOverrides >> tags;
+    QMapIterator<QString,QString> t(tags);
+    while(t.hasNext()) {
+        t.next();
+        ride->setTag(t.key(), t.value());
+    }
+
+    // intervals
+    qint32 count;
+    in >> count;
+    for(int i=0; i<count && in.status() == QDataStream::Ok; i++) {
+        qint32 type;
+        double start, stop;
+        QString name;
+        QColor color;
+        bool test;
+        in >> type >> start >> stop >> name >> color >> test;
+        ride->addInterval(static_cast<RideFileInterval::IntervalType>(type), start, stop, name, color, test);
+    }
+
+    // calibrations
+    in >> count;
+    for(int i=0; i<count && in.status() == QDataStream::Ok; i++) {
+        double start;
+        qint32 value;
+        QString name;
+        in >> start >> value >> name;
+        ride->addCalibration(start, value, name);
+    }
+
+    // references
+    in >> count;
+    for(int i=0; i<count && in.status() == QDataStream::Ok; i++) {
+        RideFilePoint p;
+        readPoint(in, p);
+        ride->appendReference(p);
+    }
+
+    // samples
+    qint32 n, ncolumns;
+    in >> n >> ncolumns;
+    QMap<QString, QVector<double> > columns;
+    for(int c=0; c<ncolumns && in.status() == QDataStream::Ok; c++) {
+        QString name;
+        QByteArray packed;
+        in >> name >> packed;
+        if (!unpackColumn(packed, n, columns[name])) {
+            errors << QString("corrupt %1 samples").arg(name);
+            delete ride;
+            return NULL;
+        }
+    }
+
+    if (in.status() != QDataStream::Ok) {
+        errors << "truncated file";
+        delete ride;
+        return NULL;
+    }
+
+    // look up the columns once, absent series take the
+    // same defaults as they would when parsing json
+    const QVector<double> *secs = columns.contains("SECS") ? &columns["SECS"] : NULL;
+    const QVector<double> *interval = columns.contains("INTERVAL") ? &columns["INTERVAL"] : NULL;
+    QVector<const QVector<double> *> series;
+    for(int s=0; gcbSeries[s].name; s++)
+        series << (columns.contains(gcbSeries[s].name) ? &columns[gcbSeries[s].name] : NULL);
+
+    for(int i=0; i<n; i++) {
+        RideFilePoint p;
+        if (secs) p.secs = (*secs)[i];
+        if (interval) p.interval = int((*interval)[i]);
+        for(int s=0; s<series.count(); s++) if (series[s]) p.*gcbSeries[s].value = (*series[s])[i];
+
+        // same as the json parser so data present is set the same way
+        ride->appendPoint(p.secs, p.cad, p.hr, p.km, p.kph,
+                          p.nm, p.watts, p.alt, p.lon, p.lat,
+                          p.headwind, p.slope, p.temp, p.lrbalance,
+                          p.lte, p.rte, p.lps, p.rps,
+                          p.lpco, p.rpco,
+                          p.lppb, p.rppb, p.lppe, p.rppe,
+                          p.lpppb, p.rpppb, p.lpppe, p.rpppe,
+                          p.smo2, p.thb,
+                          p.rvert, p.rcad, p.rcontact, p.tcore,
+                          p.interval);
+    }
+
+    // xdata
+    in >> count;
+    for(int x=0; x<count && in.status() == QDataStream::Ok; x++) {
+        QString key;
+        QList<qint32> types;
+        qint32 xn, xv;
+        XDataSeries *add = new XDataSeries;
+        in >> key >> add->name >> add->valuename >> add->unitname >> types >> xn >> xv;
+        foreach(qint32 type, types) add->valuetype << static_cast<RideFile::SeriesType>(type);
+
+        QVector<XDataPoint*> points(xn);
+        for(int i=0; i<xn; i++) points[i] = new XDataPoint;
+        add->datapoints = points;
+
+        QByteArray packed;
+        QVector<double> values;
+        bool ok = true;
+        in >> packed;
+        if ((ok = unpackColumn(packed, xn, values))) for(int i=0; i<xn; i++) points[i]->secs = values[i];
+        in >> packed;
+        if (ok && (ok = unpackColumn(packed, xn, values))) for(int i=0; i<xn; i++) points[i]->km = values[i];
+
+        for(int v=0; ok && v<xv && v<XDATA_MAXVALUES; v++) {
+            bool used;
+            in >> packed >> used;
+            if ((ok = unpackColumn(packed, xn, values))) for(int i=0; i<xn; i++) points[i]->number[v] = values[i];
+
+            if (used) {
+                in >> packed;
+                QStringList strings = QString::fromUtf8(qUncompress(packed)).split(QChar(0));
+                for(int i=0; i<xn && i<strings.count(); i++) points[i]->string[v] = strings[i];
+            }
+        }
+
+        if (!ok || in.status() != QDataStream::Ok) {
+            errors << QString("corrupt %1 xdata").arg(key);
+            delete add;
+            delete ride;
+            return NULL;
+        }
+        ride->addXData(key, add);
+    }
+
+    return ride;
+}
+
+RideFile *
+GcbFileReader::openRideFile(QFile &file, QStringList &errors, QList<RideFile*>*) const
+{
+    if (!file.open(QFile::ReadOnly)) {
+        errors << "unable to open file" + file.fileName();
+        return NULL;
+    }
+
+    RideFile *ride = read(file, errors);
+    file.close();
+
+    if (ride) ride->setFileFormat("GoldenCheetah Binary (gcb)");
+    return ride;
+}
+
+bool
+GcbFileReader::writeRideFile(Context *, const RideFile *ride, QFile &file) const
+{
+    if (!file.open(QIODevice::WriteOnly)) return false;
+    file.resize(0);
+
+    bool ok = write(ride, file);
+    file.close();
+    return ok;
+}
+
+//
+// Caching json activities
+//
+QString
+GcbFileReader::cacheFileName(Context *context, const QFileInfo &json)
+{
+    if (!context || json.suffix().toLower() != "json") return "";
+
+    // same layout as the .cpx files
+    QString path = json.canonicalPath();
+    if (path == context->athlete->home->activities().canonicalPath())
+        return context->athlete->home->cache().canonicalPath() + "/" + json.baseName() + ".gcb";
+    if (path == context->athlete->home->planned().canonicalPath())
+        return context->athlete->home->cache().canonicalPath() + "/planned/" + json.baseName() + ".gcb";
+
+    return "";
+}
+
+// is the cache up to date with the json
+static bool
+cacheIsCurrent(const QString &cache, const QFileInfo &json)
+{
+    QFile file(cache);
+    if (!file.open(QFile::ReadOnly)) return false;
+
+    QDataStream in(&file);
+    setup(in);
+
+    qint64 size, modified;
+    bool current = readHeader(in, size, modified) && size == json.size() &&
+                   modified == json.lastModified().toMSecsSinceEpoch();
+    file.close();
+    return current;
+}
+
+RideFile *
+GcbFileReader::openCached(Context *context, QFile &json)
+{
+    QFileInfo info(json.fileName());
+    QString cache = cacheFileName(context, info);
+    if (cache == "") return NULL;
+
+    QFile file(cache);
+    if (!file.open(QFile::ReadOnly)) return NULL;
+
+    // stale, the json is parsed instead; check the header
+    // before going to the trouble of decoding the rest
+    QDataStream in(&file);
+    setup(in);
+
+    qint64 size, modified;
+    if (!readHeader(in, size, modified) || size != info.size() ||
+        modified != info.lastModified().toMSecsSinceEpoch()) {
+        file.close();
+        return NULL;
+    }
+
+    // broken, likewise
+    QStringList errors;
+    file.seek(0);
+    RideFile *ride = read(file, errors);
+    file.close();
+    return ride;
+}
+
+void
+GcbFileReader::updateCache(Context *context, QFile &json, const RideFile *ride)
+{
+    QFileInfo info(json.fileName());
+    QString cache = cacheFileName(context, info);
+    if (cache == "" || !ride) return;
+
+    // written alongside and renamed so a reader never sees half a file
+    QSaveFile file(cache);
+    if (!file.open(QFile::WriteOnly)) return;
+    if (write(ride, file, info.size(), info.lastModified())) file.commit();
+    else file.cancelWriting();
+}
+
+int
+GcbFileReader::convertLibrary(Context *context, QProgressDialog *progress)
+{
+    // all the activities, planned as well
+    QList<QFileInfo> files;
+    QStringList filter("*.json");
+    files << context->athlete->home->activities().entryInfoList(filter, QDir::Files, QDir::Name);
+    files << context->athlete->home->planned().entryInfoList(filter, QDir::Files, QDir::Name);
+    QDir(context->athlete->home->cache().canonicalPath()).mkpath("planned");
+
+    if (progress) progress->setMaximum(files.count());
+
+    JsonFileReader reader;
+    int converted = 0;
+    for(int i=0; i<files.count(); i++) {
+
+        if (progress) {
+            progress->setValue(i);
+            if (progress->wasCanceled()) return -1;
+        }
+
+        QString cache = cacheFileName(context, files[i]);
+        if (cache == "" || cacheIsCurrent(cache, files[i])) continue;
+
+        // parse the json and cache it
+        QFile file(files[i].absoluteFilePath());
+        QStringList errors;
+        RideFile *ride = reader.openRideFile(file, errors);
+        if (ride) {
+            updateCache(context, file, ride);
+            delete ride;
+            converted++;
+        }
+    }
+    if (progress) progress->setValue(files.count());
+
+    return converted;
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _GcbRideFile_h
+#define _GcbRideFile_h
+#include "GoldenCheetah.h"
+
+#include "RideFile.h"
+#include <QDateTime>
+#include <QIODevice>
+#include <QFileInfo>
+
+class QProgressDialog;
+
+//
+// GoldenCheetah Binary (.gcb)
+//
+// A compact binary serialisation of a RideFile; header, metadata, intervals
+// then the samples stored a column per series. Each column is byte shuffled
+// (all the first bytes, then all the second bytes ...) before compressing, so
+// slowly changing series compress well. Values are stored as doubles so the
+// conversion is lossless, writing a ride that was read from .gcb back out as
+// json gives exactly the same json.
+//
+// The athlete library stays as json, but each activity has a .gcb alongside
+// the .cpx in the cache folder which is opened instead of parsing the json
+// when it is up to date (it records the size and modified time of the json
+// it was made from).
+//
+#define GCB_MAGIC   0x47434231 // "GCB1"
+#define GCB_VERSION 1
+
+struct GcbFileReader : public RideFileReader {
+
+    virtual RideFile *openRideFile(QFile &file, QStringList &errors, QList<RideFile*>* = 0) const;
+    bool writeRideFile(Context *context, const RideFile *ride, QFile &file) const;
+    bool hasWrite() const { return true; }
+
+    // serialise, size and modified describe the source json when caching
+    static RideFile *read(QIODevice &in, QStringList &errors, qint64 *size=NULL, QDateTime *modified=NULL);
+    static bool write(const RideFile *ride, QIODevice &out, qint64 size=0, QDateTime modified=QDateTime());
+
+    // the cache for an activity file, empty if it isn't in the library
+    static QString cacheFileName(Context *context, const QFileInfo &json);
+
+    // open from the cache, NULL if there is no cache or it is stale
+    static RideFile *openCached(Context *context, QFile &json);
+
+    // (re)write the cache for a json file that has just been parsed
+    static void updateCache(Context *context, QFile &json, const RideFile *ride);
+
+    // bring the cache up to date for all the activities, returns the
+    // number converted or -1 if cancelled via the progress dialog
+    static int convertLibrary(Context *context, QProgressDialog *progress=NULL);
+};
+
+#endif
@@ -772,6 +772,12 @@ JsonFileReader::toByteArray(Context *, const RideFile *ride, bool withAlt, bool
 // Writes valid .json (validated at www.jsonlint.com)
 bool
 JsonFileReader::writeRideFile(Context *context, const RideFile *ride, QFile &file) const
+{
+    return writeByteArray(toByteArray(context, ride, true, true, true, true), file);
+}
+
+bool
+JsonFileReader::writeByteArray(const QByteArray &xml, QFile &file) const
 {
     // can we open the file for writing?
     if (!file.open(QIODevice::WriteOnly)) return false;
@@ -779,8 +785,6 @@ JsonFileReader::writeRideFile(Context *context, const RideFile *ride, QFile &fil
     // truncate existing
     file.resize(0);
 
-    QByteArray xml = toByteArray(context, ride, true, true, true, true);
-
     // setup streamer
     QTextStream out(&file);
     // unified codepage and BOM for identification on all platforms
@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "MeanMaxMerge.h"
+
+#include <QThread>
+
+//
+// The kernels are written as selects rather than ifs, a compare and
+// two blends per element, which gcc, clang and msvc all vectorise at
+// -O2/-O3 for whatever the target supports (SSE2, AVX, NEON) without
+// us having to carry intrinsics for each of them.
+//
+void
+MeanMaxMerge::envelope(double *into, int *who, const double *other, int n, int id)
+{
+    for (int i=0; i<n; i++) {
+        bool better = other[i] > into[i];
+        into[i] = better ? other[i] : into[i];
+        who[i] = better ? id : who[i];
+    }
+}
+
+void
+MeanMaxMerge::envelope(float *into, int *who, const float *other, int n, int id)
+{
+    for (int i=0; i<n; i++) {
+        bool better = other[i] > into[i];
+        into[i] = better ? other[i] : into[i];
+        who[i] = better ? id : who[i];
+    }
+}
+
+void
+MeanMaxMerge::envelope(float *into, const float *other, int n)
+{
+    for (int i=0; i<n; i++) into[i] = other[i] > into[i] ? other[i] : into[i];
+}
+
+void
+MeanMaxMerge::envelope(double *into, int *who, const double *other, const int *otherwho, int n)
+{
+    for (int i=0; i<n; i++) {
+        bool better = other[i] > into[i];
+        into[i] = better ? other[i] : into[i];
+        who[i] = better ? otherwho[i] : who[i];
+    }
+}
+
+void
+MeanMaxMerge::envelope(float *into, int *who, const float *other, const int *otherwho, int n)
+{
+    for (int i=0; i<n; i++) {
+        bool better = other[i] > into[i];
+        into[i] = better ? other[i] : into[i];
+        who[i] = better ? otherwho[i] : who[i];
+    }
+}
+
+void
+MeanMaxMerge::within(float *count, const double *best, const double *other, int n, double fraction)
+{
+    for (int i=0; i<n; i++) count[i] += other[i] >= fraction * best[i] ? 1.0f : 0.0f;
+}
+
+void
+MeanMaxMerge::add(double *into, const double *other, int n)
+{
+    for (int i=0; i<n; i++) into[i] += other[i];
+}
+
+void
+MeanMaxMerge::add(float *into, const float *other, int n)
+{
+    for (int i=0; i<n; i++) into[i] += other[i];
+}
+
+QVector<QPair<int,int> >
+MeanMaxMerge::ranges(int count, int minimum)
+{
+    QVector<QPair<int,int> > returning;
+    if (count <= 0) return returning;
+    if (minimum < 1) minimum = 1;
+
+    int threads = qMax(1, QThread::idealThreadCount());
+    int parts = qBound(1, count / minimum, threads);
+    int step = (count + parts - 1) / parts;
+
+    for (int from=0; from < count; from += step)
+        returning << QPair<int,int>(from, qMin(count, from+step));
+    return returning;
+}
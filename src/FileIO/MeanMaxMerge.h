@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _GC_MeanMaxMerge_h
+#define _GC_MeanMaxMerge_h 1
+
+#include <QVector>
+#include <QPair>
+#include <QtConcurrent>
+
+//
+// Merging the mean max arrays of many rides into the bests for a date
+// range; the envelope (max at each duration) and which ride it came from.
+//
+// Rides are identified by an int (their position in the list being merged)
+// and the caller maps them back to dates at the end, an int per element
+// keeps the kernels free of branches so the compiler vectorises them.
+//
+// Where values are equal the earlier ride wins, so merging in any grouping
+// gives the same result as merging one ride after another in order.
+//
+namespace MeanMaxMerge
+{
+    // into[i] = max(into[i], other[i]) and who[i] = id where other is better
+    void envelope(double *into, int *who, const double *other, int n, int id);
+    void envelope(float *into, int *who, const float *other, int n, int id);
+    void envelope(float *into, const float *other, int n);
+
+    // the same for two partial envelopes, other being the later rides
+    void envelope(double *into, int *who, const double *other, const int *otherwho, int n);
+    void envelope(float *into, int *who, const float *other, const int *otherwho, int n);
+
+    // count[i]++ where other[i] is within fraction of best[i]
+    void within(float *count, const double *best, const double *other, int n, double fraction);
+
+    // element wise sum
+    void add(double *into, const double *other, int n);
+    void add(float *into, const float *other, int n);
+
+    // grow to fit before merging, new durations are 0 from no ride (-1)
+    template<class T> void fit(QVector<T> &into, QVector<int> &who, int n) {
+        if (into.size() < n) into.resize(n);
+        if (who.size() < n) {
+            int from = who.size();
+            who.resize(n);
+            for (int i=from; i<n; i++) who[i] = -1;
+        }
+    }
+    template<class T> void fit(QVector<T> &into, int n) {
+        if (into.size() < n) into.resize(n);
+    }
+
+    // contiguous ranges of count items to fold one per thread, no fewer
+    // than minimum in each since a thread isn't worth it for a few rides
+    QVector<QPair<int,int> > ranges(int count, int minimum);
+
+    // fold parts into parts[0] as a tree; each level merges pairs of
+    // neighbours in parallel, the later into the earlier. T needs
+    // a merge(const T &later) method.
+    template<class T> void mergePair(QPair<T*,T*> &pair) { pair.first->merge(*pair.second); }
+    template<class T> void reduce(QVector<T> &parts) {
+        for (int step=1; step < parts.count(); step *= 2) {
+            QVector<QPair<T*,T*> > pairs;
+            for (int i=0; i+step < parts.count(); i += 2*step)
+                pairs << QPair<T*,T*>(&parts[i], &parts[i+step]);
+            if (pairs.count() == 1) mergePair<T>(pairs[0]);
+            else QtConcurrent::blockingMap(pairs, mergePair<T>);
+        }
+    }
+
+    // fold each part in parallel then reduce them, T needs a fold()
+    // method that reads its share of the rides
+    template<class T> void foldPart(T &part) { part.fold(); }
+    template<class T> void run(QVector<T> &parts) {
+        if (parts.count() == 1) parts[0].fold();
+        else if (parts.count() > 1) QtConcurrent::blockingMap(parts, foldPart<T>);
+        reduce(parts);
+    }
+};
+
+//
+// Bests for a number of series, each with the ride they came from
+//
+template<class T>
+class MeanMaxEnvelope
+{
+    public:
+        MeanMaxEnvelope(int series=0) : values(series), who(series) {}
+
+        void add(int series, const QVector<T> &other, int id) {
+            MeanMaxMerge::fit(values[series], who[series], other.size());
+            MeanMaxMerge::envelope(values[series].data(), who[series].data(), other.constData(), other.size(), id);
+        }
+
+        void merge(const MeanMaxEnvelope<T> &later) {
+            for (int s=0; s<values.count() && s<later.values.count(); s++) {
+                int n = later.values[s].size();
+                MeanMaxMerge::fit(values[s], who[s], n);
+                MeanMaxMerge::envelope(values[s].data(), who[s].data(), later.values[s].constData(), later.who[s].constData(), n);
+            }
+        }
+
+        QVector<QVector<T> > values;
+        QVector<QVector<int> > who;
+};
+
+#endif
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "RideCacheFile.h"
+#include "RideFile.h"
+#include "RideItem.h"
+#include "Context.h"
+#include "Athlete.h"
+
+#include <QFile>
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QDataStream>
+
+void
+RideCacheFile::load(Context *context, RideItem *item)
+{
+    // unsaved changes are only in memory
+    if (item->isDirty()) {
+        build(item->ride());
+        return;
+    }
+
+    QString filename = fileName(context, item);
+    if (!isStale(context, item) && read(filename)) return;
+
+    // build and cache it
+    build(item->ride());
+    write(filename);
+}
+
+void
+RideCacheFile::update(Context *context, RideItem *item, const RideFile *ride)
+{
+    if (!ride || !isStale(context, item)) return;
+
+    build(ride);
+    write(fileName(context, item));
+}
+
+QString
+RideCacheFile::fileName(Context *context, RideItem *item) const
+{
+    QFileInfo rideFileInfo(item->fileName);
+    if (item->planned)
+        return context->athlete->home->cache().canonicalPath() + "/planned/" + rideFileInfo.baseName() + "." + extension;
+    else
+        return context->athlete->home->cache().canonicalPath() + "/" + rideFileInfo.baseName() + "." + extension;
+}
+
+bool
+RideCacheFile::isStale(Context *context, RideItem *item) const
+{
+    QString rideFileName;
+    if (item->planned)
+        rideFileName = context->athlete->home->planned().canonicalPath() + "/" + item->fileName;
+    else
+        rideFileName = context->athlete->home->activities().canonicalPath() + "/" + item->fileName;
+
+    QFileInfo rideFileInfo(rideFileName);
+    QFileInfo cacheFileInfo(fileName(context, item));
+
+    // we check the version when we read it
+    return !cacheFileInfo.exists() || rideFileInfo.lastModified() > cacheFileInfo.lastModified();
+}
+
+bool
+RideCacheFile::read(QString filename)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_0);
+    in.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    quint32 fileMagic, fileVersion;
+    in >> fileMagic >> fileVersion;
+    if (fileMagic != magic || fileVersion != version) return false;
+
+    bool ok = readData(in) && in.status() == QDataStream::Ok;
+    if (!ok) build(NULL);
+    return ok;
+}
+
+bool
+RideCacheFile::write(QString filename) const
+{
+    // written alongside and renamed so a reader never sees half a file
+    QSaveFile file(filename);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_0);
+    out.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    out << magic << version;
+    writeData(out);
+    return file.commit();
+}
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _GC_RideCacheFile_h
+#define _GC_RideCacheFile_h 1
+#include "GoldenCheetah.h"
+
+#include <QString>
+
+class Context;
+class RideFile;
+class RideItem;
+class QDataStream;
+
+// RideCacheFile is the file data derived from a ride is cached in
+// alongside the .cpx, e.g. the power centiles (.cen). It is rebuilt when the ride file is newer, or the magic and
+// version at the start of it don't match.
+//
+// Subclasses build the data from a ride and stream it in and out.
+//
+class RideCacheFile
+{
+    public:
+        RideCacheFile(QString extension, quint32 magic, quint32 version) :
+            extension(extension), magic(magic), version(version) {}
+        virtual ~RideCacheFile() {}
+
+    protected:
+        // from the cache, or built (and cached) if stale, the
+        // subclass constructor calls this since build is virtual
+        void load(Context *context, RideItem *item);
+
+        // called during refresh to bring the cache up to date
+        void update(Context *context, RideItem *item, const RideFile *ride);
+
+        // build from the ride, and clear when it is NULL
+        virtual void build(const RideFile *ride) = 0;
+
+        // the data after the magic and version
+        virtual bool readData(QDataStream &in) = 0;
+        virtual void writeData(QDataStream &out) const = 0;
+
+        bool read(QString filename);
+        bool write(QString filename) const;
+
+        QString fileName(Context *context, RideItem *item) const;
+        bool isStale(Context *context, RideItem *item) const;
+
+    private:
+        QString extension;
+        quint32 magic, version;
+};
+#endif
@@ -0,0 +1,222 @@
+/*
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "RideCentiles.h"
+#include "RideFile.h"
+#include "Units.h"
+
+#include <QDataStream>
+#include <algorithm>
+#include <cmath>
+
+static const quint32 RideCentilesMagic = 0x4743434e; // "GCCN"
+
+RideCentiles::RideCentiles() : RideCacheFile("cen", RideCentilesMagic, RideCentilesVersion)
+{
+}
+
+RideCentiles::RideCentiles(const RideFile *ride) : RideCacheFile("cen", RideCentilesMagic, RideCentilesVersion)
+{
+    build(ride);
+}
+
+RideCentiles::RideCentiles(Context *context, RideItem *item) : RideCacheFile("cen", RideCentilesMagic, RideCentilesVersion)
+{
+    load(context, item);
+}
+
+void
+RideCentiles::refresh(Context *context, RideItem *item, const RideFile *ride)
+{
+    // nothing to rank without power
+    if (!ride || !ride->areDataPresent()->watts) return;
+
+    RideCentiles centiles;
+    centiles.update(context, item, ride);
+}
+
+void
+RideCentiles::deciles(QVector<double> &values, double *out)
+{
+    int n = values.count();
+    for (int i=0; i<centileCount; i++) out[i] = 0;
+    if (n == 0) return;
+
+    // decile i runs from start[i] up to stop[i], the boundaries
+    // are shared when they fall between two values
+    int start[centileCount+1], stop[centileCount];
+    for (int i=0; i<centileCount; i++) {
+        start[i] = int((0.1*i) * n);
+        stop[i] = qMin(n, int(ceil((0.1*(i+1)) * n)));
+    }
+    start[centileCount] = n;
+
+    // we only need the deciles ranked against each other, not the values
+    // within them, so select each boundary in turn from what is left
+    // above the last one rather than sorting everything
+    for (int i=1; i<centileCount; i++)
+        if (start[i] < n) std::nth_element(values.begin() + start[i-1], values.begin() + start[i], values.end());
+
+    out[centileCount-1] = *std::max_element(values.begin() + start[centileCount-1], values.end());
+
+    // the bottom decile isn't plotted, each one above it is shifted down
+    for (int i=centileCount-1; i>0; i--) {
+        double sum = 0;
+        int count = 0;
+        for (int j=start[i]; j<stop[i]; j++) {
+            sum += values[j];
+            count++;
+        }
+        if (sum > 0) out[i-1] = sum / count;
+        else out[i-1] = out[i];
+    }
+}
+
+void
+RideCentiles::add(int duration, QVector<double> &means)
+{
+    double out[centileCount];
+    deciles(means, out);
+
+    secs << duration;
+    for (int i=0; i<centileCount; i++) values[i] << out[i];
+}
+
+// trailing means of every window, in the same order as the values
+static void
+windowMeans(const QVector<double> &values, int windowsize, QVector<double> &means)
+{
+    means.resize(values.count() - windowsize + 1);
+
+    double sum = 0;
+    int index = 0;
+    for (int i=0; i<values.count(); i++) {
+        sum += values[i];
+        if (i > windowsize-1) sum -= values[i-windowsize];
+        if (i >= windowsize-1) means[index++] = sum / windowsize;
+    }
+}
+
+void
+RideCentiles::build(const RideFile *ride)
+{
+    secs.clear();
+    for (int i=0; i<centileCount; i++) values[i].clear();
+    if (!ride || ride->dataPoints().isEmpty() || !ride->areDataPresent()->watts) return;
+
+    double recIntSecs = ride->recIntSecs();
+    int total_secs = (int) ceil(ride->dataPoints().last()->secs);
+    if (recIntSecs <= 0 || total_secs <= 0 || total_secs > SECONDS_IN_A_WEEK) return;
+
+    // power at the recording interval, from 0s with gaps filled
+    QVector<double> watts, times;
+    double lastsecs = 0;
+    double offset = ride->dataPoints().first()->secs;
+    foreach (const RideFilePoint *p, ride->dataPoints()) {
+
+        // drag back to start at 0s
+        double psecs = p->secs - offset;
+
+        // fill in any gaps in recording
+        int count = (psecs - lastsecs - recIntSecs) / recIntSecs;
+
+        // gap more than an hour, damn that ride file is a mess
+        if (count > 3600) count = 1;
+
+        for (int i=0; i<count; i++) {
+            times << round(lastsecs + ((i+1) * recIntSecs * 1000.0) / 1000);
+            watts << 0;
+        }
+        lastsecs = psecs;
+
+        double t = round(psecs * 1000.0) / 1000;
+        if (t > 0) {
+            times << t;
+            watts << round(p->value(RideFile::watts));
+        }
+    }
+
+    QVector<double> means;
+
+    // every second for the first 6 minutes
+    for (int slice=1; slice < 360 && slice < total_secs; slice++) {
+        int windowsize = slice / recIntSecs;
+        if (windowsize < 1) continue;
+        if (windowsize > watts.count()) break;
+
+        windowMeans(watts, windowsize, means);
+        add(slice, means);
+    }
+
+    // after that we work in 5s samples, unless they're already longer
+    QVector<double> downsampled;
+    double samplerate = recIntSecs;
+    if (recIntSecs >= 5) {
+        downsampled = watts;
+    } else {
+        samplerate = 5;
+
+        long five = 5; // start at 1st 5s sample
+        double fivesum = 0;
+        int fivecount = 0;
+        for (int i=0; i<watts.count(); i++) {
+            if (times[i] <= five) {
+                fivesum += watts[i];
+                fivecount++;
+            } else {
+                downsampled << fivesum / fivecount;
+                fivecount = 1;
+                fivesum = watts[i];
+                five += 5;
+            }
+        }
+    }
+
+    for (int slice=360; slice < total_secs;) {
+        int windowsize = slice / samplerate;
+        if (windowsize > downsampled.count()) break;
+
+        windowMeans(downsampled, windowsize, means);
+        add(slice, means);
+
+        // gaps increase as duration increases, since we
+        // require far less precision for the longer durations
+        if (slice < 3600) slice += 20; // 20s up to one hour
+        else if (slice < 7200) slice += 60; // 1m up to two hours
+        else if (slice < 10800) slice += 300; // 5mins up to three hours
+        else slice += 600; // 10mins after that
+    }
+}
+
+bool
+RideCentiles::readData(QDataStream &in)
+{
+    in >> secs;
+    for (int i=0; i<centileCount; i++) in >> values[i];
+
+    bool ok = true;
+    for (int i=0; ok && i<centileCount; i++) ok = values[i].count() == secs.count();
+    return ok;
+}
+
+void
+RideCentiles::writeData(QDataStream &out) const
+{
+    out << secs;
+    for (int i=0; i<centileCount; i++) out << values[i];
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _GC_RideCentiles_h
+#define _GC_RideCentiles_h 1
+#include "GoldenCheetah.h"
+#include "RideCacheFile.h"
+
+#include <QString>
+#include <QVector>
+
+class Context;
+class RideFile;
+class RideItem;
+
+// RideCentiles are the power centiles plotted on the CP chart; for each
+// duration the mean of every window of that length in the ride is ranked
+// and the average of each decile (and the max) is kept.
+//
+// Durations are every second up to 6 minutes, then increasingly sparse
+// as the ride gets longer. They are computed when the ride is refreshed
+// and cached in a file .cen alongside the .cpx so the chart doesn't need
+// to open the ride and rank millions of windows on the GUI thread.
+//
+static const unsigned int RideCentilesVersion = 1;
+// revision history:
+// version  date         description
+// 1        12-Oct-20    Initial - deciles and max for power
+
+class RideCentiles : public RideCacheFile
+{
+    public:
+        static const int centileCount = 10; // 10% .. 90% then max
+
+        // from the cache, or built (and cached) if stale
+        RideCentiles(Context *context, RideItem *item);
+
+        // built from ride data, not cached
+        RideCentiles(const RideFile *ride);
+
+        // called during refresh to bring the cache up to date
+        static void refresh(Context *context, RideItem *item, const RideFile *ride);
+
+        bool isEmpty() const { return secs.isEmpty(); }
+
+        // the durations computed and the centile at each of them
+        const QVector<int> &durations() const { return secs; }
+        const QVector<float> &centile(int i) const { return values[i]; }
+
+        // average of each decile and the max, ranks values in place
+        static void deciles(QVector<double> &values, double *out);
+
+    private:
+        RideCentiles();
+
+        void build(const RideFile *ride);
+        void add(int secs, QVector<double> &means);
+        bool readData(QDataStream &in);
+        void writeData(QDataStream &out) const;
+
+        QVector<int> secs;
+        QVector<float> values[centileCount];
+};
+#endif
@@ -19,6 +19,7 @@
  */
 
 #include "RideFile.h"
+#include "GcbRideFile.h"
 #include "FilterHRV.h"
 #include "WPrime.h"
 #include "Athlete.h"
@@ -868,8 +869,13 @@ RideFile *RideFileFactory::openRideFile(Context *context, QFile &file,
 
     } else {
 
-        // open and read the file
-        result = reader->openRideFile(file, errors, rideList);
+        // library activities are opened from the binary cache when
+        // it is up to date, otherwise parsed and the cache refreshed
+        result = GcbFileReader::openCached(context, file);
+        if (!result) {
+            result = reader->openRideFile(file, errors, rideList);
+            if (result) GcbFileReader::updateCache(context, file, result);
+        }
     }
 
     // if it was successful, lets post process the file
@@ -26,6 +26,8 @@
 #include "PaceZones.h"
 #include "WPrime.h" // for wbal zones
 #include "LTMSettings.h" // getAllBestsFor needs this
+#include "MeanMaxMerge.h"
+#include "Trace.h"
 
 #include <cmath> // for pow()
 #include <QDebug>
@@ -35,6 +37,9 @@
 
 static const int maxcache = 25; // lets max out at 25 caches
 
+// fewer rides than this aren't worth a thread of their own when aggregating
+#define AGGREGATE_PARALLEL_MIN 16
+
 // cache from ride
 RideFileCache::RideFileCache(Context *context, QString fileName, double weight, RideFile *passedride, bool check, bool refresh) :
                incomplete(false), context(context), rideFileName(fileName), ride(passedride)
@@ -303,63 +308,78 @@ static long countForMeanMax(RideFileCacheHeader head, RideFile::SeriesType serie
     return 0;
 }
 
+// a run of rides read on one thread for the power bests below
+struct RideFileCachePower {
+    Context *context;
+    const QStringList *files;
+    int from, to;
+    MeanMaxEnvelope<float> watts;
+    QVector<float> wpk;
+
+    RideFileCachePower() : watts(1) {}
+
+    void fold() {
+        for (int r=from; r<to; r++) {
+            QVector<float> ridewpk;
+            watts.add(0, RideFileCache::meanMaxPowerFor(context, ridewpk, files->at(r)), r);
+
+            MeanMaxMerge::fit(wpk, ridewpk.size());
+            MeanMaxMerge::envelope(wpk.data(), ridewpk.constData(), ridewpk.size());
+        }
+    }
+
+    void merge(const RideFileCachePower &later) {
+        watts.merge(later.watts);
+        MeanMaxMerge::fit(wpk, later.wpk.size());
+        MeanMaxMerge::envelope(wpk.data(), later.wpk.constData(), later.wpk.size());
+    }
+};
+
 QVector<float> RideFileCache::meanMaxPowerFor(Context *context, QVector<float> &wpk, QDate from, QDate to, QVector<QDate>*dates, bool wantruns)
 {
-    QVector<float> returning;
-    QVector<float> returningwpk;
-    bool first = true;
-
     // look at all the rides
+    QStringList files;
+    QVector<QDate> rideDates;
     foreach (RideItem *item, context->athlete->rideCache->rides()) {
 
         if (item->dateTime.date() < from || item->dateTime.date() > to) continue; // not one we want
 
         if (item->isRun != wantruns) continue; // they don't want these
 
-        // get the power data
-        if (first == true) {
-
-            // first time through the whole thing is going to be best
-            returning =  meanMaxPowerFor(context, returningwpk, context->athlete->home->activities().canonicalPath() + "/" + item->fileName);
-
-            // set a;; dates to this
-            if (dates) {
-                dates->resize(returning.size());
-                for(int i=0; i<dates->size(); i++) (*dates)[i]=item->dateTime.date();
-            }
-            first = false;
-
-        } else {
-
-            QVector<float> thiswpk;
-
-            // next time through we should only pick out better times
-            QVector<float> ridebest = meanMaxPowerFor(context, thiswpk, context->athlete->home->activities().canonicalPath() + "/" + item->fileName);
-
-            // do we need to increase the returning array?
-            if (returning.size() < ridebest.size()) returning.resize(ridebest.size());
-            if (dates && dates->size() < ridebest.size()) dates->resize(ridebest.size());
+        files << context->athlete->home->activities().canonicalPath() + "/" + item->fileName;
+        rideDates << item->dateTime.date();
+    }
 
-            // now update where its a better number
-            for (int i=0; i<ridebest.size(); i++) {
-                if (ridebest[i] > returning[i]) {
-                    returning[i] = ridebest[i];
-                    (*dates)[i]=item->dateTime.date();
-                }
-           }
+    // read runs of them in parallel and merge the runs
+    QVector<RideFileCachePower> parts;
+    QVector<QPair<int,int> > ranges = MeanMaxMerge::ranges(files.count(), AGGREGATE_PARALLEL_MIN);
+    for (int i=0; i<ranges.count(); i++) {
+        RideFileCachePower add;
+        add.context = context;
+        add.files = &files;
+        add.from = ranges[i].first;
+        add.to = ranges[i].second;
+        parts << add;
+    }
+    MeanMaxMerge::run(parts);
 
-            // do we need to increase the returning array?
-            if (returningwpk.size() < thiswpk.size()) returningwpk.resize(thiswpk.size());
+    if (parts.isEmpty()) {
+        wpk.clear();
+        if (dates) dates->clear();
+        return QVector<float>();
+    }
 
-            // now update where its a better number
-            for (int i=0; i<thiswpk.size(); i++)
-                if (thiswpk[i] > returningwpk[i]) returningwpk[i] =thiswpk[i];
-        }
+    // the date of the ride each best came from, durations no ride
+    // beat zero for are given to the first ride as they always were
+    if (dates) {
+        const QVector<int> &who = parts[0].watts.who[0];
+        dates->resize(who.size());
+        for (int i=0; i<who.size(); i++) (*dates)[i] = rideDates[who[i] < 0 ? 0 : who[i]];
     }
 
     // set aggregated wpk
-    wpk = returningwpk;
-    return returning;
+    wpk = parts[0].wpk;
+    return parts[0].watts.values[0];
 }
 
 QVector<float> RideFileCache::meanMaxPowerFor(Context *context, QVector<float>&wpk, QString fileName)
@@ -916,6 +936,8 @@ void RideFileCache::RideFileCache::compute()
         return;
     }
 
+    GC_TRACE_SPAN("RideFileCache::compute");
+
     // all the mean maxes
     MeanMaxComputer thread1(ride, wattsMeanMax, RideFile::watts); thread1.start();
     MeanMaxComputer thread2(ride, hrMeanMax, RideFile::hr); thread2.start();
@@ -1216,6 +1238,9 @@ divided_max_mean(data_t *dataseries_i, int datalength, int length, int *offset)
 void
 MeanMaxComputer::run()
 {
+    GC_TRACE_THREAD("MeanMaxComputer");
+    GC_TRACE_SPAN("MeanMaxComputer::run");
+
     // xPower and IsoPower need watts to be present
     RideFile::SeriesType baseSeries = (series == RideFile::xPower || series == RideFile::IsoPower || series == RideFile::wattsKg) ?
                                       RideFile::watts : series;
@@ -1682,32 +1707,181 @@ RideFileCache::computeDistribution(QVector<float> &array, RideFile::SeriesType s
 // AGGREGATE FOR A GIVEN DATE RANGE
 //
 
-// select and update bests
-static void meanMaxAggregate(QVector<double> &into, QVector<double> &other, QVector<QDate>&dates, QDate rideDate)
+// a ride to aggregate, the weight is looked up before the threads start
+// since the athlete's measures can't be read from them
+struct RideFileCacheRide {
+    QString fileName;
+    double weight;
+};
+
+// a run of rides read on one thread and merged with the rest, the
+// arrays in the tables below are in the same order for every cache
+class RideFileCacheAggregate
 {
-    if (into.size() < other.size()) {
-        into.resize(other.size());
-        dates.resize(other.size());
-    }
+    public:
+        static const int meanMaxCount = 16;
+        static const int distributionCount = 12;
+        static const int timeInZoneCount = 7;
+
+        RideFileCacheAggregate() : context(NULL), rides(NULL), from(0), to(0), incomplete(false),
+                                   bests(meanMaxCount), distribution(distributionCount), timeInZone(timeInZoneCount) {}
+
+        static QVector<double> &meanMax(RideFileCache &cache, int i);
+        static QVector<QDate> &meanMaxDates(RideFileCache &cache, int i);
+        static QVector<double> &distributionArray(RideFileCache &cache, int i);
+        static QVector<float> &timeInZoneArray(RideFileCache &cache, int i);
+
+        void fold();
+        void merge(const RideFileCacheAggregate &later);
+
+        // what to read
+        Context *context;
+        const QVector<RideFileCacheRide> *rides;
+        int from, to;
+
+        // what we got
+        bool incomplete;
+        MeanMaxEnvelope<double> bests;
+        QVector<QVector<double> > distribution;
+        QVector<QVector<float> > timeInZone;
+};
 
-    for (int i=0; i<other.size(); i++)
-        if (other[i] > into[i]) {
-            into[i] = other[i];
-            dates[i] = rideDate;
+QVector<double> &
+RideFileCacheAggregate::meanMax(RideFileCache &cache, int i)
+{
+    static QVector<double> RideFileCache::* const table[meanMaxCount] = {
+        &RideFileCache::wattsMeanMaxDouble, &RideFileCache::hrMeanMaxDouble, &RideFileCache::cadMeanMaxDouble,
+        &RideFileCache::nmMeanMaxDouble, &RideFileCache::kphMeanMaxDouble, &RideFileCache::kphdMeanMaxDouble,
+        &RideFileCache::wattsdMeanMaxDouble, &RideFileCache::caddMeanMaxDouble, &RideFileCache::nmdMeanMaxDouble,
+        &RideFileCache::hrdMeanMaxDouble, &RideFileCache::xPowerMeanMaxDouble, &RideFileCache::npMeanMaxDouble,
+        &RideFileCache::vamMeanMaxDouble, &RideFileCache::wattsKgMeanMaxDouble, &RideFileCache::aPowerMeanMaxDouble,
+        &RideFileCache::aPowerKgMeanMaxDouble
+    };
+    return cache.*table[i];
+}
+
+QVector<QDate> &
+RideFileCacheAggregate::meanMaxDates(RideFileCache &cache, int i)
+{
+    static QVector<QDate> RideFileCache::* const table[meanMaxCount] = {
+        &RideFileCache::wattsMeanMaxDate, &RideFileCache::hrMeanMaxDate, &RideFileCache::cadMeanMaxDate,
+        &RideFileCache::nmMeanMaxDate, &RideFileCache::kphMeanMaxDate, &RideFileCache::kphdMeanMaxDate,
+        &RideFileCache::wattsdMeanMaxDate, &RideFileCache::caddMeanMaxDate, &RideFileCache::nmdMeanMaxDate,
+        &RideFileCache::hrdMeanMaxDate, &RideFileCache::xPowerMeanMaxDate, &RideFileCache::npMeanMaxDate,
+        &RideFileCache::vamMeanMaxDate, &RideFileCache::wattsKgMeanMaxDate, &RideFileCache::aPowerMeanMaxDate,
+        &RideFileCache::aPowerKgMeanMaxDate
+    };
+    return cache.*table[i];
+}
+
+QVector<double> &
+RideFileCacheAggregate::distributionArray(RideFileCache &cache, int i)
+{
+    static QVector<double> RideFileCache::* const table[distributionCount] = {
+        &RideFileCache::wattsDistributionDouble, &RideFileCache::hrDistributionDouble, &RideFileCache::cadDistributionDouble,
+        &RideFileCache::gearDistributionDouble, &RideFileCache::nmDistributionDouble, &RideFileCache::kphDistributionDouble,
+        &RideFileCache::xPowerDistributionDouble, &RideFileCache::npDistributionDouble, &RideFileCache::wattsKgDistributionDouble,
+        &RideFileCache::aPowerDistributionDouble, &RideFileCache::smo2DistributionDouble, &RideFileCache::wbalDistributionDouble
+    };
+    return cache.*table[i];
+}
+
+QVector<float> &
+RideFileCacheAggregate::timeInZoneArray(RideFileCache &cache, int i)
+{
+    static QVector<float> RideFileCache::* const table[timeInZoneCount] = {
+        &RideFileCache::wattsTimeInZone, &RideFileCache::wattsCPTimeInZone, &RideFileCache::hrTimeInZone,
+        &RideFileCache::hrCPTimeInZone, &RideFileCache::paceTimeInZone, &RideFileCache::paceCPTimeInZone,
+        &RideFileCache::wbalTimeInZone
+    };
+    return cache.*table[i];
+}
+
+void
+RideFileCacheAggregate::fold()
+{
+    GC_TRACE_THREAD("Worker");
+    GC_TRACE_SPAN("RideFileCacheAggregate::fold");
+
+    for (int r=from; r<to; r++) {
+
+        // get its cached values (will NOT! refresh if needed...)
+        RideFileCache rideCache(context, rides->at(r).fileName, rides->at(r).weight, NULL, false, false);
+        if (rideCache.incomplete == true) {
+            // ack, data not available !
+            incomplete = true;
+            continue;
         }
+
+        for (int i=0; i<meanMaxCount; i++) bests.add(i, meanMax(rideCache, i), r);
+
+        for (int i=0; i<distributionCount; i++) {
+            const QVector<double> &other = distributionArray(rideCache, i);
+            MeanMaxMerge::fit(distribution[i], other.size());
+            MeanMaxMerge::add(distribution[i].data(), other.constData(), other.size());
+        }
+
+        for (int i=0; i<timeInZoneCount; i++) {
+            const QVector<float> &other = timeInZoneArray(rideCache, i);
+            MeanMaxMerge::fit(timeInZone[i], other.size());
+            MeanMaxMerge::add(timeInZone[i].data(), other.constData(), other.size());
+        }
+    }
+}
+
+void
+RideFileCacheAggregate::merge(const RideFileCacheAggregate &later)
+{
+    incomplete = incomplete || later.incomplete;
+    bests.merge(later.bests);
+
+    for (int i=0; i<distributionCount; i++) {
+        MeanMaxMerge::fit(distribution[i], later.distribution[i].size());
+        MeanMaxMerge::add(distribution[i].data(), later.distribution[i].constData(), later.distribution[i].size());
+    }
+    for (int i=0; i<timeInZoneCount; i++) {
+        MeanMaxMerge::fit(timeInZone[i], later.timeInZone[i].size());
+        MeanMaxMerge::add(timeInZone[i].data(), later.timeInZone[i].constData(), later.timeInZone[i].size());
+    }
 }
 
-// resize into and then sum the arrays
-static void distAggregate(QVector<double> &into, QVector<double> &other)
+// the rides in the date range passing the filters, the same selection is
+// used for the aggregate and the heat so they match
+static QVector<RideFileCacheRide>
+aggregateRides(Context *context, QDate start, QDate end, bool filter, QStringList &files, bool onhome,
+               RideItem *rideItem, QVector<QDate> *dates)
 {
-    if (into.size() < other.size()) into.resize(other.size());
-    for (int i=0; i<other.size(); i++) into[i] += other[i];
+    QVector<RideFileCacheRide> returning;
+
+    // Iterate over the ride files (not the cpx files since they /might/ not
+    // exist, or /might/ be out of date.
+    foreach (RideItem *item, context->athlete->rideCache->rides()) {
+
+        QDate rideDate = item->dateTime.date();
+
+        if (((filter == true && files.contains(item->fileName)) || filter == false) &&
+            rideDate >= start && rideDate <= end) {
+
+            // skip globally filtered values
+            if (context->isfiltered && !context->filters.contains(item->fileName)) continue;
+            if (onhome && context->ishomefiltered && !context->homeFilters.contains(item->fileName)) continue;
+            // skip other sports if rideItem is given
+            if (rideItem && ((rideItem->isRun != item->isRun) || (rideItem->isSwim != item->isSwim))) continue;
 
+            RideFileCacheRide add;
+            add.fileName = context->athlete->home->activities().canonicalPath() + "/" + item->fileName;
+            add.weight = item->getWeight();
+            returning << add;
+            if (dates) *dates << rideDate;
+        }
+    }
+    return returning;
 }
 
 RideFileCache::RideFileCache(Context *context, QDate start, QDate end, bool filter, QStringList files, bool onhome, RideItem *rideItem)
                : start(start), end(end), incomplete(false), context(context), rideFileName(""), ride(0)
 {
+    GC_TRACE_SPAN("RideFileCache::aggregate");
 
     // remember parameters for getting heat
     this->filter = filter;
@@ -1773,73 +1947,44 @@ RideFileCache::RideFileCache(Context *context, QDate start, QDate end, bool filt
     // and less intrusive than a popup box
     context->mainWindow->setCursor(Qt::WaitCursor);
 
-    // Iterate over the ride files (not the cpx files since they /might/ not
-    // exist, or /might/ be out of date.
-    foreach (RideItem *item, context->athlete->rideCache->rides()) {
+    // the rides to aggregate
+    QVector<QDate> dates;
+    QVector<RideFileCacheRide> rides = aggregateRides(context, start, end, filter, files, onhome, rideItem, &dates);
+
+    // read runs of them in parallel and then merge the runs
+    QVector<RideFileCacheAggregate> parts;
+    QVector<QPair<int,int> > ranges = MeanMaxMerge::ranges(rides.count(), AGGREGATE_PARALLEL_MIN);
+    for (int i=0; i<ranges.count(); i++) {
+        RideFileCacheAggregate add;
+        add.context = context;
+        add.rides = &rides;
+        add.from = ranges[i].first;
+        add.to = ranges[i].second;
+        parts << add;
+    }
+    MeanMaxMerge::run(parts);
 
-        QDate rideDate = item->dateTime.date();
+    if (parts.count()) {
+        RideFileCacheAggregate &all = parts[0];
+        if (all.incomplete) incomplete = true;
 
-        if (((filter == true && files.contains(item->fileName)) || filter == false) &&
-            rideDate >= start && rideDate <= end) {
+        // bests and the date of the ride they came from
+        for (int i=0; i<RideFileCacheAggregate::meanMaxCount; i++) {
+            const QVector<int> &who = all.bests.who[i];
+            QVector<QDate> &when = RideFileCacheAggregate::meanMaxDates(*this, i);
 
-            // skip globally filtered values
-            if (context->isfiltered && !context->filters.contains(item->fileName)) continue;
-            if (onhome && context->ishomefiltered && !context->homeFilters.contains(item->fileName)) continue;
-            // skip other sports if rideItem is given
-            if (rideItem && ((rideItem->isRun != item->isRun) || (rideItem->isSwim != item->isSwim))) continue;
+            RideFileCacheAggregate::meanMax(*this, i) = all.bests.values[i];
+            when.resize(who.size());
+            for (int j=0; j<who.size(); j++) when[j] = who[j] < 0 ? QDate() : dates[who[j]];
+        }
 
-            // get its cached values (will NOT! refresh if needed...)
-            // the true means it will check only
-            RideFileCache rideCache(context, context->athlete->home->activities().canonicalPath() + "/" + item->fileName, item->getWeight(), NULL, false, false);
-            if (rideCache.incomplete == true) {
-                // ack, data not available !
-                incomplete = true;
-            } else {
-
-                // lets aggregate
-                meanMaxAggregate(wattsMeanMaxDouble, rideCache.wattsMeanMaxDouble, wattsMeanMaxDate, rideDate);
-                meanMaxAggregate(hrMeanMaxDouble, rideCache.hrMeanMaxDouble, hrMeanMaxDate, rideDate);
-                meanMaxAggregate(cadMeanMaxDouble, rideCache.cadMeanMaxDouble, cadMeanMaxDate, rideDate);
-                meanMaxAggregate(nmMeanMaxDouble, rideCache.nmMeanMaxDouble, nmMeanMaxDate, rideDate);
-                meanMaxAggregate(kphMeanMaxDouble, rideCache.kphMeanMaxDouble, kphMeanMaxDate, rideDate);
-                meanMaxAggregate(kphdMeanMaxDouble, rideCache.kphdMeanMaxDouble, kphdMeanMaxDate, rideDate);
-                meanMaxAggregate(wattsdMeanMaxDouble, rideCache.wattsdMeanMaxDouble, wattsdMeanMaxDate, rideDate);
-                meanMaxAggregate(caddMeanMaxDouble, rideCache.caddMeanMaxDouble, caddMeanMaxDate, rideDate);
-                meanMaxAggregate(nmdMeanMaxDouble, rideCache.nmdMeanMaxDouble, nmdMeanMaxDate, rideDate);
-                meanMaxAggregate(hrdMeanMaxDouble, rideCache.hrdMeanMaxDouble, hrdMeanMaxDate, rideDate);
-                meanMaxAggregate(xPowerMeanMaxDouble, rideCache.xPowerMeanMaxDouble, xPowerMeanMaxDate, rideDate);
-                meanMaxAggregate(npMeanMaxDouble, rideCache.npMeanMaxDouble, npMeanMaxDate, rideDate);
-                meanMaxAggregate(vamMeanMaxDouble, rideCache.vamMeanMaxDouble, vamMeanMaxDate, rideDate);
-                meanMaxAggregate(wattsKgMeanMaxDouble, rideCache.wattsKgMeanMaxDouble, wattsKgMeanMaxDate, rideDate);
-                meanMaxAggregate(aPowerMeanMaxDouble, rideCache.aPowerMeanMaxDouble, aPowerMeanMaxDate, rideDate);
-                meanMaxAggregate(aPowerKgMeanMaxDouble, rideCache.aPowerKgMeanMaxDouble, aPowerKgMeanMaxDate, rideDate);
-
-                distAggregate(wattsDistributionDouble, rideCache.wattsDistributionDouble);
-                distAggregate(hrDistributionDouble, rideCache.hrDistributionDouble);
-                distAggregate(cadDistributionDouble, rideCache.cadDistributionDouble);
-                distAggregate(gearDistributionDouble, rideCache.gearDistributionDouble);
-                distAggregate(nmDistributionDouble, rideCache.nmDistributionDouble);
-                distAggregate(kphDistributionDouble, rideCache.kphDistributionDouble);
-                distAggregate(xPowerDistributionDouble, rideCache.xPowerDistributionDouble);
-                distAggregate(npDistributionDouble, rideCache.npDistributionDouble);
-                distAggregate(wattsKgDistributionDouble, rideCache.wattsKgDistributionDouble);
-                distAggregate(aPowerDistributionDouble, rideCache.aPowerDistributionDouble);
-                distAggregate(smo2DistributionDouble, rideCache.smo2DistributionDouble);
-                distAggregate(wbalDistributionDouble, rideCache.wbalDistributionDouble);
-
-                // cumulate timeinzones
-                for (int i=0; i<10; i++) {
-                    paceTimeInZone[i] += rideCache.paceTimeInZone[i];
-                    hrTimeInZone[i] += rideCache.hrTimeInZone[i];
-                    wattsTimeInZone[i] += rideCache.wattsTimeInZone[i];
-                    if (i<4) {
-                        paceCPTimeInZone[i] += rideCache.paceCPTimeInZone[i];
-                        hrCPTimeInZone[i] += rideCache.hrCPTimeInZone[i];
-                        wattsCPTimeInZone[i] += rideCache.wattsCPTimeInZone[i];
-                        wbalTimeInZone[i] += rideCache.wbalTimeInZone[i];
-                    }
-                }
-            }
+        for (int i=0; i<RideFileCacheAggregate::distributionCount; i++)
+            RideFileCacheAggregate::distributionArray(*this, i) = all.distribution[i];
+
+        // time in zone are fixed size
+        for (int i=0; i<RideFileCacheAggregate::timeInZoneCount; i++) {
+            QVector<float> &into = RideFileCacheAggregate::timeInZoneArray(*this, i);
+            for (int j=0; j<into.size() && j<all.timeInZone[i].size(); j++) into[j] = all.timeInZone[i][j];
         }
     }
 
@@ -1860,38 +2005,58 @@ RideFileCache::RideFileCache(Context *context, QDate start, QDate end, bool filt
 //
 // Get heat mean max -- if an aggregated curve
 //
-QVector<float> &RideFileCache::heatMeanMaxArray()
-{
-    // not aggregated or already done it return the result
-    if (ride || heatMeanMax.count()) return heatMeanMax;
 
-    // make it big enough
-    heatMeanMax.resize(wattsMeanMaxDouble.size());
+// a run of rides read on one thread, counting how often each duration
+// was close to the best
+struct RideFileCacheHeat {
+    Context *context;
+    const QVector<RideFileCacheRide> *rides;
+    const QVector<double> *best;
+    int from, to;
+    QVector<float> heat;
 
-    // ok, we need to iterate again and compute heat based upon
-    // how close to the absolute best we've got
-    foreach(RideItem *item, context->athlete->rideCache->rides()) {
-
-        QDate rideDate = item->dateTime.date();
+    void fold() {
+        heat.fill(0, best->size());
+        for (int r=from; r<to; r++) {
 
-        if (((filter == true && files.contains(item->fileName)) || filter == false) &&
-            rideDate >= start && rideDate <= end) {
+            // get its cached values (will refresh if needed...)
+            RideFileCache rideCache(context, rides->at(r).fileName, rides->at(r).weight);
 
-            // skip globally filtered values
-            if (context->isfiltered && !context->filters.contains(item->fileName)) continue;
-            if (onhome && context->ishomefiltered && !context->homeFilters.contains(item->fileName)) continue;
+            // is it within 10% of the best we have ?
+            int n = qMin(rideCache.meanMaxArray(RideFile::watts).size(), best->size());
+            MeanMaxMerge::within(heat.data(), best->constData(), rideCache.meanMaxArray(RideFile::watts).constData(), n, 0.9f);
+        }
+    }
 
-            // get its cached values (will refresh if needed...)
-            RideFileCache rideCache(context, context->athlete->home->activities().canonicalPath() + "/" + item->fileName, item->getWeight());
+    void merge(const RideFileCacheHeat &later) {
+        MeanMaxMerge::add(heat.data(), later.heat.constData(), qMin(heat.size(), later.heat.size()));
+    }
+};
 
-            for(int i=0; i<rideCache.wattsMeanMaxDouble.count() && i<wattsMeanMaxDouble.count(); i++) {
+QVector<float> &RideFileCache::heatMeanMaxArray()
+{
+    // not aggregated or already done it return the result
+    if (ride || heatMeanMax.count()) return heatMeanMax;
 
-                // is it within 10% of the best we have ?
-                if (rideCache.wattsMeanMaxDouble[i] >= (0.9f * wattsMeanMaxDouble[i]))
-                    heatMeanMax[i] = heatMeanMax[i] + 1;
-            }
-        }
+    // ok, we need to iterate again and compute heat based upon
+    // how close to the absolute best we've got
+    QVector<RideFileCacheRide> rides = aggregateRides(context, start, end, filter, files, onhome, NULL, NULL);
+
+    QVector<RideFileCacheHeat> parts;
+    QVector<QPair<int,int> > ranges = MeanMaxMerge::ranges(rides.count(), AGGREGATE_PARALLEL_MIN);
+    for (int i=0; i<ranges.count(); i++) {
+        RideFileCacheHeat add;
+        add.context = context;
+        add.rides = &rides;
+        add.best = &wattsMeanMaxDouble;
+        add.from = ranges[i].first;
+        add.to = ranges[i].second;
+        parts << add;
     }
+    MeanMaxMerge::run(parts);
+
+    if (parts.count()) heatMeanMax = parts[0].heat;
+    else heatMeanMax.resize(wattsMeanMaxDouble.size());
 
     return heatMeanMax;
 }
@@ -244,6 +244,8 @@ class RideFileCache
 
     private:
 
+        friend class RideFileCacheAggregate; // merges our arrays
+
         Context *context;
         QString rideFileName; // filename of ride
         QString cacheFileName; // filename of cache file
@@ -50,6 +50,15 @@ RideFileCommand::setPointValue(int index, RideFile::SeriesType series, double va
     doCommand(cmd);
 }
 
+void
+RideFileCommand::setPointValues(int index, RideFile::SeriesType series, QVector<double> values)
+{
+    // only bother if something changes
+    SetPointValuesCommand *cmd = new SetPointValuesCommand(ride, index, series, values);
+    if (cmd->isEmpty()) delete cmd;
+    else doCommand(cmd);
+}
+
 void
 RideFileCommand::deletePoint(int index)
 {
@@ -363,6 +372,62 @@ SetPointValueCommand::undoCommand()
     return true;
 }
 
+// Set a range of values
+SetPointValuesCommand::SetPointValuesCommand(RideFile *ride, int row,
+            RideFile::SeriesType series, QVector<double> values) :
+            RideCommand(ride), // base class looks after these
+            row(row), count(0), series(series)
+{
+    type = RideCommand::SetPointValues;
+    description = tr("Set Values");
+
+    int n = qMin(values.count(), ride->dataPoints().count() - row);
+    for (int i=0; i<n; i++) {
+        double oldvalue = ride->getPointValue(row+i, series);
+        if (doubles_equal(oldvalue, values[i])) continue;
+
+        // extend the current run or start a new one
+        if (runs.count() && runs.last().row + runs.last().count == row+i) runs.last().count++;
+        else {
+            Run run;
+            run.row = row+i;
+            run.count = 1;
+            runs << run;
+        }
+        oldvalues << oldvalue;
+        newvalues << values[i];
+    }
+
+    // the range actually touched
+    if (runs.count()) {
+        this->row = runs.first().row;
+        count = runs.last().row + runs.last().count - this->row;
+    }
+}
+
+void
+SetPointValuesCommand::apply(const QVector<double> &values)
+{
+    int k=0;
+    foreach(Run run, runs)
+        for (int i=0; i<run.count; i++)
+            ride->setPointValue(run.row+i, series, values[k++]);
+}
+
+bool
+SetPointValuesCommand::doCommand()
+{
+    apply(newvalues);
+    return true;
+}
+
+bool
+SetPointValuesCommand::undoCommand()
+{
+    apply(oldvalues);
+    return true;
+}
+
 // Remove a point
 DeletePointCommand::DeletePointCommand(RideFile *ride, int row, RideFilePoint point) :
         RideCommand(ride), // base class looks after these
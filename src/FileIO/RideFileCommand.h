@@ -49,6 +49,7 @@ class RideFileCommand : public QObject
         virtual ~RideFileCommand();
 
         void setPointValue(int index, RideFile::SeriesType series, double value);
+        void setPointValues(int index, RideFile::SeriesType series, QVector<double> values); // replace a range
         void deletePoint(int index);
         void deletePoints(int index, int count);
         void insertPoint(int index, RideFilePoint *point);
@@ -104,7 +105,7 @@ class RideCommand
 {
     public:
         // supported command types
-        enum commandtype { NoOp, LUW, SetPointValue, DeletePoint, DeletePoints, InsertPoint, AppendPoints, SetDataPresent,
+        enum commandtype { NoOp, LUW, SetPointValue, SetPointValues, DeletePoint, DeletePoints, InsertPoint, AppendPoints, SetDataPresent,
                            removeXData, addXData, RemoveXDataSeries, AddXDataSeries,
                            SetXDataPointValue, DeleteXDataPoints, InsertXDataPoint, AppendXDataPoints };
         typedef enum commandtype CommandType;
@@ -209,6 +210,32 @@ class SetPointValueCommand : public RideCommand
         double oldvalue, newvalue;
 };
 
+// replace a range of values in a series, only the values that
+// actually change are kept, as runs of consecutive rows
+class SetPointValuesCommand : public RideCommand
+{
+    Q_DECLARE_TR_FUNCTIONS(SetPointValuesCommand)
+
+    public:
+        SetPointValuesCommand(RideFile *ride, int row, RideFile::SeriesType series, QVector<double> values);
+        bool doCommand();
+        bool undoCommand();
+
+        // nothing to do ?
+        bool isEmpty() const { return runs.isEmpty(); }
+
+        // state
+        int row, count; // first and number of rows changed
+        RideFile::SeriesType series;
+
+        struct Run { int row, count; };
+        QVector<Run> runs;
+        QVector<double> oldvalues, newvalues; // for each row in the runs
+
+    private:
+        void apply(const QVector<double> &values);
+};
+
 class SetXDataPointValueCommand : public RideCommand
 {
     Q_DECLARE_TR_FUNCTIONS(SetXDataPointValueCommand)
@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "RideHeatMap.h"
+#include "RideFile.h"
+#include "Context.h"
+#include "Athlete.h"
+
+#include <QFile>
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QDataStream>
+#include <QVector>
+#include <algorithm>
+#include <cmath>
+
+static const quint32 RideHeatMapMagic = 0x4743484d; // "GCHM"
+
+RideHeatMap::RideHeatMap(const RideFile *ride) : minLat(0), maxLat(0), minLon(0), maxLon(0)
+{
+    if (!ride || !ride->areDataPresent()->lat || !ride->areDataPresent()->lon) return;
+
+    int lastDistance = 0;
+    foreach(const RideFilePoint *point, ride->dataPoints()) {
+
+        if (lastDistance < (int) (point->km * 1000) && (point->lon!=0 || point->lat!=0)) {
+
+            // Pick up a point max every 15m
+            lastDistance = (int) (point->km * 1000) + 15;
+            add(qint32(floor(point->lat * scale)), qint32(floor(point->lon * scale)), 1);
+        }
+    }
+}
+
+void
+RideHeatMap::add(qint32 lat, qint32 lon, int count)
+{
+    if (cells.isEmpty()) {
+        minLat = maxLat = lat;
+        minLon = maxLon = lon;
+    } else {
+        if (lat < minLat) minLat = lat;
+        if (lat > maxLat) maxLat = lat;
+        if (lon < minLon) minLon = lon;
+        if (lon > maxLon) maxLon = lon;
+    }
+    cells[key(lat, lon)] += count;
+}
+
+void
+RideHeatMap::merge(const RideHeatMap &other)
+{
+    QHashIterator<quint64, int> i(other.cells);
+    while (i.hasNext()) {
+        i.next();
+        add(qint32(i.key() >> 32), qint32(i.key() & 0xffffffff), i.value());
+    }
+}
+
+bool
+RideHeatMap::load(Context *context, QString filename)
+{
+    QFileInfo rideFileInfo(context->athlete->home->activities().canonicalPath() + "/" + filename);
+    QString cacheFileName = context->athlete->home->cache().canonicalPath() + "/" + rideFileInfo.baseName() + ".hmp";
+    QFileInfo cacheFileInfo(cacheFileName);
+
+    // we check the version when we read it
+    if (cacheFileInfo.exists() && cacheFileInfo.lastModified() >= rideFileInfo.lastModified() && read(cacheFileName))
+        return true;
+
+    QStringList errors;
+    QFile file(rideFileInfo.absoluteFilePath());
+    RideFile *ride = RideFileFactory::instance().openRideFile(context, file, errors);
+    if (!ride) return false;
+
+    *this = RideHeatMap(ride);
+    delete ride;
+
+    write(cacheFileName);
+    return true;
+}
+
+QByteArray
+RideHeatMap::toBinary() const
+{
+    QVector<quint64> keys;
+    keys.reserve(cells.count());
+    QHashIterator<quint64, int> i(cells);
+    while (i.hasNext()) {
+        i.next();
+        keys << i.key();
+    }
+
+    // sort on the signed coordinates so the order is lat then lon
+    QVector<QPair<qint32,qint32> > coords(keys.count());
+    for (int k=0; k<keys.count(); k++) coords[k] = QPair<qint32,qint32>(qint32(keys[k] >> 32), qint32(keys[k] & 0xffffffff));
+    std::sort(coords.begin(), coords.end());
+
+    QByteArray returning;
+    QDataStream out(&returning, QIODevice::WriteOnly);
+    out.setByteOrder(QDataStream::LittleEndian);
+    for (int k=0; k<coords.count(); k++)
+        out << coords[k].first << coords[k].second << qint32(cells.value(key(coords[k].first, coords[k].second)));
+    return returning;
+}
+
+bool
+RideHeatMap::read(QString filename)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_0);
+
+    quint32 magic, version;
+    in >> magic >> version;
+    if (magic != RideHeatMapMagic || version != RideHeatMapVersion) return false;
+
+    qint32 count;
+    in >> count;
+    cells.clear();
+    for (int k=0; k<count && in.status() == QDataStream::Ok; k++) {
+        qint32 lat, lon, value;
+        in >> lat >> lon >> value;
+        add(lat, lon, value);
+    }
+
+    bool ok = in.status() == QDataStream::Ok;
+    if (!ok) cells.clear();
+    return ok;
+}
+
+bool
+RideHeatMap::write(QString filename) const
+{
+    // written alongside and renamed so a reader never sees half a file
+    QSaveFile file(filename);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_0);
+
+    out << RideHeatMapMagic << quint32(RideHeatMapVersion);
+    out << qint32(cells.count());
+    QHashIterator<quint64, int> i(cells);
+    while (i.hasNext()) {
+        i.next();
+        out << qint32(i.key() >> 32) << qint32(i.key() & 0xffffffff) << qint32(i.value());
+    }
+    return file.commit();
+}
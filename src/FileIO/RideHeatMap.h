@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _GC_RideHeatMap_h
+#define _GC_RideHeatMap_h 1
+#include "GoldenCheetah.h"
+
+#include <QString>
+#include <QHash>
+#include <QByteArray>
+
+class Context;
+class RideFile;
+
+// RideHeatMap counts how often a ride passes through each cell of a
+// grid of 1/100000th of a degree of latitude and longitude, sampling
+// the track no more than every 15m. The grids for each ride can be
+// merged to build a heat map across many rides.
+//
+// They are cached in a file .hmp alongside the .cpx, so regenerating
+// a heat map only needs to open the rides that have changed since.
+//
+static const unsigned int RideHeatMapVersion = 1;
+// revision history:
+// version  date         description
+// 1        14-Oct-20    Initial - 1e-5 degree cells
+
+class RideHeatMap
+{
+    public:
+        static const int scale = 100000; // cells per degree
+
+        RideHeatMap() : minLat(0), maxLat(0), minLon(0), maxLon(0) {}
+
+        // built from ride data, not cached
+        RideHeatMap(const RideFile *ride);
+
+        // from the cache, or opened, built (and cached) if stale
+        // returns false if the ride could not be read
+        bool load(Context *context, QString filename);
+
+        // add the counts from another grid
+        void merge(const RideHeatMap &other);
+
+        bool isEmpty() const { return cells.isEmpty(); }
+        int count() const { return cells.count(); }
+
+        // bounds in degrees
+        double south() const { return double(minLat) / scale; }
+        double north() const { return double(maxLat) / scale; }
+        double west() const { return double(minLon) / scale; }
+        double east() const { return double(maxLon) / scale; }
+
+        // lat, lon (in cells) and count for each cell as little endian
+        // 32 bit integers, sorted by lat then lon
+        QByteArray toBinary() const;
+
+    private:
+        static quint64 key(qint32 lat, qint32 lon) { return (quint64(quint32(lat)) << 32) | quint32(lon); }
+        void add(qint32 lat, qint32 lon, int count);
+
+        bool read(QString filename);
+        bool write(QString filename) const;
+
+        QHash<quint64, int> cells;
+        qint32 minLat, maxLat, minLon, maxLon;
+};
+#endif
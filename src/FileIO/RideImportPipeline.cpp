@@ -0,0 +1,417 @@
+/*
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "RideImportPipeline.h"
+
+#include "Context.h"
+#include "Athlete.h"
+#include "RideItem.h"
+#include "RideFile.h"
+#include "JsonRideFile.h"
+#include "DataProcessor.h"
+#include "RideMetadata.h" // for linked defaults processing
+
+#include <QApplication>
+#include <QEventLoop>
+#include <QFileInfo>
+#include <QFile>
+
+//
+// Queue between stages
+//
+void
+RideImportQueue::open(int n)
+{
+    QMutexLocker locker(&lock);
+    producers = n;
+}
+
+void
+RideImportQueue::done()
+{
+    QMutexLocker locker(&lock);
+    if (--producers <= 0) notEmpty.wakeAll();
+}
+
+void
+RideImportQueue::cancel()
+{
+    QMutexLocker locker(&lock);
+    cancelled = true;
+    notEmpty.wakeAll();
+    notFull.wakeAll();
+}
+
+bool
+RideImportQueue::put(int job)
+{
+    QMutexLocker locker(&lock);
+    while (!cancelled && queue.count() >= capacity) notFull.wait(&lock);
+    if (cancelled) return false;
+
+    queue.enqueue(job);
+    notEmpty.wakeOne();
+    return true;
+}
+
+bool
+RideImportQueue::take(int &job)
+{
+    QMutexLocker locker(&lock);
+    while (!cancelled && queue.isEmpty() && producers > 0) notEmpty.wait(&lock);
+    if (cancelled || queue.isEmpty()) return false;
+
+    job = queue.dequeue();
+    notFull.wakeOne();
+    return true;
+}
+
+//
+// Worker for a stage
+//
+void
+RideImportWorker::run()
+{
+    int index;
+    forever {
+
+        // parsing is throttled by the number of rides in flight,
+        // the GUI adding to the library is the slowest step
+        if (stage == Parse) pipeline->inflight.acquire();
+
+        if (!in->take(index)) {
+            if (stage == Parse) pipeline->inflight.release();
+            break;
+        }
+
+        RideImportJob &job = pipeline->work[index];
+        if (stage == Parse) job.holding = true;
+
+        bool ok = !pipeline->cancelled;
+        if (ok) {
+            switch (stage) {
+            case Parse : ok = pipeline->parseJob(job); break;
+            case Process : ok = pipeline->processJob(job); break;
+            case Convert : ok = pipeline->convertJob(job); break;
+            case Write : ok = pipeline->writeJob(job); break;
+            }
+        }
+
+        // pass it on, or back to the GUI if its done (or failed)
+        if (!ok || out == NULL || !out->put(index)) {
+            job.ok = ok && out == NULL;
+            QMetaObject::invokeMethod(pipeline, "add", Qt::QueuedConnection, Q_ARG(int, index));
+        }
+    }
+
+    if (out) out->done();
+    QMetaObject::invokeMethod(pipeline, "workerExited", Qt::QueuedConnection);
+}
+
+//
+// The pipeline
+//
+RideImportPipeline::RideImportPipeline(Context *context, QList<RideImportJob> jobs, bool addToLibrary) :
+    context(context), jobs(jobs.toVector()), addToLibrary(addToLibrary),
+    running(false), cancelled(false), threadsafe(false), exited(0),
+    parsing(qMax(1, jobs.count())), processing(4), converting(4), writing(4)
+{
+    work = this->jobs.data();
+}
+
+RideImportPipeline::~RideImportPipeline()
+{
+    cancel();
+
+    // workers may be waiting on the GUI thread
+    QList<RideImportWorker*> stopping = workers;
+    workers.clear();
+    foreach(RideImportWorker *worker, stopping) {
+        while (!worker->wait(10)) QApplication::processEvents();
+        delete worker;
+    }
+
+    for(int i=0; i<jobs.count(); i++) {
+        delete work[i].ride;
+        work[i].ride = NULL;
+    }
+}
+
+QList<RideImportJob>
+RideImportPipeline::jobsFor(QStringList files, QDir target)
+{
+    QList<RideImportJob> returning;
+    foreach(QString file, files) {
+        RideImportJob add;
+        add.source = file;
+        add.importsTarget = QFileInfo(file).fileName();
+        add.directory = target.canonicalPath();
+        returning << add;
+    }
+    return returning;
+}
+
+bool
+RideImportPipeline::moveFile(const QString &source, const QString &target)
+{
+    QFile r(source);
+
+    // first try it with a rename
+    if (r.rename(target)) return true; // job is done
+
+    // now the harder variant (copy & delete)
+    if (r.copy(target)) {
+        // try to remove - but if this fails, no problem, file has been copied at least
+        r.remove();
+        // even if remove failed, the copy was successful - so GC is fine
+        return true;
+    }
+    return false;
+}
+
+void
+RideImportPipeline::start()
+{
+    if (running) return;
+
+    if (jobs.isEmpty()) {
+        emit finished();
+        return;
+    }
+
+    running = true;
+    cancelled = false;
+    exited = 0;
+
+    // python fixes and the like have to run on the GUI thread
+    threadsafe = DataProcessorFactory::instance().autoProcessThreadSafe("Auto");
+
+    int threads = qMax(1, QThread::idealThreadCount());
+    int processors = threadsafe ? threads : 1;
+
+    inflight.release(threads * 4);
+    for(int i=0; i<jobs.count(); i++) parsing.put(i);
+
+    // parsing has no producers, it was filled up front, json
+    // is written by a single thread as it is disk bound
+    processing.open(threads);
+    converting.open(processors);
+    writing.open(threads);
+
+    for(int i=0; i<threads; i++) workers << new RideImportWorker(this, RideImportWorker::Parse, &parsing, &processing);
+    for(int i=0; i<processors; i++) workers << new RideImportWorker(this, RideImportWorker::Process, &processing, &converting);
+    for(int i=0; i<threads; i++) workers << new RideImportWorker(this, RideImportWorker::Convert, &converting, &writing);
+    workers << new RideImportWorker(this, RideImportWorker::Write, &writing, NULL);
+
+    foreach(RideImportWorker *worker, workers) worker->start();
+}
+
+void
+RideImportPipeline::cancel()
+{
+    if (!running) return;
+
+    cancelled = true;
+    parsing.cancel();
+    processing.cancel();
+    converting.cancel();
+    writing.cancel();
+
+    // wake any parsers waiting for a slot
+    inflight.release(jobs.count());
+}
+
+void
+RideImportPipeline::wait()
+{
+    if (!running) return;
+
+    QEventLoop loop;
+    connect(this, SIGNAL(finished()), &loop, SLOT(quit()));
+    loop.exec();
+}
+
+bool
+RideImportPipeline::parseJob(RideImportJob &job)
+{
+    QFile thisfile(job.source);
+    job.ride = RideFileFactory::instance().openRideFile(context, thisfile, job.errors);
+
+    // did the input file parse ok ? (should be fine here - since it was alrady checked before - but just in case)
+    if (!job.ride) {
+        job.status = tr("Error - Import of activitiy file failed");
+        return false;
+    }
+
+    // it is handed to the GUI thread to add to the library at the end
+    job.ride->moveToThread(qApp->thread());
+
+    // headless we take the names from the ride itself
+    if (!job.startTime.isValid()) {
+        QChar zero = QLatin1Char ( '0' );
+        QDateTime ridedatetime = job.ride->startTime();
+        job.startTime = ridedatetime;
+        job.activitiesTarget = QString ( "%1_%2_%3_%4_%5_%6.json" )
+                .arg ( ridedatetime.date().year(), 4, 10, zero )
+                .arg ( ridedatetime.date().month(), 2, 10, zero )
+                .arg ( ridedatetime.date().day(), 2, 10, zero )
+                .arg ( ridedatetime.time().hour(), 2, 10, zero )
+                .arg ( ridedatetime.time().minute(), 2, 10, zero )
+                .arg ( ridedatetime.time().second(), 2, 10, zero );
+        job.tmpTarget = job.directory + "/" + job.activitiesTarget;
+    }
+
+    // update ridedatetime and set the Source File name
+    job.ride->setStartTime(job.startTime);
+    job.ride->setTag("Source Filename", job.importsTarget);
+    job.ride->setTag("Filename", job.activitiesTarget);
+    if (job.errors.count() > 0)
+        job.ride->setTag("Import errors", job.errors.join("\n"));
+
+    // process linked defaults
+    if (context) context->athlete->rideMetadata()->setLinkedDefaults(job.ride);
+
+    return true;
+}
+
+bool
+RideImportPipeline::processJob(RideImportJob &job)
+{
+    int index = &job - work;
+    emit status(index, tr("Processing..."));
+
+    if (threadsafe) {
+        DataProcessorFactory::instance().autoProcess(job.ride, "Auto", "Import");
+        job.ride->recalculateDerivedSeries();
+    } else {
+        QMetaObject::invokeMethod(this, "processOnGui", Qt::BlockingQueuedConnection, Q_ARG(int, index));
+    }
+    return true;
+}
+
+void
+RideImportPipeline::processOnGui(int index)
+{
+    RideImportJob &job = work[index];
+    if (cancelled || !job.ride) return;
+
+    DataProcessorFactory::instance().autoProcess(job.ride, "Auto", "Import");
+    job.ride->recalculateDerivedSeries();
+}
+
+bool
+RideImportPipeline::convertJob(RideImportJob &job)
+{
+    JsonFileReader reader;
+    job.json = reader.toByteArray(context, job.ride, true, true, true, true);
+    return true;
+}
+
+bool
+RideImportPipeline::writeJob(RideImportJob &job)
+{
+    int index = &job - work;
+    emit status(index, tr("Saving file..."));
+
+    // the json was already created by the convert stage
+    JsonFileReader writer;
+    QFile file(job.tmpTarget);
+    bool ok = writer.writeByteArray(job.json, file);
+    if (!ok) job.status = tr("Error - .JSON creation failed");
+
+    job.json.clear();
+    return ok;
+}
+
+void
+RideImportPipeline::add(int index)
+{
+    RideImportJob &job = work[index];
+
+    if (job.ok && addToLibrary && !cancelled && context) {
+
+        // now try adding the Ride to the RideCache - since this may fail due to various reason, the activity file
+        // is stored in tmpActivities during this process to understand which file has create the problem when restarting GC
+        // - only after the step was successful the file is moved
+        // to the "clean" activities folder
+        context->athlete->addRide(QFileInfo(job.tmpTarget).fileName(),
+                                  jobs.count() < 20 ? true : false, // don't signal if mass importing
+                                  true, true);                      // file is available only in /tmpActivities, so use this one please
+
+        // rideCache is successfully updated, let's move the file to the real /activities
+        if (job.finalTarget == "" || moveFile(job.tmpTarget, job.finalTarget)) {
+            job.status = tr("File Saved");
+            // and correct the path locally stored in Ride Item
+            if (job.finalTarget != "")
+                context->ride->setFileName(QFileInfo(job.finalTarget).canonicalPath(), job.activitiesTarget);
+        } else {
+            job.ok = false;
+            job.status = tr("Error - Moving %1 to activities folder").arg(job.activitiesTarget);
+        }
+
+        // now metrics have been calculated
+        DataProcessorFactory::instance().autoProcess(job.ride, "Save", "ADD");
+
+    } else if (job.ok) {
+
+        job.status = tr("File Saved");
+
+    } else if (job.status == "") {
+
+        job.status = cancelled ? tr("Error - Import aborted") : tr("Error - .JSON creation failed");
+    }
+    emit status(index, job.status);
+
+    // clear
+    delete job.ride;
+    job.ride = NULL;
+    job.json.clear();
+    if (job.holding) {
+        job.holding = false;
+        inflight.release();
+    }
+
+    emit completed(index);
+}
+
+void
+RideImportPipeline::workerExited()
+{
+    // nothing to do if we're being destroyed
+    if (workers.isEmpty() || ++exited < workers.count()) return;
+
+    // all done, anything left was stranded in a queue by a cancel
+    foreach(RideImportWorker *worker, workers) {
+        worker->wait();
+        delete worker;
+    }
+    workers.clear();
+
+    for(int i=0; i<jobs.count(); i++) {
+        delete work[i].ride;
+        work[i].ride = NULL;
+        work[i].json.clear();
+        work[i].holding = false;
+    }
+
+    // reset the throttle for next time
+    inflight.acquire(inflight.available());
+
+    running = false;
+    emit finished();
+}
@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _GC_RideImportPipeline_h
+#define _GC_RideImportPipeline_h 1
+#include "GoldenCheetah.h"
+
+#include <QObject>
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QSemaphore>
+#include <QQueue>
+#include <QVector>
+#include <QList>
+#include <QDateTime>
+#include <QStringList>
+#include <QByteArray>
+#include <QDir>
+
+class Context;
+class RideFile;
+class RideImportPipeline;
+
+// a file to import, filled in by the wizard (or from the
+// ride itself when the start time is left invalid)
+struct RideImportJob {
+
+    RideImportJob() : ride(NULL), holding(false), ok(false) {}
+
+    QString source;             // file to import
+    QDateTime startTime;        // as confirmed by the user
+    QString importsTarget;      // for the "Source Filename" tag
+    QString activitiesTarget;   // yyyy_mm_dd_hh_mm_ss.json
+    QString tmpTarget;          // full path the json is written to
+    QString finalTarget;        // and moved to once added, if set
+    QString directory;          // where to write when the names come from the ride
+
+    // working state, only ever touched by one stage at a time
+    RideFile *ride;
+    QStringList errors;
+    QByteArray json;
+    QString status;             // why it failed
+    bool holding;               // has a slot in the pipeline
+    bool ok;
+};
+
+// queue between stages, put blocks when full and take blocks
+// when empty until all the producers have finished
+class RideImportQueue
+{
+    public:
+        RideImportQueue(int capacity) : capacity(capacity), producers(0), cancelled(false) {}
+
+        void open(int n);       // n producers will put work
+        void done();            // a producer has finished
+        void cancel();          // wake everyone up, we're stopping
+
+        bool put(int job);      // false if cancelled
+        bool take(int &job);    // false when there is no more work
+
+    private:
+        QMutex lock;
+        QWaitCondition notEmpty, notFull;
+        QQueue<int> queue;
+        int capacity, producers;
+        bool cancelled;
+};
+
+// runs one stage of the pipeline
+class RideImportWorker : public QThread
+{
+    public:
+        enum stage { Parse, Process, Convert, Write };
+        typedef enum stage Stage;
+
+        RideImportWorker(RideImportPipeline *pipeline, Stage stage, RideImportQueue *in, RideImportQueue *out) :
+            pipeline(pipeline), stage(stage), in(in), out(out) {}
+
+    protected:
+        void run();
+
+    private:
+        RideImportPipeline *pipeline;
+        Stage stage;
+        RideImportQueue *in, *out;
+};
+
+//
+// Imports files into the library with each step; parse, auto process,
+// convert to json and write, running as a separate stage on worker threads
+// connected by bounded queues. Only the last step, adding the ride to the
+// ride cache, happens on the GUI thread.
+//
+// Data processors that are not thread safe (e.g. python fixes) are still
+// run on the GUI thread, the process stage hands them over and waits.
+//
+// The pipeline can be run without adding to the library, and waited on,
+// so it can be used headless e.g. for benchmarking imports.
+//
+class RideImportPipeline : public QObject
+{
+    Q_OBJECT
+    G_OBJECT
+
+    friend class ::RideImportWorker;
+
+    public:
+
+        RideImportPipeline(Context *context, QList<RideImportJob> jobs, bool addToLibrary=true);
+        ~RideImportPipeline();
+
+        // jobs for the files, target names are worked out from the start
+        // time in the ride file, json is written to the directory passed
+        static QList<RideImportJob> jobsFor(QStringList files, QDir target);
+
+        // rename, or copy and delete if that fails
+        static bool moveFile(const QString &source, const QString &target);
+
+        void start();
+        void cancel();
+        bool isRunning() const { return running; }
+
+        // run an event loop until done, for headless use
+        void wait();
+
+        int count() const { return jobs.count(); }
+        const RideImportJob &job(int i) const { return jobs.at(i); }
+
+    signals:
+
+        void status(int job, QString text); // progress for the wizard
+        void completed(int job);            // saved, or failed
+        void finished();
+
+    private slots:
+
+        // on the GUI thread
+        void processOnGui(int job);
+        void add(int job);
+        void workerExited();
+
+    private:
+
+        // stages, return false and set status if they fail
+        bool parseJob(RideImportJob &job);
+        bool processJob(RideImportJob &job);
+        bool convertJob(RideImportJob &job);
+        bool writeJob(RideImportJob &job);
+
+        Context *context;
+        QVector<RideImportJob> jobs;
+        RideImportJob *work; // stable for workers
+        bool addToLibrary;
+        bool running, cancelled, threadsafe;
+        int exited;
+
+        // stop parsing when the GUI is falling behind
+        QSemaphore inflight;
+
+        RideImportQueue parsing, processing, converting, writing;
+        QList<RideImportWorker*> workers;
+};
+#endif
@@ -165,6 +165,7 @@ GenerateHeatMapDialog::okClicked()
 
     } else if (ok->text() == "Abort" || ok->text() == tr("Abort")) {
         aborted = true;
+        future.cancel();
     } else if (ok->text() == "Finish" || ok->text() == tr("Finish")) {
         accept(); // our work is done!
     }
@@ -176,88 +177,68 @@ GenerateHeatMapDialog::cancelClicked()
     reject();
 }
 
+// runs on a worker thread, opens the ride unless the grid is cached
+static void
+heatMapJob(HeatMapJob &job)
+{
+    job.ok = job.grid.load(job.context, job.filename);
+}
+
 void
-GenerateHeatMapDialog::generateNow()
+GenerateHeatMapDialog::progress(int value)
 {
+    status->setText(QString(tr("Generating Heat Map... %1 of %2")).arg(value).arg(future.progressMaximum()));
+}
 
-    double minLat = 999;
-    double maxLat = -999;
-    double minLon = 999;
-    double maxLon = -999;
-    QHash<QString, int> hash;
+void
+GenerateHeatMapDialog::generateNow()
+{
+    exports = fails = 0;
 
-    // loop through the table and export all selected
+    // the selected rides
+    QVector<HeatMapJob> jobs;
     for(int i=0; i<files->invisibleRootItem()->childCount(); i++) {
-
-        // give user a chance to abort..
-        QApplication::processEvents();
-
-        // did they?
-        if (aborted == true) return; // user aborted!
-
         QTreeWidgetItem *current = files->invisibleRootItem()->child(i);
 
-        // is it selected
         if (static_cast<QCheckBox*>(files->itemWidget(current,0))->isChecked()) {
-
-            files->setCurrentItem(current); QApplication::processEvents();
-
-            // this one then
-            current->setText(4, tr("Reading...")); QApplication::processEvents();
-
-            // open it..
-            QStringList errors;
-            QList<RideFile*> rides;
-            QFile thisfile(QString(context->athlete->home->activities().absolutePath()+"/"+current->text(1)));
-            RideFile *ride = RideFileFactory::instance().openRideFile(context, thisfile, errors, &rides);
-
-            // open success?
-            if (ride) {
-                current->setText(4, tr("Writing...")); QApplication::processEvents();
-
-                if (ride->areDataPresent()->lat == true && ride->areDataPresent()->lon == true) {
-                    int lastDistance = 0;
-                    foreach(const RideFilePoint *point, ride->dataPoints()) {
-
-                        if (lastDistance < (int) (point->km * 1000) &&
-                           (point->lon!=0 || point->lat!=0)) {
-
-                            // Pick up a point max every 15m
-                            lastDistance = (int) (point->km * 1000) + 15;
-                            //outhtml << "  new google.maps.LatLng("<<point->lat<<", "<<point->lon<<"),\n";
-                            QString lonlat = QString("%1,%2").arg(floorf(point->lat*100000)/100000).arg(floorf(point->lon*100000)/100000);
-                            if (hash.contains(lonlat)) {
-                                hash[lonlat] = hash[lonlat] + 1;
-                            } else {
-                                hash[lonlat] = 1;
-                            }
-
-                            if (minLon > point->lon) minLon = point->lon;
-                            if (minLat > point->lat) minLat = point->lat;
-                            if (maxLon < point->lon) maxLon = point->lon;
-                            if (maxLat < point->lat) maxLat = point->lat;
-
-                        }
-
-                    }
-                }
-
-                delete ride; // free memory!
-            // open failed
-            } else {
-                current->setText(4, tr("Read error")); QApplication::processEvents();
-            }
+            HeatMapJob job;
+            job.context = context;
+            job.item = current;
+            job.filename = current->text(1);
+            job.ok = false;
+            jobs << job;
+
+            current->setText(4, tr("Reading..."));
         }
     }
 
-    QHashIterator<QString, int> i(hash);
-    QString datapoints = "";
-    while (i.hasNext()) {
-         i.next();
-         datapoints += QString("[%1,%2],")
-                    .arg(i.key())
-                    .arg(i.value());
+    // grid each ride across the worker threads, the event loop
+    // keeps running so they can abort (which cancels the future)
+    QFutureWatcher<void> watcher;
+    QEventLoop loop;
+    connect(&watcher, SIGNAL(progressValueChanged(int)), this, SLOT(progress(int)));
+    connect(&watcher, SIGNAL(finished()), &loop, SLOT(quit()));
+    future = QtConcurrent::map(jobs, heatMapJob);
+    watcher.setFuture(future);
+    loop.exec();
+    future.waitForFinished();
+
+    if (aborted == true) return; // user aborted!
+
+    // merge them all
+    RideHeatMap heatmap;
+    foreach(const HeatMapJob &job, jobs) {
+        if (job.ok) {
+            heatmap.merge(job.grid);
+            job.item->setText(4, tr("Exported"));
+            exports++;
+        } else {
+            job.item->setText(4, tr("Read error"));
+            fails++;
+        }
     }
+
+    // the cells are base64 encoded binary, lat, lon and count as int32
     QFile filehtml(dirName->text() + "/HeatMap.htm");
     filehtml.open(QIODevice::WriteOnly | QIODevice::Text);
     QTextStream outhtml(&filehtml);
@@ -267,18 +248,22 @@ GenerateHeatMapDialog::generateNow()
     outhtml << "<script src=\"https://maps.googleapis.com/maps/api/js?v=3.exp&libraries=visualization\"></script>\n";
     outhtml << "<script>\n";
     outhtml << "var map,pointarray,heatmap;\n";
-    outhtml << "var dataarray = [\n";
-    outhtml << datapoints;
-    outhtml << "];\n";
+    outhtml << "var cells = \"";
+    outhtml << heatmap.toBinary().toBase64();
+    outhtml << "\";\n";
     outhtml << "var hmData = [];\n";
     outhtml << "function initialize() {\n";
-    outhtml << "dataarray.forEach(function(entry) {hmData.push({location: new google.maps.LatLng(entry[0], entry[1]), weight: entry[2]});});\n";
-    outhtml << "dataarray = [];\n";
+    outhtml << "var raw = atob(cells); cells = null;\n";
+    outhtml << "var bytes = new Uint8Array(raw.length);\n";
+    outhtml << "for (var i=0; i<raw.length; i++) bytes[i] = raw.charCodeAt(i);\n";
+    outhtml << "var view = new DataView(bytes.buffer);\n";
+    outhtml << "for (var i=0; i+12<=bytes.length; i+=12) hmData.push({location: new google.maps.LatLng(view.getInt32(i,true)/" << RideHeatMap::scale
+            << ", view.getInt32(i+4,true)/" << RideHeatMap::scale << "), weight: view.getInt32(i+8,true)});\n";
     outhtml << "var mapOptions = { mapTypeId: google.maps.MapTypeId.SATELLITE};\n";
     outhtml << "map = new google.maps.Map(document.getElementById('map-canvas'),mapOptions);\n";
     outhtml << "var bounds = new google.maps.LatLngBounds();\n";
-    outhtml << "bounds.extend(new google.maps.LatLng(" << minLat <<"," << minLon << "));\n";
-    outhtml << "bounds.extend(new google.maps.LatLng(" << maxLat <<"," << maxLon << "));\n";
+    outhtml << "bounds.extend(new google.maps.LatLng(" << heatmap.south() <<"," << heatmap.west() << "));\n";
+    outhtml << "bounds.extend(new google.maps.LatLng(" << heatmap.north() <<"," << heatmap.east() << "));\n";
     outhtml << "map.fitBounds(bounds);\n";
     outhtml << "var pointArray = new google.maps.MVCArray(hmData);\n";
     outhtml << "heatmap = new google.maps.visualization.HeatmapLayer({data: pointArray, dissipating:true, maxIntensity:30, opacity:0.8});\n";
@@ -26,6 +26,7 @@
 
 #include "RideItem.h"
 #include "RideFile.h"
+#include "RideHeatMap.h"
 
 #include <QtGui>
 #include <QTreeWidget>
@@ -36,6 +37,18 @@
 #include <QLabel>
 #include <QListIterator>
 #include <QDebug>
+#include <QFuture>
+#include <QFutureWatcher>
+#include <QtConcurrent>
+
+// the grid for one ride, built on a worker thread
+struct HeatMapJob {
+    Context *context;
+    QTreeWidgetItem *item;
+    QString filename;
+    RideHeatMap grid;
+    bool ok;
+};
 
 // Dialog class to show filenames, import progress and to capture user input
 // of ride date and time
@@ -59,6 +72,7 @@ private slots:
     void selectClicked();
     void generateNow();
     void allClicked();
+    void progress(int);
 
 private:
     Context *context;
@@ -78,6 +92,8 @@ private:
     int exports, fails;
     QLabel *status;
 
+    QFuture<void> future;
+
 };
 #endif // _GenerateHeatMapDialog_h
 
@@ -24,6 +24,7 @@
 #include <QDesktopWidget>
 #include <QNetworkProxyQuery>
 #include <QMenuBar>
+#include <QProgressDialog>
 #include <QStyle>
 #include <QTabBar>
 #include <QStyleFactory>
@@ -49,6 +50,7 @@
 #include "GcUpgrade.h"
 #include "HelpWhatsThis.h"
 #include "CsvRideFile.h"
+#include "GcbRideFile.h"
 
 // DIALOGS / DOWNLOADS / UPLOADS
 #include "AboutDialog.h"
@@ -508,6 +510,7 @@ MainWindow::MainWindow(const QDir &home)
 
     optionsMenu->addAction(tr("Create Heat Map..."), this, SLOT(generateHeatMap()), tr(""));
     optionsMenu->addAction(tr("Export Metrics as CSV..."), this, SLOT(exportMetrics()), tr(""));
+    optionsMenu->addAction(tr("Convert Activities to Binary..."), this, SLOT(convertActivities()), tr(""));
 
 #ifdef GC_HAS_CLOUD_DB
     // CloudDB options
@@ -2045,6 +2048,22 @@ MainWindow::exportMetrics()
     currentTab->context->athlete->rideCache->writeAsCSV(fileName);
 }
 
+void
+MainWindow::convertActivities()
+{
+    // binary copies of the json activities are kept in the cache
+    // folder and opened instead of parsing the json, they are made
+    // as rides are opened but this does the whole library up front
+    QProgressDialog progress(tr("Converting activities to binary..."), tr("Abort"), 0, 0, this);
+    progress.setWindowModality(Qt::WindowModal);
+    progress.setMinimumDuration(0);
+
+    int converted = GcbFileReader::convertLibrary(currentTab->context, &progress);
+    if (converted < 0) return;
+
+    QMessageBox::information(this, tr("Convert Activities"), tr("%1 activities converted.").arg(converted));
+}
+
 /*----------------------------------------------------------------------
  * Import Workout from Disk
  *--------------------------------------------------------------------*/
@@ -223,6 +223,7 @@ class MainWindow : public QMainWindow
         void exportBatch();
         void generateHeatMap();
         void exportMetrics();
+        void convertActivities();
         void addAccount();
         void manualProcess(QString);
         void importFile();
@@ -38,6 +38,7 @@
 #include "TcxRideFile.h" // for opening multi-ride file
 #include "DataProcessor.h"
 #include "RideMetadata.h" // for linked defaults processing
+#include "RideImportPipeline.h"
 
 #include <QDebug>
 #include <QWaitCondition>
@@ -53,7 +54,7 @@ enum WizardTable {
 };
 
 // drag and drop passes urls ... convert to a list of files and call main constructor
-RideImportWizard::RideImportWizard(QList<QUrl> *urls, Context *context, QWidget *parent) : QDialog(parent), context(context)
+RideImportWizard::RideImportWizard(QList<QUrl> *urls, Context *context, QWidget *parent) : QDialog(parent), context(context), pipeline(NULL)
 {
     _importInProcess = true;
     setAttribute(Qt::WA_DeleteOnClose);
@@ -69,7 +70,7 @@ RideImportWizard::RideImportWizard(QList<QUrl> *urls, Context *context, QWidget
 
 }
 
-RideImportWizard::RideImportWizard(QList<QString> files, Context *context, QWidget *parent) : QDialog(parent), context(context)
+RideImportWizard::RideImportWizard(QList<QString> files, Context *context, QWidget *parent) : QDialog(parent), context(context), pipeline(NULL)
 {
     _importInProcess = true;
     setAttribute(Qt::WA_DeleteOnClose);
@@ -81,7 +82,7 @@ RideImportWizard::RideImportWizard(QList<QString> files, Context *context, QWidg
 }
 
 
-RideImportWizard::RideImportWizard(RideAutoImportConfig *dirs, Context *context, QWidget *parent) : QDialog(parent), context(context), importConfig(dirs)
+RideImportWizard::RideImportWizard(RideAutoImportConfig *dirs, Context *context, QWidget *parent) : QDialog(parent), context(context), importConfig(dirs), pipeline(NULL)
 {
     _importInProcess = true;
     autoImportMode = true;
@@ -964,6 +965,7 @@ RideImportWizard::abortClicked()
     if (label == tr("Abort")) {
         hide();
         aborted=true; // terminated. I'll be back.
+        if (pipeline && pipeline->isRunning()) pipeline->cancel(); // we close when it stops
         return;
     }
 
@@ -1001,17 +1003,14 @@ RideImportWizard::abortClicked()
     QChar zero = QLatin1Char ( '0' );
 
 
-    // Saving now - process the files one-by-one
+    // Saving now - check the files one-by-one and queue them for the import pipeline
+    QList<RideImportJob> jobs;
+    jobRows.clear();
     for (int i=0; i< filenames.count(); i++) {
 
         if (tableWidget->item(i,STATUS_COLUMN)->text().startsWith(tr("Error"))) continue; // skip errors
 
         tableWidget->item(i,STATUS_COLUMN)->setText(tr("Saving..."));
-        tableWidget->setCurrentCell(i,5);
-        QApplication::processEvents();
-        if (aborted) { done(0); return; }
-        this->repaint();
-
 
         // SAVE STEP 3 - prepare the new file names for the next steps - basic name and .JSON in GC format
 
@@ -1061,77 +1060,56 @@ RideImportWizard::abortClicked()
             importsTarget = sourceFileInfo.fileName();
         }
 
-
         // SAVE STEP 5 - open the file with the respective format reader and export as .JSON
         // to track if addRideCache() has caused an error due to bad data we work with a interim directory for the activities
         // -- first   export to /tmpactivities
         // -- second  create RideCache() entry
         // -- third   move file from /tmpactivities to /activities
+        // the pipeline parses, processes and writes in the background, only adding to the
+        // ride cache is done on the GUI thread, so we just track progress here
+        RideImportJob job;
+        job.source = filenames[i];
+        job.startTime = ridedatetime;
+        job.importsTarget = importsTarget;
+        job.activitiesTarget = activitiesTarget;
+        job.tmpTarget = tmpActivitiesFulltarget;
+        job.finalTarget = finalActivitiesFulltarget;
+        jobs << job;
+        jobRows << i;
+    }
 
-        // serialize the file to .JSON
-        QStringList errors;
-        QFile thisfile(filenames[i]);
-        RideFile *ride(RideFileFactory::instance().openRideFile(context, thisfile, errors));
-
-        // did the input file parse ok ? (should be fine here - since it was alrady checked before - but just in case)
-        if (ride) {
-
-            // update ridedatetime and set the Source File name
-            ride->setStartTime(ridedatetime);
-            ride->setTag("Source Filename", importsTarget);
-            ride->setTag("Filename", activitiesTarget);
-            if (errors.count() > 0)
-                ride->setTag("Import errors", errors.join("\n"));
-
-            // process linked defaults
-            context->athlete->rideMetadata()->setLinkedDefaults(ride);
-
-            // run the processor first... import
-            tableWidget->item(i,STATUS_COLUMN)->setText(tr("Processing..."));
-            DataProcessorFactory::instance().autoProcess(ride, "Auto", "Import");
-            ride->recalculateDerivedSeries();
-
-            tableWidget->item(i,STATUS_COLUMN)->setText(tr("Saving file..."));
-
-            // serialize
-            JsonFileReader reader;
-            QFile target(tmpActivitiesFulltarget);
-            if (reader.writeRideFile(context, ride, target)) {
-
-                // now try adding the Ride to the RideCache - since this may fail due to various reason, the activity file
-                // is stored in tmpActivities during this process to understand which file has create the problem when restarting GC
-                // - only after the step was successful the file is moved
-                // to the "clean" activities folder
-                context->athlete->addRide(QFileInfo(tmpActivitiesFulltarget).fileName(),
-                                          tableWidget->rowCount() < 20 ? true : false, // don't signal if mass importing
-                                          true, true);                                       // file is available only in /tmpActivities, so use this one please
-                // rideCache is successfully updated, let's move the file to the real /activities
-                if (moveFile(tmpActivitiesFulltarget, finalActivitiesFulltarget)) {
-                    tableWidget->item(i,STATUS_COLUMN)->setText(tr("File Saved"));
-                    // and correct the path locally stored in Ride Item
-                    context->ride->setFileName(homeActivities.canonicalPath(), activitiesTarget);
-                }  else {
-                    tableWidget->item(i,STATUS_COLUMN)->setText(tr("Error - Moving %1 to activities folder").arg(activitiesTarget));
-                }
+    // rows that failed the checks above are done already
+    progressBar->setValue(progressBar->value() + filenames.count() - jobs.count());
 
-            }  else {
-                tableWidget->item(i,STATUS_COLUMN)->setText(tr("Error - .JSON creation failed"));
-            }
-        } else {
-            tableWidget->item(i,STATUS_COLUMN)->setText(tr("Error - Import of activitiy file failed"));
-        }
+    pipeline = new RideImportPipeline(context, jobs);
+    connect(pipeline, SIGNAL(status(int,QString)), this, SLOT(importStatus(int,QString)));
+    connect(pipeline, SIGNAL(completed(int)), this, SLOT(importCompleted(int)));
+    connect(pipeline, SIGNAL(finished()), this, SLOT(importFinished()));
+    pipeline->start();
+}
 
-        // now metrics have been calculated
-        DataProcessorFactory::instance().autoProcess(ride, "Save", "ADD");
+void
+RideImportWizard::importStatus(int job, QString text)
+{
+    int row = jobRows.value(job, -1);
+    if (row < 0) return;
 
-        // clear
-        delete ride;
+    tableWidget->item(row,STATUS_COLUMN)->setText(text);
+    tableWidget->setCurrentCell(row,5);
+}
 
-        QApplication::processEvents();
-        if (aborted) { done(0); return; }
-        progressBar->setValue(progressBar->value()+1);
-        this->repaint();
-    }
+void
+RideImportWizard::importCompleted(int)
+{
+    progressBar->setValue(progressBar->value()+1);
+}
+
+void
+RideImportWizard::importFinished()
+{
+    if (aborted) { done(0); return; }
+
+    QChar zero = QLatin1Char ( '0' );
 
     // how did we get on in the end then ...
     int completed = 0;
@@ -1156,30 +1134,6 @@ RideImportWizard::abortClicked()
 }
 
 
-bool
-RideImportWizard::moveFile(const QString &source, const QString &target) {
-
-    QFile r(source);
-
-    // first try it with a rename
-    if (r.rename(target)) return true; // job is done
-
-    // now the harder variant (copy & delete)
-    if (r.copy(target))
-      {
-        // try to remove - but if this fails, no problem, file has been copied at least
-        r.remove();
-        // even if remove failed, the copy was successful - so GC is fine
-        return true;
-      }
-
-    // more required ?
-
-    return false;
-
-}
-
-
 void
 RideImportWizard::closeEvent(QCloseEvent* event)
 {
@@ -1199,6 +1153,7 @@ RideImportWizard::done(int rc)
 // clean up files
 RideImportWizard::~RideImportWizard()
 {
+    delete pipeline; // stops any import still running
     foreach(QString name, deleteMe) QFile(name).remove();
 }
 
@@ -33,6 +33,8 @@
 #include "Context.h"
 #include "RideAutoImportConfig.h"
 
+class RideImportPipeline;
+
 // Dialog class to show filenames, import progress and to capture user input
 // of ride date and time
 
@@ -66,9 +68,13 @@ private slots:
     // void overClicked(); // deprecate for this release... XXX
     void activateSave();
 
+    // progress from the import pipeline
+    void importStatus(int job, QString text);
+    void importCompleted(int job);
+    void importFinished();
+
 private:
     void init(QList<QString> files, Context *context);
-    bool moveFile(const QString &source, const QString &target);
 
     QList <QString> filenames; // list of filenames passed
     int numberOfFiles; // number of files to be processed
@@ -91,6 +97,8 @@ private:
     // bool overwriteFiles; // flag to overwrite files from checkbox               // deprecate for this release... XXX
     Context *context; // caller
     RideAutoImportConfig *importConfig;
+    RideImportPipeline *pipeline; // saves in the background
+    QList<int> jobRows; // table row for each pipeline job
 
     QStringList deleteMe; // list of temp files created during import
 
@@ -1394,6 +1394,15 @@ RideNavigatorSortProxyModel::RideNavigatorSortProxyModel(QObject *parent) : QSor
 bool RideNavigatorSortProxyModel::lessThan(const QModelIndex &left,
                                            const QModelIndex &right) const
 {
+    // activities sort on the position the ride cache model worked
+    // out once for the whole column, no need to look at values
+    QVariant leftRank = sourceModel()->data(left, RideCacheModel::SortRole);
+    QVariant rightRank = sourceModel()->data(right, RideCacheModel::SortRole);
+    if (leftRank.type() == QVariant::Int && rightRank.type() == QVariant::Int) {
+        return leftRank.toInt() < rightRank.toInt();
+    }
+
+    // group headings and the ride time column
     QVariant leftData = sourceModel()->data(left);
     QVariant rightData = sourceModel()->data(right);
 
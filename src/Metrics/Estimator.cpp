@@ -25,6 +25,7 @@
 #include "Specification.h"
 
 #include "Banister.h"
+#include "Trace.h"
 
 #ifndef ESTIMATOR_DEBUG
 #define ESTIMATOR_DEBUG false
@@ -164,12 +165,13 @@ Estimator::calculate()
 void
 Estimator::run()
 {
+  GC_TRACE_THREAD("Estimator");
+  GC_TRACE_SPAN("Estimator::run");
+
   for (int i = 0; i < 2; i++) {
 
     bool isRun = (i > 0); // two times: one for rides and other for runs
 
-    printd("%s Estimates start.\n", isRun ? "Run" : "Bike");
-
     // this needs to be done once all the other metrics
     // Calculate a *monthly* estimate of CP, W' etc using
     // bests data from the previous 6 weeks
@@ -355,7 +357,6 @@ Estimator::run()
     foreach(Performance p, performances) {
         printd("%s %f Peak: %f for %f secs on %s\n", p.run ? "Run" : "Bike", p.powerIndex, p.power, p.duration, p.when.toString().toStdString().c_str());
     }
-    printd("%s Estimates end.\n", isRun ? "Run" : "Bike");
   }
 }
 
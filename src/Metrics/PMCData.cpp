@@ -26,6 +26,7 @@
 #include "Specification.h"
 #include "Season.h"
 #include "Context.h"
+#include "Trace.h"
 
 #include <stdio.h>
 #include <cmath>
@@ -119,8 +120,7 @@ void PMCData::refresh()
         else stsDays_ = sts.toInt();
     }
 
-    QTime timer;
-    timer.start();
+    GC_TRACE_SPAN("PMCData::refresh");
 
     //
     // STEP ONE: What is the date range ?
@@ -432,8 +432,6 @@ void PMCData::refresh()
 
     }
 
-    //qDebug()<<"refresh PMC in="<<timer.elapsed()<<"ms";
-
     isstale=false;
 }
 
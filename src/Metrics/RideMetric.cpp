@@ -24,6 +24,7 @@
 #include "TimeUtils.h"
 #include "Zones.h"
 #include "HrZones.h"
+#include "Trace.h"
 
 // DB Schema Version - YOU MUST UPDATE THIS IF THE SCHEMA VERSION CHANGES!!!
 // Schema version will change if a) the default metadata.xml is updated
@@ -187,6 +188,8 @@ RideMetric::userMetricFingerprint(QList<UserMetricSettings> these)
 QHash<QString,RideMetricPtr>
 RideMetric::computeMetrics(RideItem *item, Specification spec, const QStringList &metrics)
 {
+    GC_TRACE_SPAN("RideMetric::computeMetrics");
+
     const RideMetricFactory &factory = RideMetricFactory::instance();
 
     // generate worklist from metrics we know
@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "VirtualElevation.h"
+#include "RideFile.h"
+#include "Units.h"
+
+#include <QtConcurrent>
+#include <algorithm>
+#include <cmath>
+
+// HARD-CODED DATA: p->kph
+static const double vfactor = 3.600;
+static const double small_number = 0.00001;
+
+void
+VirtualElevationFit::add(const VirtualElevationFit &other)
+{
+    segments += other.segments;
+    a11 += other.a11;
+    a12 += other.a12;
+    a22 += other.a22;
+    b1 += other.b1;
+    b2 += other.b2;
+}
+
+VirtualElevationFit::Status
+VirtualElevationFit::solve(double &cda, double &crr) const
+{
+    // At least two segments needed to approximate:
+    //     X1 * CdA + X2 * Crr = Egain
+    // A11 * CdA + A12 * Crr = B1
+    // A21 * CdA + A22 * Crr = B2
+    if (segments < 2) return TooFewSegments;
+
+    double det = a11 * a22 - a12 * a12;
+    if (fabs(det) > 0.00) {
+        cda = (a22 * b1 - a12 * b2) / det;
+        crr = (a11 * b2 - a12 * b1) / det;
+        return Ok;
+    }
+    return Dependent;
+}
+
+void
+VirtualElevation::setRide(const RideFile *ride)
+{
+    work.clear();
+    distance.clear();
+    wind.clear();
+    accel.clear();
+    energy.clear();
+    speed.clear();
+    altitude.clear();
+    recorded.clear();
+    if (!ride) return;
+
+    const RideFileDataPresent *dataPresent = ride->areDataPresent();
+    double dt = ride->recIntSecs();
+    int n = ride->dataPoints().count();
+
+    work.resize(n);
+    distance.resize(n);
+    wind.resize(n);
+    accel.resize(n);
+    energy.resize(n);
+    speed.resize(n);
+    altitude.resize(n);
+
+    double vlast = 0.0;
+    double sw = 0, sd = 0, sn = 0, sa = 0, se = 0;
+    for (int i=0; i<n; i++) {
+        const RideFilePoint *p = ride->dataPoints().at(i);
+
+        // Unpack:
+        double power = p->watts > 0 ? p->watts : 0;
+        double v     = p->kph/vfactor;
+        double headwind = dataPresent->headwind ? p->headwind/vfactor : v;
+        double a;
+
+        // force is power/v so work is power * dt, but only when moving
+        if (v > small_number) {
+            sw += power * dt;
+            a  = ( v*v - vlast*vlast ) / ( 2.0 * dt * v );
+        } else {
+            a = ( v - vlast ) / dt;
+        }
+
+        sd += v * dt;
+        sn += 0.5 * headwind * headwind * v * dt;
+        sa += a * v * dt;
+        se += power * dt;
+
+        work[i] = sw;
+        distance[i] = sd;
+        wind[i] = sn;
+        accel[i] = sa;
+        energy[i] = se;
+        speed[i] = v;
+        altitude[i] = p->alt;
+        if (p->alt != 0) recorded << i;
+
+        vlast = v;
+    }
+}
+
+void
+VirtualElevation::elevation(double *out, double eoffset, double crr, double cda,
+                            double mass, double rho, double eta, double scale) const
+{
+    const double g = KG_FORCE_PER_METER;
+
+    // Small angle version of slope calculation, summed:
+    // s = f/(m*g) - crr - cda*rho*v*v/(2.0*m*g) - a/g
+    double cw = eta / (mass * g) * scale;
+    double cd = crr * scale;
+    double cn = cda * rho / (mass * g) * scale;
+    double ca = scale / g;
+
+    const double *w = work.constData();
+    const double *d = distance.constData();
+    const double *n = wind.constData();
+    const double *a = accel.constData();
+    int count = work.count();
+    for (int i=0; i<count; i++) out[i] = eoffset + cw * w[i] - cd * d[i] - cn * n[i] - ca * a[i];
+}
+
+VirtualElevationFit
+VirtualElevation::fit(int from, int to, double mass, double rho, double eta) const
+{
+    const double g = KG_FORCE_PER_METER;
+    VirtualElevationFit returning;
+
+    // the samples with a recorded altitude in the range
+    QVector<int>::const_iterator first = std::lower_bound(recorded.begin(), recorded.end(), from);
+    QVector<int>::const_iterator last = std::lower_bound(recorded.begin(), recorded.end(), to);
+    if (last - first < 2) {
+        returning.segments = last - first;
+        return returning;
+    }
+
+    // For each segment, defined between points with alt != 0:
+    //      Aero-Loss + RR-Loss = Egain
+    // where
+    //      Aero-Loss = X1 * CdA
+    //      RR-Loss = X2 * Crr
+    // with
+    //      X1 = sum(0.5 * rho * headwind*headwind * distance)
+    //      X2 = sum(totalMass * g * distance)
+    // and the energy gain sums power in the segment with
+    // potential and kinetic variations:
+    //      Egain = sum(eta * power * dt) +
+    //              totalMass * (g * (altInit - alt) +
+    //              0.5 * (vInit*vInit - v*v))
+    //
+    // The first segment is just the first sample with an altitude
+    // and each after runs from the sample after one to the next.
+    for (QVector<int>::const_iterator it = first; it != last; ++it) {
+        int i = *it;
+        double x1, x2, egain;
+
+        if (it == first) {
+            x1 = wind[i] - (i ? wind[i-1] : 0);
+            x2 = distance[i] - (i ? distance[i-1] : 0);
+            egain = eta * (energy[i] - (i ? energy[i-1] : 0));
+        } else {
+            int j = *(it-1);
+            x1 = wind[i] - wind[j];
+            x2 = distance[i] - distance[j];
+            egain = eta * (energy[i] - energy[j])
+                  + mass * (g * (altitude[j] - altitude[i]) + 0.5 * (speed[j]*speed[j] - speed[i]*speed[i]));
+        }
+        x1 *= rho;
+        x2 *= mass * g;
+
+        // A = X'*X, B = X'*Egain
+        returning.a11 += x1 * x1;
+        returning.a12 += x1 * x2;
+        returning.a22 += x2 * x2;
+        returning.b1 += x1 * egain;
+        returning.b2 += x2 * egain;
+        returning.segments++;
+    }
+    return returning;
+}
+
+static void
+fitJob(VirtualElevation::Job &job)
+{
+    job.fit = job.ve->fit(job.from, job.to, job.mass, job.rho, job.eta);
+}
+
+void
+VirtualElevation::fit(QVector<Job> &jobs)
+{
+    if (jobs.count() == 1) fitJob(jobs[0]);
+    else QtConcurrent::blockingMap(jobs, fitJob);
+}
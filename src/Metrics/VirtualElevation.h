@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _GC_VirtualElevation_h
+#define _GC_VirtualElevation_h 1
+
+#include <QVector>
+
+class RideFile;
+
+//
+// Virtual elevation (Chung's method) as used by Aerolab.
+//
+// The elevation change for each sample is a linear combination of
+// terms that only depend on the ride, weighted by the parameters:
+//
+//    de = eta/m * work/g  -  crr * distance  -  cda*rho/m * wind/g  -  accel/g
+//
+// so the running sums of each term are computed once when the ride is
+// set, and the elevation for any Crr, CdA, mass, rho, eta and offset is
+// then a single pass over them without going back to the ride samples.
+//
+// The same sums give the energy balance between samples with a recorded
+// altitude that the least squares estimate of CdA and Crr is made from,
+// for the whole ride or any part of it.
+//
+class VirtualElevationFit
+{
+    public:
+        enum status { Ok=0, TooFewSegments, Dependent };
+        typedef enum status Status;
+
+        VirtualElevationFit() : segments(0), a11(0), a12(0), a22(0), b1(0), b2(0) {}
+
+        // pool with another range (or ride), since the normal
+        // equations for both are just the sum of the two
+        void add(const VirtualElevationFit &other);
+
+        // solve the normal equations, cda and crr are unchanged unless ok
+        Status solve(double &cda, double &crr) const;
+
+        int segments;
+        double a11, a12, a22, b1, b2; // X'X and X'Egain
+};
+
+class VirtualElevation
+{
+    public:
+        VirtualElevation() {}
+
+        // unpack the ride, metres and m/s whatever the units shown
+        void setRide(const RideFile *ride);
+        int count() const { return distance.count(); }
+
+        // elevation at each sample (count() long), scale converts
+        // from metres for display in imperial units
+        void elevation(double *out, double eoffset, double crr, double cda,
+                       double mass, double rho, double eta, double scale=1.0) const;
+
+        // normal equations for the segments between samples with a recorded
+        // altitude in samples from .. to-1
+        VirtualElevationFit fit(int from, int to, double mass, double rho, double eta) const;
+
+        // a batch of fits, over intervals or rides, computed in parallel
+        struct Job {
+            const VirtualElevation *ve;
+            int from, to;
+            double mass, rho, eta;
+            VirtualElevationFit fit;
+        };
+        static void fit(QVector<Job> &jobs);
+
+    private:
+        // running sums (inclusive) of each term
+        QVector<double> work;       // power * dt where moving
+        QVector<double> distance;   // v * dt
+        QVector<double> wind;       // 0.5 * headwind^2 * v * dt
+        QVector<double> accel;      // a * v * dt
+        QVector<double> energy;     // power * dt, including when stopped
+
+        // and the samples the estimate needs
+        QVector<double> speed;      // m/s
+        QVector<double> altitude;   // m
+        QVector<int> recorded;      // samples with a non zero altitude
+};
+
+#endif
@@ -52,6 +52,7 @@
 #include "RideItem.h"
 #include "Units.h" // for MILES_PER_KM
 #include "Settings.h" // for GC_WBALFORM
+#include "Trace.h"
 
 #if notyet
 const double WprimeMultConst = 1.0;
@@ -103,10 +104,9 @@ WPrime::check()
 void
 WPrime::setRide(RideFile *input)
 {
-    bool integral = (appsettings->value(NULL, GC_WBALFORM, "int").toString() == "int");
+    GC_TRACE_SPAN("WPrime::setRide");
 
-    QTime time; // for profiling performance of the code
-    time.start();
+    bool integral = (appsettings->value(NULL, GC_WBALFORM, "int").toString() == "int");
 
     // remember the ride for next time
     rideFile = input;
@@ -286,8 +286,6 @@ WPrime::setRide(RideFile *input)
     if (minY < -30000) minY = 0; // the data is definitely out of bounds!
                                  // so lets not exacerbate the problem - truncate
 
-    //qDebug()<<"compute W'bal curve took"<<time.elapsed();
-
     // STEP 3: FIND MATCHES
 
     // SMOOTH DATA SERIES 
@@ -372,10 +370,9 @@ WPrime::setRide(RideFile *input)
 void
 WPrime::setWatts(Context *context, QVector<int>&wattsArray, int CP, int WPRIME)
 {
-    bool integral = (appsettings->value(NULL, GC_WBALFORM, "int").toString() == "int");
+    GC_TRACE_SPAN("WPrime::setWatts");
 
-    QTime time; // for profiling performance of the code
-    time.start();
+    bool integral = (appsettings->value(NULL, GC_WBALFORM, "int").toString() == "int");
 
     // reset from previous
     values.resize(0); // the memory is kept for next time so this is efficient
@@ -471,10 +468,9 @@ WPrime::setWatts(Context *context, QVector<int>&wattsArray, int CP, int WPRIME)
 void
 WPrime::setErg(ErgFile *input)
 {
-    bool integral = (appsettings->value(NULL, GC_WBALFORM, "int").toString() == "int");
+    GC_TRACE_SPAN("WPrime::setErg");
 
-    QTime time; // for profiling performance of the code
-    time.start();
+    bool integral = (appsettings->value(NULL, GC_WBALFORM, "int").toString() == "int");
 
     // reset from previous
     values.resize(0); // the memory is kept for next time so this is efficient
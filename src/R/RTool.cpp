@@ -1165,11 +1165,88 @@ RTool::dfForRideItem(const RideItem *ri)
     return ans;
 }
 
+//
+// Season data frames
+//
+void
+RToolColumns::refresh(Context *context)
+{
+    const RideMetricFactory &factory = RideMetricFactory::instance();
+    RideCache *rideCache = context->athlete->rideCache;
+    bool useMetricUnits = context->athlete->useMetricUnits;
+    int metrics = factory.metricCount();
+
+    // start again for another athlete, units or set of metrics
+    if (rideCache != cache || useMetricUnits != metricUnits || columns.count() != metrics) {
+        cache = rideCache;
+        metricUnits = useMetricUnits;
+        rides_.clear();
+        revisions.clear();
+        columns.clear();
+        columns.resize(metrics);
+    }
+
+    // conversions for each metric
+    QVector<double> scale(metrics), offset(metrics);
+    for(int i=0; i<metrics; i++) {
+        const RideMetric *metric = factory.rideMetric(factory.metricName(i));
+        scale[i] = useMetricUnits ? 1.0f : metric->conversion();
+        offset[i] = useMetricUnits ? 0.0f : metric->conversionSum();
+    }
+
+    // rides inserted or deleted move those after them, they
+    // won't match what we have so will get read again
+    const QVector<RideItem*> &rides = rideCache->rides();
+    int count = rides.count();
+    rides_.resize(count);
+    revisions.resize(count);
+    QVector<double*> out(metrics);
+    for(int i=0; i<metrics; i++) {
+        columns[i].resize(count);
+        out[i] = columns[i].data();
+    }
+
+    for(int r=0; r<count; r++) {
+        RideItem *item = rides[r];
+        if (rides_[r] == item && revisions[r] == item->revision) continue;
+
+        rides_[r] = item;
+        revisions[r] = item->revision;
+
+        const QVector<double> &values = item->metrics();
+        int n = qMin(values.count(), metrics);
+        for(int i=0; i<n; i++) out[i][r] = values[i] * scale[i] + offset[i];
+        for(int i=n; i<metrics; i++) out[i][r] = offset[i];
+    }
+}
+
+QVector<int>
+RTool::ridesFor(bool all, DateRange range, Specification &specification)
+{
+    QVector<int> returning;
+    const QVector<RideItem*> &rides = columns.rides();
+    for(int r=0; r<rides.count(); r++) {
+        if (!specification.pass(rides[r])) continue;
+        if (all || range.pass(rides[r]->dateTime.date())) returning << r;
+    }
+    return returning;
+}
+
+// row names 1..n, in the compact form R uses itself
+// for data frames, rather than a string for each row
+static SEXP
+rowNames(int n)
+{
+    SEXP rownames = Rf_allocVector(INTSXP, 2);
+    INTEGER(rownames)[0] = NA_INTEGER;
+    INTEGER(rownames)[1] = -n;
+    return rownames;
+}
+
 SEXP
 RTool::dfForDateRange(bool all, DateRange range, SEXP filter)
 {
     const RideMetricFactory &factory = RideMetricFactory::instance();
-    int rides = rtool->context->athlete->rideCache->count();
     int metrics = factory.metricCount();
 
     // count the number of meta fields to add
@@ -1211,12 +1288,11 @@ RTool::dfForDateRange(bool all, DateRange range, SEXP filter)
     specification.setFilterSet(fs);
     UNPROTECT(1);
 
-    // we need to count rides that are in range...
-    rides = 0;
-    foreach(RideItem *ride, rtool->context->athlete->rideCache->rides()) {
-        if (!specification.pass(ride)) continue;
-        if (all || range.pass(ride->dateTime.date())) rides++;
-    }
+    // the rides that are in range, once for all the columns
+    rtool->columns.refresh(rtool->context);
+    const QVector<RideItem*> &items = rtool->columns.rides();
+    QVector<int> selected = rtool->ridesFor(all, range, specification);
+    int rides = selected.count();
 
     // get a listAllocated
     SEXP ans;
@@ -1228,11 +1304,7 @@ RTool::dfForDateRange(bool all, DateRange range, SEXP filter)
     PROTECT(names = Rf_allocVector(STRSXP, metrics+meta+3));
 
     // we have to give a name to each row
-    PROTECT(rownames = Rf_allocVector(STRSXP, rides));
-    for(int i=0; i<rides; i++) {
-        QString rownumber=QString("%1").arg(i+1);
-        SET_STRING_ELT(rownames, i, Rf_mkChar(rownumber.toLatin1().constData()));
-    }
+    PROTECT(rownames = rowNames(rides));
 
     // next name
     int next=0;
@@ -1241,13 +1313,9 @@ RTool::dfForDateRange(bool all, DateRange range, SEXP filter)
     SEXP date;
     PROTECT(date=Rf_allocVector(INTSXP, rides));
 
-    int k=0;
     QDate d1970(1970,01,01);
-    foreach(RideItem *ride, rtool->context->athlete->rideCache->rides()) {
-        if (!specification.pass(ride)) continue;
-        if (all || range.pass(ride->dateTime.date()))
-            INTEGER(date)[k++] = d1970.daysTo(ride->dateTime.date());
-    }
+    for(int k=0; k<rides; k++)
+        INTEGER(date)[k] = d1970.daysTo(items[selected[k]]->dateTime.date());
 
     SEXP dclas;
     PROTECT(dclas=Rf_allocVector(STRSXP, 1));
@@ -1263,12 +1331,8 @@ RTool::dfForDateRange(bool all, DateRange range, SEXP filter)
     PROTECT(time=Rf_allocVector(REALSXP, rides));
 
     // fill with values for date and class if its one we need to return
-    k=0;
-    foreach(RideItem *ride, rtool->context->athlete->rideCache->rides()) {
-        if (!specification.pass(ride)) continue;
-        if (all || range.pass(ride->dateTime.date()))
-            REAL(time)[k++] = ride->dateTime.toUTC().toTime_t();
-    }
+    for(int k=0; k<rides; k++)
+        REAL(time)[k] = items[selected[k]]->dateTime.toUTC().toTime_t();
 
     // POSIXct class
     SEXP clas;
@@ -1297,21 +1361,14 @@ RTool::dfForDateRange(bool all, DateRange range, SEXP filter)
         PROTECT(m=Rf_allocVector(REALSXP, rides));
 
         QString symbol = factory.metricName(i);
-        const RideMetric *metric = factory.rideMetric(symbol);
         QString name = rtool->context->specialFields.internalName(factory.rideMetric(symbol)->name());
         name = name.replace(" ","_");
         name = name.replace("'","_");
 
-        bool useMetricUnits = rtool->context->athlete->useMetricUnits;
-
-        int index=0;
-        foreach(RideItem *item, rtool->context->athlete->rideCache->rides()) {
-            if (!specification.pass(item)) continue;
-            if (all || range.pass(item->dateTime.date())) {
-                REAL(m)[index++] = item->metrics()[i] * (useMetricUnits ? 1.0f : metric->conversion())
-                                                      + (useMetricUnits ? 0.0f : metric->conversionSum());
-            }
-        }
+        // already converted to the user's units
+        const double *values = rtool->columns.column(i);
+        double *out = REAL(m);
+        for(int k=0; k<rides; k++) out[k] = values[selected[k]];
 
         // add to the list
         SET_VECTOR_ELT(ans, next, m);
@@ -1338,13 +1395,8 @@ RTool::dfForDateRange(bool all, DateRange range, SEXP filter)
         SEXP m;
         PROTECT(m=Rf_allocVector(STRSXP, rides));
 
-        int index=0;
-        foreach(RideItem *item, rtool->context->athlete->rideCache->rides()) {
-            if (!specification.pass(item)) continue;
-            if (all || range.pass(item->dateTime.date())) {
-                SET_STRING_ELT(m, index++, Rf_mkChar(item->getText(field.name, "").toLatin1().constData()));
-            }
-        }
+        for(int k=0; k<rides; k++)
+            SET_STRING_ELT(m, k, Rf_mkChar(items[selected[k]]->getText(field.name, "").toLatin1().constData()));
 
         // add to the list
         SET_VECTOR_ELT(ans, next, m);
@@ -1362,24 +1414,21 @@ RTool::dfForDateRange(bool all, DateRange range, SEXP filter)
     SEXP color;
     PROTECT(color=Rf_allocVector(STRSXP, rides));
 
-    int index=0;
-    foreach(RideItem *item, rtool->context->athlete->rideCache->rides()) {
-        if (!specification.pass(item)) continue;
-        if (all || range.pass(item->dateTime.date())) {
+    for(int k=0; k<rides; k++) {
+        RideItem *item = items[selected[k]];
 
-            // apply item color, remembering that 1,1,1 means use default (reverse in this case)
-            if (item->color == QColor(1,1,1,1)) {
+        // apply item color, remembering that 1,1,1 means use default (reverse in this case)
+        if (item->color == QColor(1,1,1,1)) {
 
-                // use the inverted color, not plot marker as that hideous
-                QColor col =GCColor::invertColor(GColor(CPLOTBACKGROUND));
+            // use the inverted color, not plot marker as that hideous
+            QColor col =GCColor::invertColor(GColor(CPLOTBACKGROUND));
 
-                // white is jarring on a dark background!
-                if (col==QColor(Qt::white)) col=QColor(127,127,127);
+            // white is jarring on a dark background!
+            if (col==QColor(Qt::white)) col=QColor(127,127,127);
 
-                SET_STRING_ELT(color, index++, Rf_mkChar(col.name().toLatin1().constData()));
-            } else
-                SET_STRING_ELT(color, index++, Rf_mkChar(item->color.name().toLatin1().constData()));
-        }
+            SET_STRING_ELT(color, k, Rf_mkChar(col.name().toLatin1().constData()));
+        } else
+            SET_STRING_ELT(color, k, Rf_mkChar(item->color.name().toLatin1().constData()));
     }
 
     // add to the list and name it
@@ -1405,7 +1454,6 @@ SEXP
 RTool::dfForDateRangeIntervals(DateRange range, QStringList types)
 {
     const RideMetricFactory &factory = RideMetricFactory::instance();
-    int intervals = 0;
     int metrics = factory.metricCount();
 
     // how many rides to return if we're limiting to the
@@ -1418,19 +1466,21 @@ RTool::dfForDateRangeIntervals(DateRange range, QStringList types)
     fs.addFilter(rtool->context->ishomefiltered, rtool->context->homeFilters);
     specification.setFilterSet(fs);
 
-    // we need to count intervals that are in range...
-    intervals = 0;
+    // the intervals that are in range, and their rides, once for all the columns
+    QVector<RideItem*> rides;
+    QVector<IntervalItem*> selected;
     foreach(RideItem *ride, rtool->context->athlete->rideCache->rides()) {
         if (!specification.pass(ride)) continue;
         if (!range.pass(ride->dateTime.date())) continue;
 
-        if (types.isEmpty()) intervals += ride->intervals().count();
-        else {
-            foreach(IntervalItem *item, ride->intervals())
-                if (types.contains(RideFileInterval::typeDescription(item->type)))
-                    intervals++;
+        foreach(IntervalItem *item, ride->intervals()) {
+            if (types.isEmpty() || types.contains(RideFileInterval::typeDescription(item->type))) {
+                rides << ride;
+                selected << item;
+            }
         }
     }
+    int intervals = selected.count();
 
     // get a listAllocated
     SEXP ans;
@@ -1442,11 +1492,7 @@ RTool::dfForDateRangeIntervals(DateRange range, QStringList types)
     PROTECT(names = Rf_allocVector(STRSXP, metrics+5));
 
     // we have to give a name to each row
-    PROTECT(rownames = Rf_allocVector(STRSXP, intervals));
-    for(int i=0; i<intervals; i++) {
-        QString rownumber=QString("%1").arg(i+1);
-        SET_STRING_ELT(rownames, i, Rf_mkChar(rownumber.toLatin1().constData()));
-    }
+    PROTECT(rownames = rowNames(intervals));
 
     // next name
     int next=0;
@@ -1455,16 +1501,9 @@ RTool::dfForDateRangeIntervals(DateRange range, QStringList types)
     SEXP date;
     PROTECT(date=Rf_allocVector(INTSXP, intervals));
 
-    int k=0;
     QDate d1970(1970,01,01);
-    foreach(RideItem *ride, rtool->context->athlete->rideCache->rides()) {
-        if (!specification.pass(ride)) continue;
-        if (range.pass(ride->dateTime.date())) {
-            foreach(IntervalItem *item, ride->intervals())
-                if (types.isEmpty() || types.contains(RideFileInterval::typeDescription(item->type)))
-                    INTEGER(date)[k++] = d1970.daysTo(ride->dateTime.date());
-        }
-    }
+    for(int k=0; k<intervals; k++)
+        INTEGER(date)[k] = d1970.daysTo(rides[k]->dateTime.date());
 
     SEXP dclas;
     PROTECT(dclas=Rf_allocVector(STRSXP, 1));
@@ -1480,15 +1519,8 @@ RTool::dfForDateRangeIntervals(DateRange range, QStringList types)
     PROTECT(time=Rf_allocVector(REALSXP, intervals));
 
     // fill with values for date and class if its one we need to return
-    k=0;
-    foreach(RideItem *ride, rtool->context->athlete->rideCache->rides()) {
-        if (!specification.pass(ride)) continue;
-        if (range.pass(ride->dateTime.date())) {
-            foreach(IntervalItem *item, ride->intervals())
-                if (types.isEmpty() || types.contains(RideFileInterval::typeDescription(item->type)))
-                    REAL(time)[k++] = ride->dateTime.toUTC().toTime_t() + item->start;  // time offsets by time of interval
-        }
-    }
+    for(int k=0; k<intervals; k++)
+        REAL(time)[k] = rides[k]->dateTime.toUTC().toTime_t() + selected[k]->start;  // time offsets by time of interval
 
     // POSIXct class
     SEXP clas;
@@ -1508,15 +1540,8 @@ RTool::dfForDateRangeIntervals(DateRange range, QStringList types)
     // NAME
     SEXP intervalnames;
     PROTECT(intervalnames = Rf_allocVector(STRSXP, intervals));
-    k=0;
-    foreach(RideItem *ride, rtool->context->athlete->rideCache->rides()) {
-        if (!specification.pass(ride)) continue;
-        if (range.pass(ride->dateTime.date())) {
-            foreach(IntervalItem *item, ride->intervals())
-                if (types.isEmpty() || types.contains(RideFileInterval::typeDescription(item->type)))
-                    SET_STRING_ELT(intervalnames, k++, Rf_mkChar(item->name.toLatin1().constData()));
-        }
-    }
+    for(int k=0; k<intervals; k++)
+        SET_STRING_ELT(intervalnames, k, Rf_mkChar(selected[k]->name.toLatin1().constData()));
 
     // add to the list and give a columnname
     SET_VECTOR_ELT(ans, next, intervalnames);
@@ -1526,15 +1551,8 @@ RTool::dfForDateRangeIntervals(DateRange range, QStringList types)
     // TYPE
     SEXP intervaltypes;
     PROTECT(intervaltypes = Rf_allocVector(STRSXP, intervals));
-    k=0;
-    foreach(RideItem *ride, rtool->context->athlete->rideCache->rides()) {
-        if (!specification.pass(ride)) continue;
-        if (range.pass(ride->dateTime.date())) {
-            foreach(IntervalItem *item, ride->intervals())
-                if (types.isEmpty() || types.contains(RideFileInterval::typeDescription(item->type)))
-                    SET_STRING_ELT(intervaltypes, k++, Rf_mkChar(RideFileInterval::typeDescription(item->type).toLatin1().constData()));
-        }
-    }
+    for(int k=0; k<intervals; k++)
+        SET_STRING_ELT(intervaltypes, k, Rf_mkChar(RideFileInterval::typeDescription(selected[k]->type).toLatin1().constData()));
     SET_VECTOR_ELT(ans, next, intervaltypes);
     SET_STRING_ELT(names, next, Rf_mkChar("type"));
     next++;
@@ -1558,19 +1576,11 @@ RTool::dfForDateRangeIntervals(DateRange range, QStringList types)
         name = name.replace("'","_");
 
         bool useMetricUnits = rtool->context->athlete->useMetricUnits;
+        double scale = useMetricUnits ? 1.0f : metric->conversion();
+        double offset = useMetricUnits ? 0.0f : metric->conversionSum();
 
-        int index=0;
-        foreach(RideItem *item, rtool->context->athlete->rideCache->rides()) {
-            if (!specification.pass(item)) continue;
-            if (range.pass(item->dateTime.date())) {
-
-                foreach(IntervalItem *interval, item->intervals()) {
-                    if (types.isEmpty() || types.contains(RideFileInterval::typeDescription(interval->type)))
-                        REAL(m)[index++] = interval->metrics()[i] * (useMetricUnits ? 1.0f : metric->conversion())
-                                                          + (useMetricUnits ? 0.0f : metric->conversionSum());
-                }
-            }
-        }
+        double *out = REAL(m);
+        for(int k=0; k<intervals; k++) out[k] = selected[k]->metrics()[i] * scale + offset;
 
         // add to the list
         SET_VECTOR_ELT(ans, next, m);
@@ -1588,28 +1598,21 @@ RTool::dfForDateRangeIntervals(DateRange range, QStringList types)
     SEXP color;
     PROTECT(color=Rf_allocVector(STRSXP, intervals));
 
-    int index=0;
-    foreach(RideItem *item, rtool->context->athlete->rideCache->rides()) {
-        if (!specification.pass(item)) continue;
-        if (!range.pass(item->dateTime.date())) continue;
-
-        foreach(IntervalItem *interval, item->intervals()) {
-
-            if (!types.isEmpty() && !types.contains(RideFileInterval::typeDescription(interval->type))) continue;
+    for(int k=0; k<intervals; k++) {
+        IntervalItem *interval = selected[k];
 
-            // apply item color, remembering that 1,1,1 means use default (reverse in this case)
-            if (interval->color == QColor(1,1,1,1)) {
+        // apply item color, remembering that 1,1,1 means use default (reverse in this case)
+        if (interval->color == QColor(1,1,1,1)) {
 
-                // use the inverted color, not plot marker as that hideous
-                QColor col =GCColor::invertColor(GColor(CPLOTBACKGROUND));
+            // use the inverted color, not plot marker as that hideous
+            QColor col =GCColor::invertColor(GColor(CPLOTBACKGROUND));
 
-                // white is jarring on a dark background!
-                if (col==QColor(Qt::white)) col=QColor(127,127,127);
+            // white is jarring on a dark background!
+            if (col==QColor(Qt::white)) col=QColor(127,127,127);
 
-                SET_STRING_ELT(color, index++, Rf_mkChar(col.name().toLatin1().constData()));
-            } else
-                SET_STRING_ELT(color, index++, Rf_mkChar(interval->color.name().toLatin1().constData()));
-        }
+            SET_STRING_ELT(color, k, Rf_mkChar(col.name().toLatin1().constData()));
+        } else
+            SET_STRING_ELT(color, k, Rf_mkChar(interval->color.name().toLatin1().constData()));
     }
 
     // add to the list and name it
@@ -2222,8 +2225,10 @@ RTool::dfForActivity(RideFile *f, int split, QString join)
         SEXP time = PROTECT(Rf_allocVector(REALSXP, points));
         pcount++;
 
-        // fill with values for date and class
-        for(int k=0; k<points; k++) REAL(time)[k] = f->startTime().addSecs(f->dataPoints()[index+k]->secs).toUTC().toTime_t();
+        // fill with values for date and class, offsets from the start
+        // are the same in UTC, so only convert the start time once
+        double start = f->startTime().toUTC().toTime_t();
+        for(int k=0; k<points; k++) REAL(time)[k] = start + qint64(f->dataPoints()[index+k]->secs);
 
         // POSIXct class
         SEXP clas = PROTECT(Rf_allocVector(STRSXP, 2));
@@ -2252,15 +2257,15 @@ RTool::dfForActivity(RideFile *f, int split, QString join)
             SEXP vector = PROTECT(Rf_allocVector(REALSXP, points));
             pcount++;
 
-            for(int j=index; j<stop; j++) {
-                if (f->isDataPresent(series)) {
-                    if (f->dataPoints()[j]->value(series) == 0 && (series == RideFile::lat || series == RideFile::lon))
-                        REAL(vector)[j-index] = NA_REAL;
-                    else
-                        REAL(vector)[j-index] = f->dataPoints()[j]->value(series);
-                } else {
-                    REAL(vector)[j-index] = NA_REAL;
+            double *out = REAL(vector);
+            if (f->isDataPresent(series)) {
+                bool location = (series == RideFile::lat || series == RideFile::lon);
+                for(int j=index; j<stop; j++) {
+                    double value = f->dataPoints()[j]->value(series);
+                    out[j-index] = (location && value == 0) ? NA_REAL : value;
                 }
+            } else {
+                for(int j=0; j<points; j++) out[j] = NA_REAL;
             }
 
             // add to the list
@@ -2319,12 +2324,8 @@ RTool::dfForActivity(RideFile *f, int split, QString join)
         }
 
         // add rownames
-        SEXP rownames = PROTECT(Rf_allocVector(STRSXP, points));
+        SEXP rownames = PROTECT(rowNames(points));
         pcount++;
-        for(int i=0; i<points; i++) {
-            QString rownumber=QString("%1").arg(i+1);
-            SET_STRING_ELT(rownames, i, Rf_mkChar(rownumber.toLatin1().constData()));
-        }
 
         // turn the list into a data frame + set column names
         Rf_setAttrib(ans, R_RowNamesSymbol, rownames);
@@ -2658,7 +2659,7 @@ RTool::dfForRideFileCache(RideFileCache *cache)
         // will have different sizes e.g. when a daterange
         // since longest ride with e.g. power may be different
         // to longest ride with heartrate
-        for(int j=0; j<values.count(); j++) REAL(vector)[j] = values[j];
+        memcpy(REAL(vector), values.constData(), values.count() * sizeof(double));
 
         // add to the list
         SET_VECTOR_ELT(ans, next, vector);
@@ -2706,11 +2707,7 @@ RTool::dfForRideFileCache(RideFileCache *cache)
 
     // add rownames
     SEXP rownames;
-    PROTECT(rownames = Rf_allocVector(STRSXP, size));
-    for(unsigned int i=0; i<size; i++) {
-        QString rownumber=QString("%1").arg(i+1);
-        SET_STRING_ELT(rownames, i, Rf_mkChar(rownumber.toLatin1().constData()));
-    }
+    PROTECT(rownames = rowNames(size));
 
     // turn the list into a data frame + set column names
     Rf_setAttrib(ans, R_RowNamesSymbol, rownames);
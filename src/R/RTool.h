@@ -23,8 +23,35 @@
 
 class RGraphicsDevice;
 class RTool;
+class RideCache;
+class Specification;
 extern RTool *rtool;
 
+// metric values for every ride in an athlete's ride cache, a column per
+// metric converted to the units the user has chosen. Data frames copy
+// from these a column at a time, and between calls only the rows for
+// rides that have been added or refreshed are read again.
+class RToolColumns
+{
+    public:
+        RToolColumns() : cache(NULL), metricUnits(true) {}
+
+        // bring up to date with the athlete's rides
+        void refresh(Context *context);
+
+        // the rides, in ride cache order, and their values
+        const QVector<RideItem*> &rides() const { return rides_; }
+        const double *column(int metric) const { return columns[metric].constData(); }
+
+    private:
+        RideCache *cache;
+        bool metricUnits;
+
+        QVector<RideItem*> rides_;
+        QVector<int> revisions;             // RideItem::revision when read
+        QVector<QVector<double> > columns;  // [metric][ride]
+};
+
 class RTool {
 
 
@@ -103,6 +130,8 @@ class RTool {
 
         QStringList messages;
 
+        // metric columns for season data frames
+        RToolColumns columns;
 
     protected:
 
@@ -119,6 +148,9 @@ class RTool {
         SEXP dfForDateRangePeaks(bool all, DateRange range, SEXP filter, QList<RideFile::SeriesType> series, QList<int> durations);
         SEXP dfForRideFileCache(RideFileCache *p);      // returns meanmax for a cache
 
+        // rides selected for a season data frame, as indexes into columns
+        QVector<int> ridesFor(bool all, DateRange range, Specification &specification);
+
 };
 
 // there is a global instance created in main
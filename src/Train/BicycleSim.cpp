@@ -607,13 +607,19 @@ double Bicycle::FilterWattIncrease(double watts)
 // Compute new speed from state and time duration since last sample.
 SpeedDistance
 Bicycle::SampleSpeed(BicycleSimState &nowState)
+{
+    // Record current time and return dt since last sample.
+    return SampleSpeed(nowState, SampleDT());
+}
+
+// As above, but with the time since the last sample supplied by the
+// caller, so simulations can run faster than real time and repeat exactly.
+SpeedDistance
+Bicycle::SampleSpeed(BicycleSimState &nowState, double dt)
 {
     // Detect and filter obvious power spikes.
     nowState.Watts() = FilterWattIncrease(nowState.Watts());
 
-    // Record current time and return dt since last sample.
-    double dt = SampleDT();
-
     // Compute new speed.
     MotionStatePair state(this,          // BicycleSim object (for accessing methods and constants)
                           this->m_state, // previous tick state
@@ -146,6 +146,7 @@ public:
     Bicycle(Context* context, BicycleConstants constants, double riderWeightKG, double bicycleMassWithoutWheelsKG, BicycleWheel frontWheel, BicycleWheel rearWheel);
     Bicycle(Context* context);
     SpeedDistance SampleSpeed(BicycleSimState &newState);
+    SpeedDistance SampleSpeed(BicycleSimState &newState, double dt); // dt in seconds
 
     double MassKG() const;                   // Actual mass of bike and rider.
     double EquivalentMassKG() const;         // Additional mass due to rotational inertia
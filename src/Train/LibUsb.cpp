@@ -220,7 +220,9 @@ int LibUsb::read(char *buf, int bytes, int timeout)
     {
         // don't report timeouts - lots of noise so commented out
         //qDebug()<<"usb_bulk_read Error reading: "<<rc<< usb_strerror();
-        return rc;
+
+        // but don't lose what we already copied from the buffer
+        return bufRemain > 0 ? bufRemain : rc;
     }
     readBufSize = rc;
 
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "SimController.h"
+#include "RideFile.h"
+
+#include <cmath>
+
+SimController::SimController(TrainSidebar *parent, DeviceConfiguration *dc)
+  : RealtimeController(parent, dc), replay(NULL), mode(RT_MODE_ERGO), response(0),
+    now(0), last(0), requestedAt(-1), requested(100), load(100), gradient(0), seed(1),
+    bicycle(NULL) // default bike and rider, not the athlete's, so runs always repeat
+{
+}
+
+int
+SimController::start()
+{
+    now = last = 0;
+    requestedAt = -1;
+    seed = 1;
+    bicycle.clear();
+    return 0;
+}
+
+int
+SimController::restart()
+{
+    // carry on from where we paused
+    last = now;
+    bicycle.reset();
+    return 0;
+}
+
+void
+SimController::setMode(int mode)
+{
+    this->mode = mode;
+}
+
+void
+SimController::setLoad(double watts)
+{
+    if (watts == requested) return;
+
+    requested = watts;
+    requestedAt = now;
+}
+
+double
+SimController::noise(double range)
+{
+    // same generator as the C library example, but ours, so nothing
+    // else calling rand() can upset the sequence
+    seed = seed * 1103515245 + 12345;
+    return (double((seed >> 16) & 0x7fff) / 32767.0 - 0.5) * range;
+}
+
+void
+SimController::getRealtimeData(RealtimeData &rtData)
+{
+    double dt = (now - last) / 1000.0;
+    last = now;
+
+    // trainer catches up with the load it was asked for
+    if (requestedAt >= 0 && now - requestedAt >= response) {
+        load = requested;
+        requestedAt = -1;
+    }
+
+    // what is the rider doing ?
+    double watts = 200, cadence = 85, hr = 145;
+    if (replay && !replay->dataPoints().isEmpty()) {
+
+        // loop if the workout is longer than the recording
+        double duration = replay->dataPoints().last()->secs + replay->recIntSecs();
+        double secs = duration > 0 ? fmod(now / 1000.0, duration) : 0;
+        int index = replay->timeIndex(secs);
+        if (index < 0) index = 0;
+
+        const RideFilePoint *p = replay->dataPoints().at(index);
+        watts = p->watts;
+        cadence = p->cad;
+        hr = p->hr;
+
+    } else {
+        watts += noise(30);
+        cadence += noise(10);
+        hr += noise(4);
+    }
+
+    // ergo mode holds the rider at the load
+    if (mode == RT_MODE_ERGO) watts = load + noise(20);
+
+    rtData.setName((char *)"Simulator");
+    rtData.setLoad(load);
+    rtData.setWatts(watts);
+    rtData.setCadence(cadence);
+    rtData.setHr(hr);
+
+    // speed from first principles using the virtual time, the very
+    // first sample uses the same small step as the simulator does
+    BicycleSimState state(rtData);
+    if (mode != RT_MODE_ERGO) state.Slope() = gradient; // what we were told
+    SpeedDistance ret = bicycle.SampleSpeed(state, dt > 0 ? dt : 0.01);
+    rtData.setSpeed(ret.v);
+
+    processRealtimeData(rtData);
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _GC_SimController_h
+#define _GC_SimController_h 1
+#include "GoldenCheetah.h"
+
+#include "RealtimeController.h"
+#include "RealtimeData.h"
+#include "BicycleSim.h"
+
+class RideFile;
+
+//
+// A simulated smart trainer for testing the train view without hardware.
+//
+// Unlike the NullController (robot) it runs on a virtual clock that is
+// advanced by whoever drives it, and its "noise" is from a fixed seed, so
+// the same session always produces the same telemetry, at real time or
+// as fast as the machine can go.
+//
+// The rider is a recorded session being replayed (power, cadence and
+// heartrate at each second) or a steady 200w rider if there isn't one.
+// In ERG mode the trainer holds the rider at the load, which it applies
+// a configurable response time after it was asked.
+//
+class SimController : public RealtimeController
+{
+    Q_OBJECT
+
+    public:
+        SimController(TrainSidebar *parent, DeviceConfiguration *dc);
+        ~SimController() {}
+
+        // the session to replay as the rider, not owned, NULL for steady rider
+        void setReplay(const RideFile *ride) { replay = ride; }
+
+        // msecs the trainer takes to apply a new load
+        void setResponse(int msecs) { response = msecs; }
+
+        // virtual msecs since start, telemetry is for this time
+        void setTime(qint64 msecs) { now = msecs; }
+
+        int start();
+        int stop() { return 0; }
+        int pause() { return 0; }
+        int restart();
+        bool find() { return true; }
+        bool discover(QString) { return true; }
+        bool doesPush() { return false; }
+        bool doesPull() { return true; }
+        bool doesLoad() { return true; }
+
+        void setMode(int mode);
+        void setLoad(double watts);
+        void setGradient(double gradient) { this->gradient = gradient; }
+        void getRealtimeData(RealtimeData &rtData);
+        void pushRealtimeData(RealtimeData &) {}
+
+    private:
+        double noise(double range); // +/- range/2
+
+        const RideFile *replay;
+        int mode, response;
+        qint64 now, last;       // virtual msecs
+        qint64 requestedAt;     // when the pending load was asked for, -1 if none
+        double requested, load, gradient;
+        quint32 seed;
+
+        Bicycle bicycle;
+};
+
+#endif // _GC_SimController_h
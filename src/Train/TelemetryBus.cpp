@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "TelemetryBus.h"
+#include <atomic>
+
+TelemetryBus::TelemetryBus() : head(0)
+{
+    clock.start();
+}
+
+void
+TelemetryBus::publish(const RealtimeData &data)
+{
+    quint32 next = head.load() + 1;
+    Slot &slot = ring[next % ringSize];
+
+    // odd whilst we write
+    quint32 seq = slot.seq.load();
+    slot.seq.store(seq + 1);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.stamp = clock.elapsed();
+    slot.data = data;
+
+    // even again, and now it's the latest
+    slot.seq.storeRelease(seq + 2);
+    head.storeRelease(next);
+}
+
+bool
+TelemetryBus::latest(RealtimeData &data, qint64 *stamp) const
+{
+    for (;;) {
+        quint32 current = head.loadAcquire();
+        if (current == 0) return false;
+
+        const Slot &slot = ring[current % ringSize];
+        quint32 before = slot.seq.loadAcquire();
+        if (before & 1) continue; // being written, the head will move on
+
+        data = slot.data;
+        qint64 when = slot.stamp;
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        // not overwritten whilst we copied it
+        if (slot.seq.load() == before) {
+            if (stamp) *stamp = when;
+            return true;
+        }
+    }
+}
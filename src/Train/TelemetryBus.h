@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _GC_TelemetryBus_h
+#define _GC_TelemetryBus_h 1
+#include "GoldenCheetah.h"
+
+#include "RealtimeData.h"
+#include <QAtomicInteger>
+#include <QElapsedTimer>
+
+//
+// Holds the latest telemetry for any number of readers without locking.
+//
+// There is only ever one producer, it writes the next slot in a small ring
+// and then publishes it. Each slot has a sequence number that is odd whilst
+// it is being written, a reader copies the latest slot and checks the
+// sequence didn't change underneath it, retrying if it did (which can only
+// happen if the producer went all the way round the ring whilst copying).
+//
+// So the producer never waits on readers, however many charts there are
+// or however long they take to paint, and readers only ever see complete
+// snapshots. Intermediate snapshots are skipped by slow readers.
+//
+class TelemetryBus
+{
+    public:
+        TelemetryBus();
+
+        // producer only, one thread
+        void publish(const RealtimeData &data);
+
+        // any thread, false if nothing has been published yet
+        // stamp is msecs since the bus was created
+        bool latest(RealtimeData &data, qint64 *stamp=NULL) const;
+
+        // changes with every publish, readers can check it to
+        // avoid copying the same snapshot twice
+        quint32 published() const { return head.loadAcquire(); }
+
+    private:
+        static const int ringSize = 4;
+
+        struct Slot {
+            Slot() : seq(0), stamp(0) {}
+            QAtomicInteger<quint32> seq;
+            qint64 stamp;
+            RealtimeData data;
+        };
+
+        Slot ring[ringSize];
+        QAtomicInteger<quint32> head;
+        QElapsedTimer clock;
+};
+#endif
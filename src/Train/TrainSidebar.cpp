@@ -79,6 +79,7 @@
 
 #include "TrainDB.h"
 #include "Library.h"
+#include "Trace.h"
 
 TrainSidebar::TrainSidebar(Context *context) : GcWindow(context), context(context),
     bicycle(context)
@@ -1559,6 +1560,8 @@ void TrainSidebar::Disconnect()
 
 void TrainSidebar::guiUpdate()           // refreshes the telemetry
 {
+    GC_TRACE_SPAN("TrainSidebar::guiUpdate");
+
     RealtimeData rtData;
     rtData.setLap(displayLap + displayWorkoutLap); // user laps + predefined workout lap
     rtData.mode = mode;
@@ -1642,61 +1645,10 @@ void TrainSidebar::guiUpdate()           // refreshes the telemetry
                 RealtimeData local = rtData;
                 Devices[dev].controller->getRealtimeData(local);
 
-                // get spinscan data from a computrainer?
-                if (Devices[dev].type == DEV_CT) {
-                    memcpy((uint8_t*)rtData.spinScan, (uint8_t*)local.spinScan, 24);
-                    rtData.setLoad(local.getLoad()); // and get load in case it was adjusted
-                    rtData.setSlope(local.getSlope()); // and get slope in case it was adjusted
-                    // to within defined limits
-                }
-
-                if (Devices[dev].type == DEV_FORTIUS || Devices[dev].type == DEV_IMAGIC) {
-	                rtData.setLoad(local.getLoad()); // and get load in case it was adjusted
-                    rtData.setSlope(local.getSlope()); // and get slope in case it was adjusted
-					// to within defined limits
-				}
-
-                if (Devices[dev].type == DEV_ANTLOCAL || Devices[dev].type == DEV_NULL) {
-                    rtData.setHb(local.getSmO2(), local.gettHb()); //only moxy data from ant and robot devices right now
-                }
-
-                if (Devices[dev].type == DEV_NULL || Devices[dev].type == DEV_BT40) {
-                    // Only robot and BT40 devices provides VO2 metrics
-                    rtData.setRf(local.getRf());
-                    rtData.setRMV(local.getRMV());
-                    rtData.setVO2_VCO2(local.getVO2(), local.getVCO2());
-                    rtData.setTv(local.getTv());
-                    rtData.setFeO2(local.getFeO2());
-                }
-
                 // what are we getting from this one?
-                if (dev == bpmTelemetry) rtData.setHr(local.getHr());
-                if (dev == rpmTelemetry) rtData.setCadence(local.getCadence());
-                if (dev == kphTelemetry) {
-                    rtData.setSpeed(local.getSpeed());
-                    rtData.setDistance(local.getDistance());
-                    rtData.setLapDistance(local.getLapDistance());
-                    rtData.setLapDistanceRemaining(local.getLapDistanceRemaining());
-                    fReceivedKphTelemetry = true;
-                }
-                if (dev == wattsTelemetry) {
-                    rtData.setWatts(local.getWatts());
-                    rtData.setAltWatts(local.getAltWatts());
-                    rtData.setLRBalance(local.getLRBalance());
-                    rtData.setLTE(local.getLTE());
-                    rtData.setRTE(local.getRTE());
-                    rtData.setLPS(local.getLPS());
-                    rtData.setRPS(local.getRPS());
-                }
-                if (local.getTrainerStatusAvailable())
-                {
-                    rtData.setTrainerStatusAvailable(true);
-                    rtData.setTrainerReady(local.getTrainerReady());
-                    rtData.setTrainerRunning(local.getTrainerRunning());
-                    rtData.setTrainerCalibRequired(local.getTrainerCalibRequired());
-                    rtData.setTrainerConfigRequired(local.getTrainerConfigRequired());
-                    rtData.setTrainerBrakeFault(local.getTrainerBrakeFault());
-                }
+                mergeTelemetry(rtData, local, Devices[dev].type, dev == bpmTelemetry,
+                               dev == rpmTelemetry, dev == kphTelemetry, dev == wattsTelemetry);
+                if (dev == kphTelemetry) fReceivedKphTelemetry = true;
             }
 
             // Compute speed from watts if in slope mode and simulation enabled
@@ -1746,26 +1698,13 @@ void TrainSidebar::guiUpdate()           // refreshes the telemetry
                 // Trust ergFile for location data, if available.
                 bool fAltitudeSet = false;
                 if (ergFile) {
-                    if (!ergFile->StrictGradient) {
-                        // Attempt to obtain location and derived slope from altitude in ergfile.
-                        geolocation geoloc;
-                        if (ergFile->locationAt(displayWorkoutDistance * 1000, displayWorkoutLap, geoloc, slope)) {
-                            displayLatitude = geoloc.Lat();
-                            displayLongitude = geoloc.Long();
-                            displayAltitude = geoloc.Alt();
-
-                            if (displayLatitude && displayLongitude) {
-                                rtData.setLatitude(displayLatitude);
-                                rtData.setLongitude(displayLongitude);
-                            }
-                            fAltitudeSet = true;
-                        }
-                    }
+                    fAltitudeSet = workoutLocation(ergFile, displayWorkoutDistance, displayWorkoutLap, slope,
+                                                   displayLatitude, displayLongitude, displayAltitude);
 
-                    if (ergFile->StrictGradient || !fAltitudeSet) {
-                        slope = ergFile->gradientAt(displayWorkoutDistance * 1000, displayWorkoutLap);
+                    if (fAltitudeSet && displayLatitude && displayLongitude) {
+                        rtData.setLatitude(displayLatitude);
+                        rtData.setLongitude(displayLongitude);
                     }
-
                     rtData.setSlope(slope);
                 }
 
@@ -1905,6 +1844,86 @@ void TrainSidebar::guiUpdate()           // refreshes the telemetry
     }
 }
 
+void TrainSidebar::mergeTelemetry(RealtimeData &rtData, const RealtimeData &local, int type,
+                                  bool hr, bool cadence, bool speed, bool power)
+{
+    // get spinscan data from a computrainer?
+    if (type == DEV_CT) {
+        memcpy((uint8_t*)rtData.spinScan, (uint8_t*)local.spinScan, 24);
+        rtData.setLoad(local.getLoad()); // and get load in case it was adjusted
+        rtData.setSlope(local.getSlope()); // and get slope in case it was adjusted
+        // to within defined limits
+    }
+
+    if (type == DEV_FORTIUS || type == DEV_IMAGIC) {
+        rtData.setLoad(local.getLoad()); // and get load in case it was adjusted
+        rtData.setSlope(local.getSlope()); // and get slope in case it was adjusted
+        // to within defined limits
+    }
+
+    if (type == DEV_ANTLOCAL || type == DEV_NULL) {
+        rtData.setHb(local.getSmO2(), local.gettHb()); //only moxy data from ant and robot devices right now
+    }
+
+    if (type == DEV_NULL || type == DEV_BT40) {
+        // Only robot and BT40 devices provides VO2 metrics
+        rtData.setRf(local.getRf());
+        rtData.setRMV(local.getRMV());
+        rtData.setVO2_VCO2(local.getVO2(), local.getVCO2());
+        rtData.setTv(local.getTv());
+        rtData.setFeO2(local.getFeO2());
+    }
+
+    if (hr) rtData.setHr(local.getHr());
+    if (cadence) rtData.setCadence(local.getCadence());
+    if (speed) {
+        rtData.setSpeed(local.getSpeed());
+        rtData.setDistance(local.getDistance());
+        rtData.setLapDistance(local.getLapDistance());
+        rtData.setLapDistanceRemaining(local.getLapDistanceRemaining());
+    }
+    if (power) {
+        rtData.setWatts(local.getWatts());
+        rtData.setAltWatts(local.getAltWatts());
+        rtData.setLRBalance(local.getLRBalance());
+        rtData.setLTE(local.getLTE());
+        rtData.setRTE(local.getRTE());
+        rtData.setLPS(local.getLPS());
+        rtData.setRPS(local.getRPS());
+    }
+    if (local.getTrainerStatusAvailable())
+    {
+        rtData.setTrainerStatusAvailable(true);
+        rtData.setTrainerReady(local.getTrainerReady());
+        rtData.setTrainerRunning(local.getTrainerRunning());
+        rtData.setTrainerCalibRequired(local.getTrainerCalibRequired());
+        rtData.setTrainerConfigRequired(local.getTrainerConfigRequired());
+        rtData.setTrainerBrakeFault(local.getTrainerBrakeFault());
+    }
+}
+
+bool TrainSidebar::workoutLocation(ErgFile *ergFile, double km, int lap, double &slope,
+                                   double &latitude, double &longitude, double &altitude)
+{
+    bool fAltitudeSet = false;
+
+    if (!ergFile->StrictGradient) {
+        // Attempt to obtain location and derived slope from altitude in ergfile.
+        geolocation geoloc;
+        if (ergFile->locationAt(km * 1000, lap, geoloc, slope)) {
+            latitude = geoloc.Lat();
+            longitude = geoloc.Long();
+            altitude = geoloc.Alt();
+            fAltitudeSet = true;
+        }
+    }
+
+    if (ergFile->StrictGradient || !fAltitudeSet) {
+        slope = ergFile->gradientAt(km * 1000, lap);
+    }
+    return fAltitudeSet;
+}
+
 // can be called from the controller - when user presses "Lap" button
 void TrainSidebar::newLap()
 {
@@ -1980,9 +1999,10 @@ struct ScopedPrecision : ScopedOp<QTextStream, int (QTextStream::*)() const, voi
 //----------------------------------------------------------------------
 void TrainSidebar::diskUpdate()
 {
+    GC_TRACE_SPAN("TrainSidebar::diskUpdate");
+
     int  secs;
 
-    long torq = 0;
     QTextStream recordFileStream(recordFile);
 
     if (calibrating) return;
@@ -1994,15 +2014,39 @@ void TrainSidebar::diskUpdate()
     if (secs <= lastRecordSecs) return; // Avoid duplicates
     lastRecordSecs = secs;
 
+    // the hb split is derived from smo2 and thb, as it was for the display
+    RealtimeData sample;
+    sample.setCadence(displayCadence);
+    sample.setHr(displayHeartRate);
+    sample.setDistance(displayDistance);
+    sample.setSpeed(displaySpeed);
+    sample.setWatts(displayPower);
+    sample.setAltitude(displayAltitude);
+    sample.setLongitude(displayLongitude);
+    sample.setLatitude(displayLatitude);
+    sample.setLRBalance(displayLRBalance);
+    sample.setLTE(displayLTE);
+    sample.setRTE(displayRTE);
+    sample.setLPS(displayLPS);
+    sample.setRPS(displayRPS);
+    sample.setHb(displaySMO2, displayTHB);
+
+    recordSample(recordFileStream, secs, sample, displayLap + displayWorkoutLap, load);
+}
+
+void TrainSidebar::recordSample(QTextStream &recordFileStream, int secs, const RealtimeData &sample, int lap, double load)
+{
+    long torq = 0;
+
     // GoldenCheetah CVS Format "secs, cad, hr, km, kph, nm, watts, alt, lon, lat, headwind, slope, temp, interval, lrbalance, lte, rte, lps, rps, smo2, thb, o2hb, hhb\n";
 
     recordFileStream    << secs
-                        << "," << displayCadence
-                        << "," << displayHeartRate
-                        << "," << displayDistance
-                        << "," << displaySpeed
+                        << "," << sample.getCadence()
+                        << "," << sample.getHr()
+                        << "," << sample.getDistance()
+                        << "," << sample.getSpeed()
                         << "," << torq
-                        << "," << displayPower;
+                        << "," << sample.getWatts();
 
     // QTextStream default precision is 6, location data needs much more than that.
     // Avoid extra precision for other fields since it isn't needed and would grow
@@ -2010,24 +2054,24 @@ void TrainSidebar::diskUpdate()
     {
         ScopedPrecision tempPrecision(&recordFileStream, 20);
 
-        recordFileStream << "," << displayAltitude
-                         << "," << displayLongitude
-                         << "," << displayLatitude;
+        recordFileStream << "," << sample.getAltitude()
+                         << "," << sample.getLongitude()
+                         << "," << sample.getLatitude();
     }
 
     recordFileStream    << "," // headwind
                         << "," // slope
                         << "," // temp
-                        << "," << (displayLap + displayWorkoutLap)
-                        << "," << displayLRBalance
-                        << "," << displayLTE
-                        << "," << displayRTE
-                        << "," << displayLPS
-                        << "," << displayRPS
-                        << "," << displaySMO2
-                        << "," << displayTHB
-                        << "," << displayO2HB
-                        << "," << displayHHB
+                        << "," << lap
+                        << "," << sample.getLRBalance()
+                        << "," << sample.getLTE()
+                        << "," << sample.getRTE()
+                        << "," << sample.getLPS()
+                        << "," << sample.getRPS()
+                        << "," << sample.getSmO2()
+                        << "," << sample.gettHb()
+                        << "," << sample.getO2Hb()
+                        << "," << sample.getHHb()
                         << "," << load
                         << "," << "\n";
 }
@@ -2038,6 +2082,8 @@ void TrainSidebar::diskUpdate()
 
 void TrainSidebar::loadUpdate()
 {
+    GC_TRACE_SPAN("TrainSidebar::loadUpdate");
+
     int curLap = 0;
 
     // we hold our horses whilst calibration is taking place...
@@ -2048,7 +2094,7 @@ void TrainSidebar::loadUpdate()
     load_msecs += load_period.restart();
 
     if (status&RT_MODE_ERGO) {
-        load = ergFile->wattsAt(load_msecs, curLap);
+        bool more = workoutLoad(ergFile, load_msecs, curLap, load);
 
         if(displayWorkoutLap != curLap)
         {
@@ -2059,7 +2105,7 @@ void TrainSidebar::loadUpdate()
         displayWorkoutLap = curLap;
 
         // we got to the end!
-        if (load == -100) {
+        if (!more) {
             Stop(DEVICE_OK);
         } else {
             foreach(int dev, activeDevices) Devices[dev].controller->setLoad(load);
@@ -2085,6 +2131,12 @@ void TrainSidebar::loadUpdate()
     }
 }
 
+bool TrainSidebar::workoutLoad(ErgFile *ergFile, long msecs, int &lap, double &load)
+{
+    load = ergFile->wattsAt(msecs, lap);
+    return load != -100;
+}
+
 void TrainSidebar::Calibrate()
 {
     // Check we're running (and not paused) before attempting
@@ -83,6 +83,7 @@ class ANTlocalController;
 class NullController;
 class RealtimePlot;
 class RealtimeData;
+class QTextStream;
 class MultiDeviceDialog;
 class TrainBottom;
 
@@ -112,6 +113,24 @@ class TrainSidebar : public GcWindow
         // was realtimewindow,merged into tool
         // update charts/dials and manage controller
         void updateData(RealtimeData &);      // to update telemetry by push devices
+
+        // the bodies of the update loops, these are also ridden
+        // headless by TrainSimulator so it measures the same code
+
+        // merge telemetry from a device of type into rtData, taking the
+        // heartrate, cadence, speed and power if it is the device for them
+        static void mergeTelemetry(RealtimeData &rtData, const RealtimeData &local, int type,
+                                   bool hr, bool cadence, bool speed, bool power);
+
+        // slope at km into the workout, and location if it has one (returns true)
+        static bool workoutLocation(ErgFile *ergFile, double km, int lap, double &slope,
+                                    double &latitude, double &longitude, double &altitude);
+
+        // load at msecs into an ergo workout, false once we get to the end
+        static bool workoutLoad(ErgFile *ergFile, long msecs, int &lap, double &load);
+
+        // a line in the GoldenCheetah CSV format the session is recorded in
+        static void recordSample(QTextStream &stream, int secs, const RealtimeData &sample, int lap, double load);
         void nextDisplayMode();     // show next display mode
         void setStreamController();     // based upon selected device
 
@@ -0,0 +1,343 @@
+/*
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "TrainSimulator.h"
+#include "SimController.h"
+#include "TrainSidebar.h" // for the update loops, rates and modes
+#include "ErgFile.h"
+#include "RideFile.h"
+#include "WPrime.h"
+#include "Context.h"
+
+#include <QFileInfo>
+#include <QTextStream>
+#include <algorithm>
+#include <cmath>
+
+//
+// TrainSimulatorStats
+//
+double
+TrainSimulatorStats::mean() const
+{
+    if (values.isEmpty()) return 0;
+
+    double sum = 0;
+    foreach (double value, values) sum += value;
+    return sum / values.count();
+}
+
+double
+TrainSimulatorStats::stddev() const
+{
+    if (values.count() < 2) return 0;
+
+    double m = mean(), sum = 0;
+    foreach (double value, values) sum += (value - m) * (value - m);
+    return sqrt(sum / values.count());
+}
+
+double
+TrainSimulatorStats::percentile(double p) const
+{
+    if (values.isEmpty()) return 0;
+
+    QVector<double> sorted = values;
+    int index = qBound(0, int(ceil(p / 100.0 * sorted.count())) - 1, sorted.count() - 1);
+    std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+    return sorted[index];
+}
+
+double
+TrainSimulatorStats::max() const
+{
+    if (values.isEmpty()) return 0;
+    return *std::max_element(values.begin(), values.end());
+}
+
+QString
+TrainSimulatorStats::toString(int decimals) const
+{
+    return QString("n=%1 mean=%2 p50=%3 p99=%4 max=%5")
+           .arg(count())
+           .arg(mean(), 0, 'f', decimals)
+           .arg(percentile(50), 0, 'f', decimals)
+           .arg(percentile(99), 0, 'f', decimals)
+           .arg(max(), 0, 'f', decimals);
+}
+
+//
+// TrainSimulator
+//
+TrainSimulator::TrainSimulator(Context *context) :
+    context(context), ergFile(NULL), replay(NULL),
+    speedup(0), duration(0), response(0),
+    msecs(0), ergo(true), finished(false), lap(0),
+    load(200), slope(0), distance(0), workoutDistance(0),
+    latitude(0), longitude(0), altitude(0),
+    pendingLoad(-1), pendingAt(-1), pendingWall(0),
+    wallNsecs(0), bytes(0), lines(0), wprimeMsecs(0), joules(0)
+{
+    device = new SimController(NULL, NULL);
+
+    timer.setSingleShot(true);
+    timer.setTimerType(Qt::PreciseTimer);
+    connect(&timer, SIGNAL(timeout()), this, SLOT(tick()));
+}
+
+TrainSimulator::~TrainSimulator()
+{
+    delete device;
+    if (ergFile) delete ergFile;
+    if (replay) delete replay;
+}
+
+bool
+TrainSimulator::setWorkout(QString filename)
+{
+    if (ergFile) delete ergFile;
+
+    ergFile = new ErgFile(filename, ERG, context);
+    if (!ergFile->isValid()) {
+        error = QString(tr("Cannot read workout %1")).arg(filename);
+        delete ergFile;
+        ergFile = NULL;
+        return false;
+    }
+    ergo = (ergFile->mode == ERG || ergFile->mode == MRC);
+    return true;
+}
+
+bool
+TrainSimulator::setReplay(QString filename)
+{
+    if (replay) delete replay;
+
+    QFile file(filename);
+    QStringList errors;
+    replay = RideFileFactory::instance().openRideFile(context, file, errors);
+    if (!replay) {
+        error = QString(tr("Cannot read %1: %2")).arg(filename).arg(errors.join(", "));
+        return false;
+    }
+    return true;
+}
+
+bool
+TrainSimulator::run()
+{
+    if (!recordFile.open()) {
+        error = tr("Cannot create a temporary file for recording");
+        return false;
+    }
+
+    // the workout plot computes W'bal for the workout when it is selected
+    if (ergFile) {
+        QElapsedTimer elapsed;
+        elapsed.start();
+        WPrime wprime;
+        wprime.setErg(ergFile);
+        wprimeMsecs = elapsed.nsecsElapsed() / 1000000.0;
+    }
+
+    // ergo workouts end when the workout does, slope workouts
+    // when we reach the end of the course, or after an hour
+    if (duration <= 0) duration = (ergFile && ergo) ? ergFile->Duration : 3600000;
+
+    device->setReplay(replay);
+    device->setResponse(response);
+    device->start();
+    device->setMode(ergo ? RT_MODE_ERGO : RT_MODE_SPIN);
+
+    wall.start();
+    timer.start(0);
+    loop.exec();
+    wallNsecs = wall.nsecsElapsed();
+
+    bytes = recordFile.size();
+    return true;
+}
+
+void
+TrainSimulator::tick()
+{
+    // how far behind schedule did we wake up ?
+    if (speedup > 0) {
+        qint64 due = qint64(msecs / speedup * 1000000);
+        lateness.add((wall.nsecsElapsed() - due) / 1000000.0);
+    }
+
+    device->setTime(msecs);
+
+    // same order every tick, so the session repeats exactly
+    QElapsedTimer cost;
+    cost.start();
+    guiUpdate();
+    guiCost.add(cost.nsecsElapsed() / 1000.0);
+
+    if (msecs % LOADRATE == 0) {
+        cost.start();
+        loadUpdate();
+        loadCost.add(cost.nsecsElapsed() / 1000.0);
+    }
+
+    if (msecs % SAMPLERATE == 0) {
+        cost.start();
+        diskUpdate();
+        diskCost.add(cost.nsecsElapsed() / 1000.0);
+    }
+
+    if (finished || msecs >= duration) {
+        loop.quit();
+        return;
+    }
+
+    // schedule the next tick against the start, so being late
+    // once doesn't make every tick after it late too
+    msecs += REFRESHRATE;
+    qint64 wait = 0;
+    if (speedup > 0) wait = (qint64(msecs / speedup * 1000000) - wall.nsecsElapsed()) / 1000000;
+    timer.start(wait > 0 ? wait : 0);
+}
+
+void
+TrainSimulator::guiUpdate()
+{
+    RealtimeData local;
+    local.setLap(lap);
+    local.mode = ergo ? ERG : CRS;
+    local.setLoad(load);
+    local.setSlope(slope);
+    local.setAltitude(altitude);
+
+    // the simulated trainer is the only device, so everything comes from it
+    RealtimeData reading = local;
+    device->getRealtimeData(reading);
+    TrainSidebar::mergeTelemetry(local, reading, DEV_NULL, true, true, true, true);
+
+    // has the trainer caught up with the load we asked for ?
+    if (pendingAt >= 0 && reading.getLoad() == pendingLoad) {
+        latency.add(msecs - pendingAt);
+        latencyWall.add((wall.nsecsElapsed() - pendingWall) / 1000000.0);
+        pendingAt = -1;
+    }
+
+    double distanceTick = local.getSpeed() * REFRESHRATE / 3600000.0; // km
+    distance += distanceTick;
+    workoutDistance += distanceTick;
+    joules += local.getWatts() * REFRESHRATE / 1000.0;
+
+    if (ergFile) {
+        if (TrainSidebar::workoutLocation(ergFile, workoutDistance, lap, slope, latitude, longitude, altitude)
+            && latitude && longitude) {
+            local.setLatitude(latitude);
+            local.setLongitude(longitude);
+        }
+        local.setSlope(slope);
+    }
+
+    local.setAltitude(altitude);
+    local.setDistance(distance);
+    local.setMsecs(msecs);
+
+    rtData = local;
+    context->notifyTelemetryUpdate(rtData);
+}
+
+void
+TrainSimulator::loadUpdate()
+{
+    if (ergo) {
+
+        // we got to the end!
+        if (ergFile && !TrainSidebar::workoutLoad(ergFile, msecs, lap, load)) {
+            finished = true;
+            return;
+        }
+
+        // time it from here, until the trainer reports it
+        if (load != pendingLoad) {
+            pendingLoad = load;
+            pendingAt = msecs;
+            pendingWall = wall.nsecsElapsed();
+        }
+        device->setLoad(load);
+        context->notifySetNow(msecs);
+
+    } else {
+
+        // we got to the end!
+        if (slope == -100) {
+            finished = true;
+            return;
+        }
+        device->setGradient(slope);
+        context->notifySetNow(workoutDistance * 1000);
+    }
+}
+
+void
+TrainSimulator::diskUpdate()
+{
+    // as per TrainSidebar, a stream each time that flushes as it goes
+    QTextStream recordFileStream(&recordFile);
+    TrainSidebar::recordSample(recordFileStream, msecs / 1000, rtData, lap, load);
+    lines++;
+}
+
+static QString
+reportLine(QString name, QString value)
+{
+    return QString("%1 %2\n").arg(name, -22).arg(value);
+}
+
+QString
+TrainSimulator::report() const
+{
+    QString returning;
+    double wallSecs = wallNsecs / 1000000000.0;
+    double diskSecs = diskCost.mean() * diskCost.count() / 1000000.0;
+
+    returning += reportLine("workout", ergFile ? QFileInfo(ergFile->filename).fileName() : QString("ergo 200w"));
+    returning += reportLine("rider", replay ? QString("replay %1").arg(replay->startTime().toString(Qt::ISODate)) : QString("steady"));
+    returning += reportLine("speedup", speedup > 0 ? QString("%1x").arg(speedup) : QString("max"));
+    returning += reportLine("trainer response ms", QString("%1").arg(response));
+    returning += reportLine("session secs", QString("%1").arg(msecs / 1000.0, 0, 'f', 1));
+    returning += reportLine("wall secs", QString("%1 (%2x)").arg(wallSecs, 0, 'f', 3)
+                                                              .arg(wallSecs > 0 ? msecs / 1000.0 / wallSecs : 0, 0, 'f', 1));
+
+    // these only change if the simulation does
+    returning += reportLine("distance km", QString("%1").arg(distance, 0, 'f', 3));
+    returning += reportLine("work kJ", QString("%1").arg(joules / 1000.0, 0, 'f', 1));
+
+    returning += reportLine("W' setErg ms", QString("%1").arg(wprimeMsecs, 0, 'f', 3));
+    returning += reportLine("gui update us", guiCost.toString(1));
+    returning += reportLine("load update us", loadCost.toString(1));
+    returning += reportLine("disk update us", diskCost.toString(1));
+    returning += reportLine("control latency ms", latency.toString(0));
+    returning += reportLine("control wall ms", latencyWall.toString(3));
+    if (speedup > 0) {
+        returning += reportLine("tick late ms", lateness.toString(3));
+        returning += reportLine("tick jitter ms", QString("%1").arg(lateness.stddev(), 0, 'f', 3));
+    }
+    returning += reportLine("disk lines", QString("%1").arg(lines));
+    returning += reportLine("disk bytes", QString("%1").arg(bytes));
+    returning += reportLine("disk lines/s", QString("%1").arg(diskSecs > 0 ? lines / diskSecs : 0, 0, 'f', 0));
+    returning += reportLine("disk KB/s", QString("%1").arg(diskSecs > 0 ? bytes / 1024.0 / diskSecs : 0, 0, 'f', 0));
+    return returning;
+}
@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _GC_TrainSimulator_h
+#define _GC_TrainSimulator_h 1
+#include "GoldenCheetah.h"
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QEventLoop>
+#include <QTemporaryFile>
+
+#include "RealtimeData.h"
+
+class Context;
+class ErgFile;
+class RideFile;
+class SimController;
+
+// timings gathered during a run
+class TrainSimulatorStats
+{
+    public:
+        void add(double value) { values << value; }
+        int count() const { return values.count(); }
+        double mean() const;
+        double stddev() const;
+        double percentile(double p) const;
+        double max() const;
+
+        // count mean p50 p99 max
+        QString toString(int decimals) const;
+
+    private:
+        QVector<double> values;
+};
+
+//
+// Rides a workout headless with the simulated trainer, using the same
+// update loops as the train view (telemetry every REFRESHRATE, load every
+// LOADRATE and a sample to disk every SAMPLERATE) and reports how long
+// they took, how late they ran and how quickly the trainer responded.
+//
+// The session is driven off a virtual clock so the rider, workout and
+// telemetry are the same every run; a speedup of 1 rides in real time,
+// 10 ten times faster and 0 as fast as possible.
+//
+class TrainSimulator : public QObject
+{
+    Q_OBJECT
+
+    public:
+        TrainSimulator(Context *context);
+        ~TrainSimulator();
+
+        // erg, mrc, crs ... workout to ride, otherwise ergo at 200w
+        bool setWorkout(QString filename);
+
+        // recorded session to replay as the rider, otherwise steady
+        bool setReplay(QString filename);
+
+        void setSpeedup(double speedup) { this->speedup = speedup; }
+        void setDuration(qint64 msecs) { duration = msecs; } // limit, 0 for workout length
+        void setResponse(int msecs) { response = msecs; }   // trainer response time
+
+        // ride the session
+        bool run();
+
+        // human readable results, one line per measure
+        QString report() const;
+
+        QString errorString() const { return error; }
+
+    private slots:
+        void tick();
+
+    private:
+        // drive the TrainSidebar loop bodies off the virtual clock
+        void guiUpdate();
+        void loadUpdate();
+        void diskUpdate();
+
+        Context *context;
+        ErgFile *ergFile;
+        RideFile *replay;
+        SimController *device;
+        QString error;
+
+        double speedup;
+        qint64 duration;
+        int response;
+
+        // session state, as per TrainSidebar
+        qint64 msecs;                   // virtual time now
+        bool ergo, finished;
+        int lap;
+        double load, slope, distance, workoutDistance;
+        double latitude, longitude, altitude;
+        RealtimeData rtData;
+
+        // the run
+        QTimer timer;
+        QEventLoop loop;
+        QElapsedTimer wall;
+        QTemporaryFile recordFile;
+
+        // trainer response, load waiting to show in telemetry
+        double pendingLoad;
+        qint64 pendingAt, pendingWall;
+
+        // results
+        qint64 wallNsecs, bytes, lines;
+        double wprimeMsecs, joules;
+        TrainSimulatorStats guiCost, loadCost, diskCost;  // usecs
+        TrainSimulatorStats lateness;                     // msecs behind schedule
+        TrainSimulatorStats latency, latencyWall;         // msecs load asked to load seen
+};
+
+#endif // _GC_TrainSimulator_h